@@ -5,8 +5,8 @@ class Advisor : public ChessMan {
     Q_OBJECT
 
 public:
-    explicit Advisor(QString name, QString color, int x, int y, QString icon, QObject* parent = nullptr)
-        : ChessMan(name, color, x, y, icon, parent) {}
+    Advisor(uint8_t code, int number, int x, int y, QObject* parent = nullptr)
+        : ChessMan(code, number, x, y, parent) {}
 
     //使用二维数组判断合法性
     bool canMove(int targetX, int targetY, ChessMan* board[10][9]) override {
@@ -16,10 +16,10 @@ public:
         // 必须斜着走一步
         if (dx != 1 || dy != 1) return false;
 
-        if ((color() == "红" || color() == "red") &&
+        if (side() == SIDE_RED &&
             targetX >= 3 && targetX <= 5 && targetY >= 7 && targetY <= 9) {
             return !isSameColorPieceAt(targetX, targetY, board);
-        } else if ((color() == "黑" || color() == "black") &&
+        } else if (side() == SIDE_BLACK &&
                    targetX >= 3 && targetX <= 5 && targetY >= 0 && targetY <= 2) {
             return !isSameColorPieceAt(targetX, targetY, board);
         }
@@ -0,0 +1,159 @@
+#include "AiPlayer.h"
+
+AiPlayer::AiPlayer(QObject* parent)
+    : QObject(parent)
+{}
+
+AiPlayer::~AiPlayer()
+{
+    cancel();
+}
+
+void AiPlayer::setPonderEnabled(bool enabled)
+{
+    m_ponderEnabled = enabled;
+    if (!enabled && m_pondering)
+        stopPondering();
+}
+
+void AiPlayer::setDifficulty(int level)
+{
+    m_difficulty = qBound(0, level, ChessAI::kDifficultyCount - 1);
+    // 后台思考的结果按旧难度得出，不再使用
+    if (m_pondering)
+        stopPondering();
+}
+
+void AiPlayer::setEngine(AiEngine engine)
+{
+    m_engine = engine;
+    if (m_pondering)
+        stopPondering();
+}
+
+void AiPlayer::requestMove(const Position& pos, const std::vector<HistoryEntry>& history)
+{
+    m_request = { pos, history };
+    m_hasRequest = true;
+    setThinking(true);
+
+    if (m_thread && m_pondering && pos.key() == m_ponderKey) {
+        // 猜中：后台思考转为正式思考，结束后由onPonderFinished取用结果
+        m_ponderHit.store(true);
+        return;
+    }
+    stopThread();
+    startRequest();
+}
+
+void AiPlayer::startPondering(const Position& pos, const std::vector<HistoryEntry>& history)
+{
+    // 猜中后等待中的走子请求（如悔棋时）随旧的后台思考一起作废
+    stopThread();
+    m_hasRequest = false;
+    setThinking(false);
+    if (!m_ponderEnabled || !ChessAI::kDifficulties[m_difficulty].ponder || m_engine != AiEngine::AlphaBeta) return;
+
+    Move reply = m_ai.expectedReply();
+    Position next = pos;
+    if (reply == NO_MOVE || !next.isLegalMove(reply)) return;
+
+    uint8_t captured = next.makeMove(reply);
+    std::vector<HistoryEntry> nextHistory = history;
+    nextHistory.push_back({ next.key(), reply, next.isInCheck(next.sideToMove()), captured != 0 });
+
+    m_ponderKey = next.key();
+    m_pondering = true;
+    m_stop.store(false);
+    m_ponderHit.store(false);
+    const int threadId = ++m_threadId;
+    const int difficulty = m_difficulty;
+    const AiEngine engine = m_engine;
+    m_thread = QThread::create([this, next, nextHistory, difficulty, engine, threadId]() {
+        m_ai.setDifficulty(difficulty);
+        m_ai.setEngine(engine);
+        m_ai.ponder(next, nextHistory, &m_stop, &m_ponderHit);
+        QMetaObject::invokeMethod(this, [this, threadId]() { onPonderFinished(threadId); },
+                                  Qt::QueuedConnection);
+    });
+    m_thread->start(QThread::LowPriority);
+}
+
+void AiPlayer::cancel()
+{
+    stopThread();
+    m_hasRequest = false;
+    setThinking(false);
+}
+
+void AiPlayer::startRequest()
+{
+    m_hasRequest = false;
+    m_pondering = false;
+    m_stop.store(false);
+    const int threadId = ++m_threadId;
+    Request request = m_request;
+    const int difficulty = m_difficulty;
+    const AiEngine engine = m_engine;
+    m_thread = QThread::create([this, request, difficulty, engine, threadId]() {
+        m_ai.setDifficulty(difficulty);
+        m_ai.setEngine(engine);
+        Move move = m_ai.chooseMove(request.pos, request.history, &m_stop);
+        QMetaObject::invokeMethod(this, [this, threadId, move]() { onMoveFinished(threadId, move); },
+                                  Qt::QueuedConnection);
+    });
+    m_thread->start();
+}
+
+void AiPlayer::stopThread()
+{
+    ++m_threadId;
+    m_pondering = false;
+    if (!m_thread) return;
+
+    // 搜索每1024个节点检查一次中止标志，等待时间很短
+    m_stop.store(true);
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+}
+
+void AiPlayer::stopPondering()
+{
+    stopThread();
+    // 猜中后后台思考已转为正式思考，停下后按当前设置重新开始，否则走子请求无人处理
+    if (m_hasRequest)
+        startRequest();
+}
+
+void AiPlayer::onMoveFinished(int threadId, Move move)
+{
+    if (threadId != m_threadId) return;
+
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+    setThinking(false);
+    emit moveReady(move);
+}
+
+void AiPlayer::onPonderFinished(int threadId)
+{
+    if (threadId != m_threadId) return;
+
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+    m_pondering = false;
+
+    // 思考期间已收到走子请求：局面相同时chooseMove会直接使用后台思考的结果
+    if (m_hasRequest)
+        startRequest();
+}
+
+void AiPlayer::setThinking(bool thinking)
+{
+    if (m_thinking == thinking) return;
+    m_thinking = thinking;
+    emit thinkingChanged();
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <QObject>
+#include <QThread>
+#include <atomic>
+#include <vector>
+#include "ChessAi.h"
+
+// AI走子线程：思考在工作线程中进行，结果通过moveReady信号回到界面线程
+// AI走完后，按主要变例预测对手应着并在对手思考期间继续搜索（后台思考）：
+// 猜中时正式思考从后台思考的进度接着算，猜错时停止，置换表中的结果照样复用
+class AiPlayer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit AiPlayer(QObject* parent = nullptr);
+    ~AiPlayer() override;
+
+    bool isThinking() const { return m_thinking; }
+
+    // 难度在下一次思考开始时由工作线程应用，不打断进行中的走子思考
+    void setDifficulty(int level);
+    int difficulty() const { return m_difficulty; }
+
+    // 搜索引擎同样在下一次思考开始时应用
+    void setEngine(AiEngine engine);
+    AiEngine engine() const { return m_engine; }
+
+    void setPonderEnabled(bool enabled);
+    bool ponderEnabled() const { return m_ponderEnabled; }
+
+    // pos为轮到AI行棋的局面，history末尾对应pos
+    void requestMove(const Position& pos, const std::vector<HistoryEntry>& history);
+    // pos为轮到对手行棋的局面，在预测的应着之后开始后台思考
+    void startPondering(const Position& pos, const std::vector<HistoryEntry>& history);
+    // 停止一切思考，丢弃未返回的结果（新对局、切换模式时调用）
+    void cancel();
+
+signals:
+    void moveReady(Move move);
+    void thinkingChanged();
+
+private:
+    struct Request {
+        Position pos;
+        std::vector<HistoryEntry> history;
+    };
+
+    void startRequest();
+    void stopThread();
+    void stopPondering();
+    void onMoveFinished(int threadId, Move move);
+    void onPonderFinished(int threadId);
+    void setThinking(bool thinking);
+
+    ChessAI m_ai;
+    QThread* m_thread = nullptr;
+    int m_threadId = 0;            // 当前线程编号，过期线程的回调直接丢弃
+    std::atomic<bool> m_stop{ false };
+    std::atomic<bool> m_ponderHit{ false };
+    bool m_pondering = false;
+    uint64_t m_ponderKey = 0;
+    bool m_ponderEnabled = true;
+    int m_difficulty = ChessAI::kDefaultDifficulty;
+    AiEngine m_engine = AiEngine::AlphaBeta;
+    bool m_hasRequest = false;
+    Request m_request;
+    bool m_thinking = false;
+};
@@ -0,0 +1,225 @@
+#include "AnalysisCache.h"
+#include <QDir>
+#include <QStandardPaths>
+#include <QtEndian>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+// 文件头：魔数、版本、保留字段，共16字节
+const char kCacheMagic[4] = { 'X', 'Q', 'A', 'C' };
+const quint32 kCacheVersion = 1;
+const qint64 kHeaderSize = 16;
+const qint64 kRecordHeaderSize = 12;
+
+QByteArray fileHeader()
+{
+    QByteArray header(kHeaderSize, 0);
+    std::memcpy(header.data(), kCacheMagic, 4);
+    qToLittleEndian<quint32>(kCacheVersion, reinterpret_cast<uchar*>(header.data()) + 4);
+    return header;
+}
+
+void appendRecord(QByteArray& out, uint64_t key, const CachedAnalysis& entry)
+{
+    uchar header[kRecordHeaderSize];
+    qToLittleEndian<quint64>(key, header);
+    qToLittleEndian<qint16>(entry.score, header + 8);
+    header[10] = entry.depth;
+    header[11] = uchar(entry.pv.size());
+    out.append(reinterpret_cast<const char*>(header), kRecordHeaderSize);
+    for (Move move : entry.pv) {
+        uchar bytes[2];
+        qToLittleEndian<quint16>(move, bytes);
+        out.append(reinterpret_cast<const char*>(bytes), 2);
+    }
+}
+
+} // namespace
+
+AnalysisCache::~AnalysisCache()
+{
+    close();
+}
+
+bool AnalysisCache::open(const QString& path)
+{
+    close();
+
+    // 读入已有记录；文件头不对或末尾写了一半的记录都丢弃，缓存本身可以重建
+    size_t recordCount = 0;
+    bool valid = false;
+    {
+        QFile in(path);
+        if (in.open(QIODevice::ReadOnly)) {
+            const QByteArray data = in.readAll();
+            const uchar* p = reinterpret_cast<const uchar*>(data.constData());
+            const qint64 size = data.size();
+            valid = size >= kHeaderSize && std::memcmp(p, kCacheMagic, 4) == 0
+                 && qFromLittleEndian<quint32>(p + 4) == kCacheVersion;
+            qint64 offset = kHeaderSize;
+            QWriteLocker locker(&m_mapLock);
+            while (valid && offset + kRecordHeaderSize <= size) {
+                const uchar* r = p + offset;
+                const int pvLength = r[11];
+                if (offset + kRecordHeaderSize + 2 * pvLength > size) break;
+
+                CachedAnalysis entry;
+                entry.score = qFromLittleEndian<qint16>(r + 8);
+                entry.depth = r[10];
+                for (int i = 0; i < pvLength; ++i)
+                    entry.pv.push_back(qFromLittleEndian<quint16>(r + kRecordHeaderSize + 2 * i));
+                offset += kRecordHeaderSize + 2 * pvLength;
+                ++recordCount;
+
+                CachedAnalysis& slot = m_entries[qFromLittleEndian<quint64>(r)];
+                if (entry.depth >= slot.depth)
+                    slot = std::move(entry);
+            }
+            valid = valid && offset == size;
+        }
+    }
+
+    // 同一局面被反复加深时文件中有多条记录，超过一半是旧记录时改写
+    if (!valid || (recordCount > 1024 && recordCount > 2 * m_entries.size())) {
+        if (!compact(path)) {
+            close();
+            return false;
+        }
+    }
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        close();
+        return false;
+    }
+    m_stopWriter = false;
+    m_writer = std::thread([this]() { writerLoop(); });
+    m_open = true;
+    return true;
+}
+
+bool AnalysisCache::compact(const QString& path)
+{
+    QByteArray data = fileHeader();
+    {
+        QReadLocker locker(&m_mapLock);
+        for (const auto& [key, entry] : m_entries)
+            appendRecord(data, key, entry);
+    }
+
+    const QString tempPath = path + ".tmp";
+    QFile out(tempPath);
+    if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate) || out.write(data) != data.size())
+        return false;
+    out.close();
+    QFile::remove(path);
+    return QFile::rename(tempPath, path);
+}
+
+void AnalysisCache::close()
+{
+    if (m_writer.joinable()) {
+        {
+            QMutexLocker locker(&m_queueMutex);
+            m_stopWriter = true;
+            m_queueCondition.wakeAll();
+        }
+        m_writer.join();
+    }
+    m_queue.clear();
+    if (m_file.isOpen())
+        m_file.close();
+
+    QWriteLocker locker(&m_mapLock);
+    m_entries.clear();
+    m_open = false;
+}
+
+bool AnalysisCache::isOpen() const
+{
+    QReadLocker locker(&m_mapLock);
+    return m_open;
+}
+
+size_t AnalysisCache::size() const
+{
+    QReadLocker locker(&m_mapLock);
+    return m_entries.size();
+}
+
+bool AnalysisCache::probe(uint64_t key, int minDepth, CachedAnalysis& entry) const
+{
+    QReadLocker locker(&m_mapLock);
+    auto it = m_entries.find(key);
+    if (it == m_entries.end() || it->second.depth < minDepth || it->second.pv.empty())
+        return false;
+    entry = it->second;
+    return true;
+}
+
+void AnalysisCache::store(uint64_t key, const SearchResult& result)
+{
+    if (result.depth <= 0 || result.pv.empty()) return;
+    const int magnitude = std::abs(result.score);
+    if (magnitude > Searcher::kWinValue && magnitude <= Searcher::kBanValue) return;
+
+    Record record;
+    record.key = key;
+    record.entry.score = int16_t(result.score);
+    record.entry.depth = uint8_t(std::min(result.depth, 255));
+    record.entry.pv.assign(result.pv.begin(), result.pv.begin() + std::min<size_t>(result.pv.size(), 255));
+    {
+        QWriteLocker locker(&m_mapLock);
+        if (!m_open) return;
+        CachedAnalysis& slot = m_entries[key];
+        if (!slot.pv.empty() && slot.depth >= record.entry.depth) return;
+        slot = record.entry;
+    }
+
+    QMutexLocker locker(&m_queueMutex);
+    m_queue.push_back(std::move(record));
+    m_queueCondition.wakeOne();
+}
+
+void AnalysisCache::writerLoop()
+{
+    std::vector<Record> batch;
+    for (;;) {
+        bool stopping;
+        {
+            QMutexLocker locker(&m_queueMutex);
+            while (m_queue.empty() && !m_stopWriter)
+                m_queueCondition.wait(&m_queueMutex);
+            batch.swap(m_queue);
+            stopping = m_stopWriter;
+        }
+
+        if (!batch.empty()) {
+            QByteArray data;
+            for (const Record& record : batch)
+                appendRecord(data, record.key, record.entry);
+            m_file.write(data);
+            m_file.flush();
+            batch.clear();
+        }
+        if (stopping) {
+            // 停止前最后一批已经写出，再确认队列为空
+            QMutexLocker locker(&m_queueMutex);
+            if (m_queue.empty()) break;
+        }
+    }
+}
+
+AnalysisCache& AnalysisCache::defaultCache()
+{
+    static AnalysisCache cache;
+    static bool opened = [] {
+        const QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+        QDir().mkpath(dir);
+        return cache.open(dir + "/analysis.xac");
+    }();
+    Q_UNUSED(opened);
+    return cache;
+}
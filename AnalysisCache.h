@@ -0,0 +1,67 @@
+#pragma once
+#include <QFile>
+#include <QMutex>
+#include <QReadWriteLock>
+#include <QString>
+#include <QWaitCondition>
+#include <cstdint>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "Search.h"
+
+// 缓存的搜索结果：分数以该局面行棋方为视角，pv首着即最佳着
+struct CachedAnalysis {
+    int16_t score = 0;
+    uint8_t depth = 0;
+    std::vector<Move> pv;
+};
+
+// 跨会话保存的分析结果（.xac，小端序）：16字节文件头后逐条追加记录
+//   键值u64、分数i16、深度u8、变例长度u8、变例着法u16×n
+// 打开时整个读入内存，同一局面以最深的一条为准；重复记录过多时改写文件
+// store只更新内存并放入队列，由后台写线程追加到文件，搜索线程不等待磁盘
+// 可在多个搜索线程中同时probe/store
+class AnalysisCache
+{
+public:
+    AnalysisCache() = default;
+    ~AnalysisCache();
+    AnalysisCache(const AnalysisCache&) = delete;
+    AnalysisCache& operator=(const AnalysisCache&) = delete;
+
+    bool open(const QString& path);
+    // 写完队列中的记录后关闭
+    void close();
+    bool isOpen() const;
+    size_t size() const;
+
+    // 缓存深度不小于minDepth时返回true
+    bool probe(uint64_t key, int minDepth, CachedAnalysis& entry) const;
+    // 只保存比已有记录更深的结果；长将、长捉的判负分依赖对局历史，不保存
+    void store(uint64_t key, const SearchResult& result);
+
+    // 进程内共享的默认缓存（应用数据目录下的analysis.xac），首次使用时打开
+    static AnalysisCache& defaultCache();
+
+private:
+    struct Record {
+        uint64_t key;
+        CachedAnalysis entry;
+    };
+
+    void writerLoop();
+    bool compact(const QString& path);
+
+    mutable QReadWriteLock m_mapLock;
+    std::unordered_map<uint64_t, CachedAnalysis> m_entries;
+    bool m_open = false;
+
+    // 写线程与待写记录
+    QMutex m_queueMutex;
+    QWaitCondition m_queueCondition;
+    std::vector<Record> m_queue;
+    bool m_stopWriter = false;
+    std::thread m_writer;
+    QFile m_file;
+};
@@ -0,0 +1,223 @@
+#include "AnalysisModel.h"
+#include "AnalysisCache.h"
+#include <QMutexLocker>
+#include <QStringList>
+#include <QTimer>
+#include <cstdlib>
+
+AnalysisModel::AnalysisModel(QObject* parent)
+    : QAbstractListModel(parent)
+    , m_searcher(std::make_unique<Searcher>())
+{
+    m_lastFlush.start();
+}
+
+AnalysisModel::~AnalysisModel()
+{
+    stop();
+}
+
+int AnalysisModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : int(m_lines.size());
+}
+
+QVariant AnalysisModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= m_lines.size())
+        return QVariant();
+
+    const Line& line = m_lines[index.row()];
+    switch (role) {
+    case RankRole:
+        return index.row() + 1;
+    case ScoreRole:
+        return line.score;
+    case ScoreTextRole:
+        return scoreText(line.score);
+    case DepthRole:
+        return line.depth;
+    case PvRole:
+        return line.pv;
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int, QByteArray> AnalysisModel::roleNames() const
+{
+    return {
+        { RankRole, "rank" },
+        { ScoreRole, "score" },
+        { ScoreTextRole, "scoreText" },
+        { DepthRole, "depth" },
+        { PvRole, "pv" }
+    };
+}
+
+bool AnalysisModel::running() const
+{
+    return m_running;
+}
+
+int AnalysisModel::depth() const
+{
+    return m_depth;
+}
+
+QString AnalysisModel::nodes() const
+{
+    return QString::number(m_nodes);
+}
+
+int AnalysisModel::lineCount() const
+{
+    return m_lineCount;
+}
+
+void AnalysisModel::setLineCount(int count)
+{
+    count = qBound(1, count, 8);
+    if (m_lineCount == count) return;
+    m_lineCount = count;
+    emit lineCountChanged();
+}
+
+void AnalysisModel::stop()
+{
+    ++m_generation;
+    if (m_thread) {
+        // 搜索每1024个节点检查一次中止标志，等待时间很短
+        m_stop.store(true);
+        m_thread->wait();
+        delete m_thread;
+        m_thread = nullptr;
+    }
+    if (m_running) {
+        m_running = false;
+        emit runningChanged();
+    }
+}
+
+void AnalysisModel::start(const Position& pos, const std::vector<HistoryEntry>& history)
+{
+    stop();
+
+    beginResetModel();
+    m_lines.clear();
+    endResetModel();
+    m_depth = 0;
+    m_nodes = 0;
+    m_sideToMove = pos.sideToMove();
+
+    // 以前分析过的局面先显示缓存结果，搜索超过缓存深度后再刷新
+    const bool cacheable = findRepetition(history) < 0;
+    CachedAnalysis cached;
+    m_cachedDepth = 0;
+    if (cacheable && AnalysisCache::defaultCache().probe(pos.key(), 1, cached)) {
+        SearchResult result;
+        result.depth = cached.depth;
+        result.score = cached.score;
+        result.pv = cached.pv;
+        result.lines = { { cached.score, cached.pv } };
+        showResult(result);
+        m_cachedDepth = cached.depth;
+    }
+    emit progressChanged();
+
+    m_stop.store(false);
+    const int generation = m_generation;
+    SearchLimits limits;
+    limits.depth = Searcher::kMaxPly;
+    limits.multiPv = m_lineCount;
+
+    const uint64_t key = pos.key();
+    m_searcher->setProgressCallback([this, generation, key, cacheable](const SearchResult& result) {
+        if (cacheable)
+            AnalysisCache::defaultCache().store(key, result);
+        onProgress(result, generation);
+    });
+    m_thread = QThread::create([this, pos, history, limits, generation]() {
+        m_searcher->search(pos, history, limits, &m_stop);
+        QMetaObject::invokeMethod(this, [this, generation]() {
+            if (generation != m_generation || !m_running) return;
+            m_running = false;
+            emit runningChanged();
+        }, Qt::QueuedConnection);
+    });
+    m_thread->start(QThread::LowPriority);
+
+    m_running = true;
+    emit runningChanged();
+}
+
+void AnalysisModel::onProgress(const SearchResult& result, int generation)
+{
+    // 搜索线程：只保存最新结果，界面刷新由界面线程限频
+    {
+        QMutexLocker locker(&m_mutex);
+        m_pending = result;
+        m_pendingGeneration = generation;
+    }
+    if (!m_flushScheduled.exchange(true))
+        QMetaObject::invokeMethod(this, &AnalysisModel::scheduleFlush, Qt::QueuedConnection);
+}
+
+void AnalysisModel::scheduleFlush()
+{
+    qint64 wait = kMinUpdateIntervalMs - m_lastFlush.elapsed();
+    QTimer::singleShot(int(qMax<qint64>(0, wait)), this, &AnalysisModel::flush);
+}
+
+void AnalysisModel::flush()
+{
+    SearchResult result;
+    int generation;
+    {
+        QMutexLocker locker(&m_mutex);
+        result = m_pending;
+        generation = m_pendingGeneration;
+        m_flushScheduled.store(false);
+    }
+    m_lastFlush.restart();
+    if (generation != m_generation || result.depth <= m_cachedDepth) return;
+    showResult(result);
+}
+
+void AnalysisModel::showResult(const SearchResult& result)
+{
+    QList<Line> lines;
+    for (const SearchLine& searchLine : result.lines) {
+        QStringList moves;
+        for (Move move : searchLine.pv)
+            moves.append(QString::fromStdString(Position::moveToIccs(move)));
+        int redScore = m_sideToMove == SIDE_RED ? searchLine.score : -searchLine.score;
+        lines.append({ redScore, result.depth, moves.join(" ") });
+    }
+
+    if (lines.size() == m_lines.size()) {
+        m_lines = lines;
+        if (!m_lines.isEmpty())
+            emit dataChanged(index(0), index(int(m_lines.size()) - 1));
+    } else {
+        beginResetModel();
+        m_lines = lines;
+        endResetModel();
+    }
+
+    m_depth = result.depth;
+    m_nodes = result.nodes;
+    emit progressChanged();
+}
+
+QString AnalysisModel::scoreText(int redScore)
+{
+    const int magnitude = std::abs(redScore);
+    if (magnitude < Searcher::kWinValue)
+        return QString::asprintf("%+.2f", redScore / 100.0);
+
+    const QString winner = redScore > 0 ? "红胜" : "黑胜";
+    if (magnitude <= Searcher::kBanValue)
+        return winner + " 长打";
+    return winner + QString(" %1步杀").arg((Searcher::kMateValue - magnitude + 1) / 2);
+}
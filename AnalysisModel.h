@@ -0,0 +1,87 @@
+#pragma once
+#include <QAbstractListModel>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QThread>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "Search.h"
+
+// 分析模式：在工作线程中无限期迭代加深搜索当前局面，输出前K条变例
+// 每完成一次迭代由搜索线程写入待发布结果，界面线程最多每100毫秒刷新一次模型
+// 每次迭代的结果同时写入分析缓存，再次分析同一局面时先显示缓存结果
+class AnalysisModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(bool running READ running NOTIFY runningChanged)
+    Q_PROPERTY(int depth READ depth NOTIFY progressChanged)
+    Q_PROPERTY(QString nodes READ nodes NOTIFY progressChanged)
+    Q_PROPERTY(int lineCount READ lineCount WRITE setLineCount NOTIFY lineCountChanged)
+
+public:
+    enum Roles {
+        RankRole = Qt::UserRole + 1,
+        ScoreRole,        // 红方视角的分数
+        ScoreTextRole,    // "+1.50"、"红胜 3步杀" 等
+        DepthRole,
+        PvRole            // ICCS着法，空格分隔
+    };
+
+    explicit AnalysisModel(QObject* parent = nullptr);
+    ~AnalysisModel() override;
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    bool running() const;
+    int depth() const;
+    QString nodes() const;
+    int lineCount() const;
+    void setLineCount(int count);
+
+    // 停止当前分析并从新局面重新开始
+    void start(const Position& pos, const std::vector<HistoryEntry>& history);
+    void stop();
+
+    static constexpr int kMinUpdateIntervalMs = 100;
+
+signals:
+    void runningChanged();
+    void progressChanged();
+    void lineCountChanged();
+
+private:
+    struct Line {
+        int score;
+        int depth;
+        QString pv;
+    };
+
+    void onProgress(const SearchResult& result, int generation);
+    void scheduleFlush();
+    void flush();
+    void showResult(const SearchResult& result);
+    static QString scoreText(int redScore);
+
+    std::unique_ptr<Searcher> m_searcher;   // 只在工作线程中使用，置换表跨局面保留
+    QThread* m_thread = nullptr;
+    std::atomic<bool> m_stop{ false };
+    int m_generation = 0;
+    int m_lineCount = 3;
+    int m_sideToMove = SIDE_RED;
+    bool m_running = false;
+
+    // 搜索线程与界面线程之间的待发布结果
+    QMutex m_mutex;
+    SearchResult m_pending;
+    int m_pendingGeneration = -1;
+    std::atomic<bool> m_flushScheduled{ false };
+    QElapsedTimer m_lastFlush;
+
+    QList<Line> m_lines;
+    int m_depth = 0;
+    uint64_t m_nodes = 0;
+    int m_cachedDepth = 0;          // 开始时显示的缓存结果深度，搜索超过它之前不刷新
+};
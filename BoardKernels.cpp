@@ -0,0 +1,301 @@
+#include "BoardKernels.h"
+#include <bit>
+#include <cstring>
+#include "Simd.h"
+
+namespace {
+
+constexpr int kSquares = 96;
+
+struct Kernels {
+    int (*pieceSquareSum)(const SquareMap& board, const PieceSquareTable& table);
+    int (*sumMasked)(const SquareMap& values, const SquareMap& mask);
+    int (*countMobility)(const SquareMap& board, const SquareMap& attacks, int side);
+    int (*countHanging)(const SquareMap& board, const SquareMap& attacks, const SquareMap& defences, int side);
+};
+
+// ===== 普通循环 =====
+
+inline bool ownPiece(uint8_t piece, int side)
+{
+    return piece && pieceSide(piece) == side;
+}
+
+int pieceSquareSumScalar(const SquareMap& board, const PieceSquareTable& table)
+{
+    int sum = 0;
+    for (int sq = 0; sq < kSquares; ++sq)
+        sum += table.v[board.v[sq] & 15][sq];
+    return sum;
+}
+
+int sumMaskedScalar(const SquareMap& values, const SquareMap& mask)
+{
+    int sum = 0;
+    for (int sq = 0; sq < kSquares; ++sq)
+        if (mask.v[sq]) sum += values.v[sq];
+    return sum;
+}
+
+int countMobilityScalar(const SquareMap& board, const SquareMap& attacks, int side)
+{
+    int count = 0;
+    for (int sq = 0; sq < kSquares; ++sq)
+        if (attacks.v[sq] && !ownPiece(board.v[sq], side)) ++count;
+    return count;
+}
+
+int countHangingScalar(const SquareMap& board, const SquareMap& attacks, const SquareMap& defences, int side)
+{
+    int count = 0;
+    for (int sq = 0; sq < kSquares; ++sq) {
+        const uint8_t piece = board.v[sq];
+        if (ownPiece(piece, side) && pieceType(piece) != PT_KING && attacks.v[sq] && !defences.v[sq])
+            ++count;
+    }
+    return count;
+}
+
+const Kernels kScalarKernels = { pieceSquareSumScalar, sumMaskedScalar, countMobilityScalar, countHangingScalar };
+
+#ifdef SIMD_X86
+
+// ===== SSE2：每次16格 =====
+
+// SSE2没有按下标取数的指令，逐个编码比较再累加反而比普通循环慢；
+// 这里只用movemask找出有棋子的格，按位逐格查表，跳过空格
+int pieceSquareSumSse2(const SquareMap& board, const PieceSquareTable& table)
+{
+    const __m128i zero = _mm_setzero_si128();
+    int sum = 0;
+    for (int c = 0; c < 6; ++c) {
+        const __m128i empty = _mm_cmpeq_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(board.v + 16 * c)), zero);
+        unsigned occupied = ~unsigned(_mm_movemask_epi8(empty)) & 0xFFFF;
+        while (occupied) {
+            const int sq = 16 * c + std::countr_zero(occupied);
+            occupied &= occupied - 1;
+            sum += table.v[board.v[sq]][sq];
+        }
+    }
+    return sum;
+}
+
+int sumMaskedSse2(const SquareMap& values, const SquareMap& mask)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i total = zero;
+    for (int c = 0; c < 6; ++c) {
+        const __m128i empty = _mm_cmpeq_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(mask.v + 16 * c)), zero);
+        const __m128i selected = _mm_andnot_si128(empty, _mm_load_si128(reinterpret_cast<const __m128i*>(values.v + 16 * c)));
+        total = _mm_add_epi64(total, _mm_sad_epu8(selected, zero));
+    }
+    return _mm_cvtsi128_si32(total) + _mm_cvtsi128_si32(_mm_unpackhi_epi64(total, total));
+}
+
+// 本方棋子：非空且编码第3位与side一致
+inline __m128i ownPiecesSse2(__m128i board, int side)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i sideBits = _mm_and_si128(board, _mm_set1_epi8(8));
+    const __m128i own = _mm_cmpeq_epi8(sideBits, _mm_set1_epi8(char(side * 8)));
+    return _mm_andnot_si128(_mm_cmpeq_epi8(board, zero), own);
+}
+
+int countMobilitySse2(const SquareMap& board, const SquareMap& attacks, int side)
+{
+    const __m128i zero = _mm_setzero_si128();
+    int count = 0;
+    for (int c = 0; c < 6; ++c) {
+        const __m128i b = _mm_load_si128(reinterpret_cast<const __m128i*>(board.v + 16 * c));
+        const __m128i quiet = _mm_cmpeq_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(attacks.v + 16 * c)), zero);
+        const int blocked = _mm_movemask_epi8(_mm_or_si128(quiet, ownPiecesSse2(b, side)));
+        count += 16 - std::popcount(unsigned(blocked));
+    }
+    return count;
+}
+
+int countHangingSse2(const SquareMap& board, const SquareMap& attacks, const SquareMap& defences, int side)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i typeMask = _mm_set1_epi8(7);
+    const __m128i king = _mm_set1_epi8(PT_KING);
+    int count = 0;
+    for (int c = 0; c < 6; ++c) {
+        const __m128i b = _mm_load_si128(reinterpret_cast<const __m128i*>(board.v + 16 * c));
+        __m128i hanging = _mm_andnot_si128(_mm_cmpeq_epi8(_mm_and_si128(b, typeMask), king), ownPiecesSse2(b, side));
+        hanging = _mm_andnot_si128(_mm_cmpeq_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(attacks.v + 16 * c)), zero), hanging);
+        hanging = _mm_and_si128(_mm_cmpeq_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(defences.v + 16 * c)), zero), hanging);
+        count += std::popcount(unsigned(_mm_movemask_epi8(hanging)));
+    }
+    return count;
+}
+
+const Kernels kSse2Kernels = { pieceSquareSumSse2, sumMaskedSse2, countMobilitySse2, countHangingSse2 };
+
+// ===== AVX2：每次32格（子力位置表每次16格） =====
+
+// 每次8格：下标 = 编码 * 96 + 格号，按int16下标取32位后取低16位并带符号扩展
+// 最大下标为表中[15][89]，多读的2字节仍在表内；补齐的格编码为0，读到的是[0][90~95]
+SIMD_AVX2_TARGET
+int pieceSquareSumAvx2(const SquareMap& board, const PieceSquareTable& table)
+{
+    const int* base = reinterpret_cast<const int*>(table.v[0]);
+    const __m256i stride = _mm256_set1_epi32(96);
+    __m256i squares = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256i total = _mm256_setzero_si256();
+    for (int c = 0; c < 12; ++c) {
+        const __m256i codes = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(board.v + 8 * c)));
+        const __m256i index = _mm256_add_epi32(_mm256_mullo_epi32(codes, stride), squares);
+        const __m256i values = _mm256_i32gather_epi32(base, index, 2);
+        total = _mm256_add_epi32(total, _mm256_srai_epi32(_mm256_slli_epi32(values, 16), 16));
+        squares = _mm256_add_epi32(squares, _mm256_set1_epi32(8));
+    }
+    __m128i half = _mm_add_epi32(_mm256_castsi256_si128(total), _mm256_extracti128_si256(total, 1));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(half);
+}
+
+SIMD_AVX2_TARGET
+int sumMaskedAvx2(const SquareMap& values, const SquareMap& mask)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i total = zero;
+    for (int c = 0; c < 3; ++c) {
+        const __m256i empty = _mm256_cmpeq_epi8(_mm256_load_si256(reinterpret_cast<const __m256i*>(mask.v + 32 * c)), zero);
+        const __m256i selected = _mm256_andnot_si256(empty, _mm256_load_si256(reinterpret_cast<const __m256i*>(values.v + 32 * c)));
+        total = _mm256_add_epi64(total, _mm256_sad_epu8(selected, zero));
+    }
+    const __m128i half = _mm_add_epi64(_mm256_castsi256_si128(total), _mm256_extracti128_si256(total, 1));
+    return _mm_cvtsi128_si32(half) + _mm_cvtsi128_si32(_mm_unpackhi_epi64(half, half));
+}
+
+SIMD_AVX2_TARGET
+inline __m256i ownPiecesAvx2(__m256i board, int side)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i sideBits = _mm256_and_si256(board, _mm256_set1_epi8(8));
+    const __m256i own = _mm256_cmpeq_epi8(sideBits, _mm256_set1_epi8(char(side * 8)));
+    return _mm256_andnot_si256(_mm256_cmpeq_epi8(board, zero), own);
+}
+
+SIMD_AVX2_TARGET
+int countMobilityAvx2(const SquareMap& board, const SquareMap& attacks, int side)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    int count = 0;
+    for (int c = 0; c < 3; ++c) {
+        const __m256i b = _mm256_load_si256(reinterpret_cast<const __m256i*>(board.v + 32 * c));
+        const __m256i quiet = _mm256_cmpeq_epi8(_mm256_load_si256(reinterpret_cast<const __m256i*>(attacks.v + 32 * c)), zero);
+        const unsigned blocked = unsigned(_mm256_movemask_epi8(_mm256_or_si256(quiet, ownPiecesAvx2(b, side))));
+        count += 32 - std::popcount(blocked);
+    }
+    return count;
+}
+
+SIMD_AVX2_TARGET
+int countHangingAvx2(const SquareMap& board, const SquareMap& attacks, const SquareMap& defences, int side)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i typeMask = _mm256_set1_epi8(7);
+    const __m256i king = _mm256_set1_epi8(PT_KING);
+    int count = 0;
+    for (int c = 0; c < 3; ++c) {
+        const __m256i b = _mm256_load_si256(reinterpret_cast<const __m256i*>(board.v + 32 * c));
+        __m256i hanging = _mm256_andnot_si256(_mm256_cmpeq_epi8(_mm256_and_si256(b, typeMask), king), ownPiecesAvx2(b, side));
+        hanging = _mm256_andnot_si256(_mm256_cmpeq_epi8(_mm256_load_si256(reinterpret_cast<const __m256i*>(attacks.v + 32 * c)), zero), hanging);
+        hanging = _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_load_si256(reinterpret_cast<const __m256i*>(defences.v + 32 * c)), zero), hanging);
+        count += std::popcount(unsigned(_mm256_movemask_epi8(hanging)));
+    }
+    return count;
+}
+
+const Kernels kAvx2Kernels = { pieceSquareSumAvx2, sumMaskedAvx2, countMobilityAvx2, countHangingAvx2 };
+
+#endif
+
+const Kernels* kernelsFor(SimdLevel level)
+{
+    switch (level) {
+#ifdef SIMD_X86
+    case SimdLevel::Avx2:
+        return &kAvx2Kernels;
+    case SimdLevel::Sse2:
+        return &kSse2Kernels;
+#endif
+    default:
+        return &kScalarKernels;
+    }
+}
+
+inline const Kernels* kernels()
+{
+    return kernelsFor(simdLevel());
+}
+
+// 两方九宫的格子
+SquareMap palaceMap(int side)
+{
+    SquareMap map = {};
+    const int top = side == SIDE_RED ? 7 : 0;
+    for (int y = top; y < top + 3; ++y)
+        for (int x = 3; x <= 5; ++x)
+            map.v[squareOf(x, y)] = 1;
+    return map;
+}
+
+} // namespace
+
+namespace BoardKernels {
+
+int pieceSquareSum(const SquareMap& board, const PieceSquareTable& table)
+{
+    return kernels()->pieceSquareSum(board, table);
+}
+
+int sumMasked(const SquareMap& values, const SquareMap& mask)
+{
+    return kernels()->sumMasked(values, mask);
+}
+
+int countMobility(const SquareMap& board, const SquareMap& attacks, int side)
+{
+    return kernels()->countMobility(board, attacks, side);
+}
+
+int countHanging(const SquareMap& board, const SquareMap& attacks, const SquareMap& defences, int side)
+{
+    return kernels()->countHanging(board, attacks, defences, side);
+}
+
+void loadBoard(const Position& pos, SquareMap& board)
+{
+    std::memcpy(board.v, pos.squares(), 90);
+    std::memset(board.v + 90, 0, sizeof(board.v) - 90);
+}
+
+void loadAttacks(const Position& pos, int side, SquareMap& attacks)
+{
+    pos.attackCounts(side, attacks.v);
+    std::memset(attacks.v + 90, 0, sizeof(attacks.v) - 90);
+}
+
+} // namespace BoardKernels
+
+ActivityTerms measureActivity(const Position& pos)
+{
+    static const SquareMap palaces[2] = { palaceMap(SIDE_RED), palaceMap(SIDE_BLACK) };
+
+    SquareMap board, attacks[2];
+    BoardKernels::loadBoard(pos, board);
+    BoardKernels::loadAttacks(pos, SIDE_RED, attacks[SIDE_RED]);
+    BoardKernels::loadAttacks(pos, SIDE_BLACK, attacks[SIDE_BLACK]);
+
+    ActivityTerms terms;
+    for (int side = SIDE_RED; side <= SIDE_BLACK; ++side) {
+        terms.mobility[side] = BoardKernels::countMobility(board, attacks[side], side);
+        terms.palacePressure[side] = BoardKernels::sumMasked(attacks[side], palaces[side ^ 1]);
+        terms.hanging[side] = BoardKernels::countHanging(board, attacks[side ^ 1], attacks[side], side);
+    }
+    return terms;
+}
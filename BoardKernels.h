@@ -0,0 +1,41 @@
+#pragma once
+#include <cstdint>
+#include "Position.h"
+
+// 按格存放的棋盘数据：90格补到96字节并按32字节对齐，计算核心整块读取，补齐的6格须为0
+struct alignas(32) SquareMap {
+    uint8_t v[96];
+};
+
+// 子力位置表：按棋子编码（side * 8 + type）与格号取值，红方为正、黑方为负
+// 编码0、未用的编码8与补齐的格须为0
+struct alignas(32) PieceSquareTable {
+    int16_t v[16][96];
+};
+
+// 整盘逐格求和/计数的计算核心：AVX2、SSE2与普通循环三种实现，按CPU运行时选用，结果完全一致
+namespace BoardKernels {
+
+// Σ table[board[sq]][sq]
+int pieceSquareSum(const SquareMap& board, const PieceSquareTable& table);
+// mask非0的格上values之和
+int sumMasked(const SquareMap& values, const SquareMap& mask);
+// 活动范围：side控制（attacks非0）且不是本方棋子的格数
+int countMobility(const SquareMap& board, const SquareMap& attacks, int side);
+// 悬子：side的棋子（不含将帅）受对方攻击（attacks非0）而无本方保护（defences为0）的个数
+int countHanging(const SquareMap& board, const SquareMap& attacks, const SquareMap& defences, int side);
+
+void loadBoard(const Position& pos, SquareMap& board);
+// 各格受side控制的次数，见Position::attackCounts
+void loadAttacks(const Position& pos, int side, SquareMap& attacks);
+
+} // namespace BoardKernels
+
+// 活动性指标，按红方、黑方分别统计
+struct ActivityTerms {
+    int mobility[2];          // 活动范围
+    int palacePressure[2];    // 对方九宫各格受本方控制的次数之和
+    int hanging[2];           // 本方悬子数
+};
+
+ActivityTerms measureActivity(const Position& pos);
@@ -0,0 +1,236 @@
+// 开局库生成工具：从棋谱集合统计各局面的着法频率与胜负，生成book.bin
+//
+// 输入为文本棋谱，每行一局：结果 + ICCS着法序列，例如
+//   1-0 h2e2 h9g7 h0g2 i9h9 ...
+// 结果为 1-0（红胜）、0-1（黑胜）、1/2-1/2（和）或 *（未知），以#开头的行忽略
+// 也接受类PGN文本棋谱（.pgn）与二进制对局库（.xdb），只统计从标准开局开始的对局
+//
+// 用法：bookBuilder [-o book.bin] [--plies 30] [--min-games 2] [-j 线程数] 棋谱文件...
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QTextStream>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "GameDatabase.h"
+#include "GameRecord.h"
+#include "OpeningBook.h"
+#include "Position.h"
+
+namespace {
+
+struct MoveKey {
+    uint64_t key;
+    uint16_t move;
+    bool operator==(const MoveKey& other) const { return key == other.key && move == other.move; }
+};
+
+struct MoveKeyHash {
+    size_t operator()(const MoveKey& k) const { return size_t(k.key ^ (uint64_t(k.move) * 0x9E3779B97F4A7C15ull)); }
+};
+
+struct MoveStats {
+    uint64_t games = 0;
+    uint64_t wins = 0;
+    uint64_t losses = 0;
+};
+
+using StatsMap = std::unordered_map<MoveKey, MoveStats, MoveKeyHash>;
+
+// 累加一局的统计，非法着法处截断；winner为-1表示和棋或未知
+void addMoves(const std::vector<Move>& moves, int winner, int maxPlies, StatsMap& stats)
+{
+    Position board = Position::startPosition();
+    int plies = 0;
+    for (Move move : moves) {
+        if (plies >= maxPlies || !board.isLegalMove(move)) break;
+
+        MoveStats& s = stats[MoveKey{ board.key(), move }];
+        s.games++;
+        if (winner == board.sideToMove()) s.wins++;
+        else if (winner >= 0) s.losses++;
+
+        board.makeMove(move);
+        ++plies;
+    }
+}
+
+int winnerOf(GameResult result)
+{
+    if (result == GameResult::RedWin) return SIDE_RED;
+    if (result == GameResult::BlackWin) return SIDE_BLACK;
+    return -1;
+}
+
+// 解析一局单行棋谱并累加统计
+void addGame(const std::string& line, int maxPlies, StatsMap& stats)
+{
+    size_t pos = line.find_first_not_of(" \t");
+    if (pos == std::string::npos || line[pos] == '#') return;
+
+    size_t end = line.find_first_of(" \t", pos);
+    std::string result = line.substr(pos, end == std::string::npos ? std::string::npos : end - pos);
+    if (result != "1-0" && result != "0-1" && result != "1/2-1/2" && result != "*") return;
+
+    std::vector<Move> moves;
+    while (end != std::string::npos && int(moves.size()) < maxPlies) {
+        pos = line.find_first_not_of(" \t", end);
+        if (pos == std::string::npos) break;
+        end = line.find_first_of(" \t", pos);
+        moves.push_back(Position::moveFromIccs(line.substr(pos, end == std::string::npos ? std::string::npos : end - pos)));
+    }
+    addMoves(moves, winnerOf(GameRecord::resultFromText(result)), maxPlies, stats);
+}
+
+bool readLines(const QString& path, std::vector<std::string>& lines)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return false;
+    QTextStream in(&file);
+    while (!in.atEnd())
+        lines.push_back(in.readLine().toStdString());
+    return true;
+}
+
+// 文本棋谱逐局流式读取，只保留标准开局的对局
+bool readRecords(const QString& path, std::vector<GameRecord>& games)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    GameRecordReader reader(&file);
+    GameRecord game;
+    while (reader.next(game)) {
+        if (game.fen.empty() || game.startPosition().key() == Position::startPosition().key())
+            games.push_back(std::move(game));
+    }
+    return true;
+}
+
+// 各线程按块领取下标[0, count)，fn(线程号, 下标)
+void parallelFor(size_t count, int threadCount, const std::function<void(int, size_t)>& fn)
+{
+    const size_t chunkSize = 4096;
+    std::atomic<size_t> nextChunk{ 0 };
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threadCount; ++t) {
+        workers.emplace_back([&, t] {
+            for (;;) {
+                size_t begin = nextChunk.fetch_add(chunkSize);
+                if (begin >= count) break;
+                size_t end = std::min(count, begin + chunkSize);
+                for (size_t i = begin; i < end; ++i)
+                    fn(t, i);
+            }
+        });
+    }
+    for (std::thread& worker : workers)
+        worker.join();
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("bookBuilder");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Build a binary opening book from game collections");
+    parser.addHelpOption();
+    QCommandLineOption outputOption({ "o", "output" }, "Output book file.", "file", "book.bin");
+    QCommandLineOption pliesOption("plies", "Number of plies to record per game.", "n", "30");
+    QCommandLineOption minGamesOption("min-games", "Drop moves played fewer times.", "n", "2");
+    QCommandLineOption threadsOption({ "j", "threads" }, "Worker threads.", "n",
+                                     QString::number(std::max(1u, std::thread::hardware_concurrency())));
+    parser.addOptions({ outputOption, pliesOption, minGamesOption, threadsOption });
+    parser.addPositionalArgument("games", "Game collection files.", "games...");
+    parser.process(app);
+
+    const QStringList inputs = parser.positionalArguments();
+    if (inputs.isEmpty())
+        parser.showHelp(1);
+
+    const int maxPlies = parser.value(pliesOption).toInt();
+    const uint64_t minGames = parser.value(minGamesOption).toULongLong();
+    const int threadCount = std::max(1, parser.value(threadsOption).toInt());
+
+    QTextStream out(stdout);
+    std::vector<std::string> lines;
+    std::vector<GameRecord> records;
+    std::vector<std::unique_ptr<GameDatabase>> databases;
+    for (const QString& input : inputs) {
+        bool ok;
+        if (input.endsWith(".xdb")) {
+            databases.push_back(std::make_unique<GameDatabase>());
+            ok = databases.back()->open(input);
+        } else if (input.endsWith(".pgn")) {
+            ok = readRecords(input, records);
+        } else {
+            ok = readLines(input, lines);
+        }
+        if (!ok) {
+            out << "cannot read " << input << Qt::endl;
+            return 1;
+        }
+    }
+
+    // 统计写入线程私有表，最后合并；对局库按下标直接取局，只解析被取到的记录
+    std::vector<StatsMap> partial(threadCount);
+    size_t gameCount = lines.size() + records.size();
+    parallelFor(lines.size(), threadCount, [&](int t, size_t i) {
+        addGame(lines[i], maxPlies, partial[t]);
+    });
+    parallelFor(records.size(), threadCount, [&](int t, size_t i) {
+        addMoves(records[i].moves, winnerOf(records[i].result), maxPlies, partial[t]);
+    });
+    for (const auto& database : databases) {
+        gameCount += database->count();
+        parallelFor(database->count(), threadCount, [&](int t, size_t i) {
+            GameRecord game;
+            if (!database->game(uint32_t(i), game)) return;
+            if (!game.fen.empty() && game.startPosition().key() != Position::startPosition().key()) return;
+            addMoves(game.moves, winnerOf(game.result), maxPlies, partial[t]);
+        });
+    }
+
+    StatsMap merged = std::move(partial[0]);
+    for (int t = 1; t < threadCount; ++t) {
+        for (const auto& [k, s] : partial[t]) {
+            MoveStats& m = merged[k];
+            m.games += s.games;
+            m.wins += s.wins;
+            m.losses += s.losses;
+        }
+        partial[t].clear();
+    }
+
+    std::vector<BookEntry> entries;
+    entries.reserve(merged.size());
+    for (const auto& [k, s] : merged) {
+        if (s.games < minGames) continue;
+        // 超出16位时按比例缩放，保持胜率不变
+        uint64_t scale = s.games > 65535 ? (s.games + 65534) / 65535 : 1;
+        entries.push_back(BookEntry{ k.key, k.move, uint16_t(s.games / scale),
+                                     uint16_t(s.wins / scale), uint16_t(s.losses / scale) });
+    }
+    std::sort(entries.begin(), entries.end(), [](const BookEntry& a, const BookEntry& b) {
+        return a.key != b.key ? a.key < b.key : a.move < b.move;
+    });
+
+    const QString outputPath = parser.value(outputOption);
+    if (!OpeningBook::write(outputPath, entries)) {
+        out << "cannot write " << outputPath << Qt::endl;
+        return 1;
+    }
+    out << gameCount << " games, " << entries.size() << " book entries written to " << outputPath << Qt::endl;
+    return 0;
+}
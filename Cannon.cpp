@@ -1,8 +1,8 @@
 #include "Cannon.h"
 
 Cannon::Cannon(
-    QString name, QString color, int x, int y, QString icon, QObject *parent)
-    : ChessMan(name, color, x, y, icon, parent)
+    uint8_t code, int number, int x, int y, QObject *parent)
+    : ChessMan(code, number, x, y, parent)
 {}
 
 bool Cannon::canMove(
@@ -22,7 +22,7 @@ bool Cannon::canMove(
     }
 
     // 吃子：中间必须隔一个
-    if (targetPiece && targetPiece->color() != color() && count == 1) {
+    if (targetPiece && targetPiece->side() != side() && count == 1) {
         return true;
     }
 
@@ -6,8 +6,7 @@ class Cannon : public ChessMan {
     Q_OBJECT
 
 public:
-    explicit Cannon(
-        QString name, QString color, int x, int y, QString icon, QObject* parent = nullptr);
+    Cannon(uint8_t code, int number, int x, int y, QObject* parent = nullptr);
 
     //判断移动是否合法
     bool canMove(int targetX, int targetY, ChessMan* board[10][9]) override;
@@ -1,418 +1,209 @@
 #include "ChessAi.h"
-#include <QDebug>
+#include "AnalysisCache.h"
+#include "OpeningBook.h"
+#include "Tablebase.h"
+#include <cmath>
 #include <cstdlib>
 #include <ctime>
+#include <thread>
 #include <algorithm>
 #include <vector>
 #include <tuple>
 
-
-ChessAI::ChessAI() {
+// 入门、初级每步只有几千到几万个节点，几乎即时应着；高级以上用满预算且不随机
+// 缓存深度取该等级的节点预算在中局通常能完成的迭代深度
+const AiDifficulty ChessAI::kDifficulties[ChessAI::kDifficultyCount] = {
+    { "入门", 2,  3000,    200,  6, 250, false, 0 },
+    { "初级", 3,  30000,   500,  5, 120, false, 0 },
+    { "中级", 6,  300000,  1500, 3, 40,  false, 0 },
+    { "高级", 64, 1500000, 5000, 1, 0,   true,  7 },
+    { "大师", 64, 6000000, 15000, 1, 0,  true,  8 },
+};
+
+// 蒙特卡洛留一个核给界面线程，最多4个线程
+ChessAI::ChessAI()
+    : mcts(std::clamp(int(std::thread::hardware_concurrency()) - 1, 1, 4)) {
     std::srand(std::time(nullptr));
-    useClassicAI = true;
-}
-
-// 简化的评估函数 - 只考虑基本材料价值
-int ChessAI::evaluateBoard(ChessMan* board[10][9], QString playerColor) {
-    int score = 0;
-    QString opponentColor = (playerColor == "红") ? "黑" : "红";
-    
-    // 基础材料价值
-    for (int y = 0; y < 10; ++y) {
-        for (int x = 0; x < 9; ++x) {
-            ChessMan* piece = board[y][x];
-            if (!piece) continue;
-            
-            int pieceValue = 0;
-            
-            // 基础价值
-            if (piece->name().contains("King")) pieceValue = 10000;
-            else if (piece->name().contains("Rook")) pieceValue = 500;
-            else if (piece->name().contains("Horse")) pieceValue = 300;
-            else if (piece->name().contains("Cannon")) pieceValue = 300;
-            else if (piece->name().contains("Elephant")) pieceValue = 150;
-            else if (piece->name().contains("Advisor")) pieceValue = 150;
-            else if (piece->name().contains("Soldier")) {
-                // 过河兵价值更高
-                if ((piece->color() == "红" && y <= 4) || (piece->color() == "黑" && y >= 5)) {
-                    pieceValue = 200;  // 过河兵
-                } else {
-                    pieceValue = 100;  // 未过河兵
-                }
-            }
-            
-            if (piece->color() == playerColor) {
-                score += pieceValue;
-            } else {
-                score -= pieceValue;
-            }
-        }
-    }
-    
-    return score;
+    setDifficulty(kDefaultDifficulty);
 }
 
-// 移动排序
-void ChessAI::sortMoves(std::vector<std::tuple<ChessMan*, int, int>>& moves, ChessMan* board[10][9]) {
-    std::sort(moves.begin(), moves.end(), [board](const auto& a, const auto& b) {
-        int toXA = std::get<1>(a), toYA = std::get<2>(a);
-        int toXB = std::get<1>(b), toYB = std::get<2>(b);
-        
-        // 吃子移动优先
-        bool captureA = (board[toYA][toXA] != nullptr);
-        bool captureB = (board[toYB][toXB] != nullptr);
-        return captureA > captureB;
-    });
+// 选择最佳移动
+std::tuple<ChessMan*, int, int> ChessAI::selectBestMove(ChessMan* board[10][9], QString playerColor) {
+    Move move = chooseMove(toPosition(board, playerColor), history);
+    if (move == NO_MOVE) return std::make_tuple(nullptr, -1, -1);
+    return toBoardMove(board, move);
 }
 
-// Minimax算法 + Alpha-Beta剪枝
-int ChessAI::minimax(ChessMan* board[10][9], int depth, int alpha, int beta, bool maximizingPlayer, QString playerColor, ChessMan*& bestPiece, int& bestToX, int& bestToY) {
-    if (depth == 0) {
-        return evaluateBoard(board, playerColor);
-    }
-    
-    QString currentColor = maximizingPlayer ? playerColor : ((playerColor == "红") ? "黑" : "红");
-    std::vector<std::tuple<ChessMan*, int, int>> moves = generateMoves(board, currentColor);
-    
-    if (moves.empty()) {
-        return maximizingPlayer ? -999999 : 999999;
-    }
-    
-    //移动排序
-    sortMoves(moves, board);
-    
-    if (maximizingPlayer) {
-        int maxEval = -999999;
-        for (auto& move : moves) {
-            ChessMan* piece = std::get<0>(move);
-            int toX = std::get<1>(move);
-            int toY = std::get<2>(move);
-            
-            int fromX = piece->x();
-            int fromY = piece->y();
-            ChessMan* capturedPiece = board[toY][toX];
-            
-            // 执行移动
-            board[fromY][fromX] = nullptr;
-            board[toY][toX] = piece;
-            piece->setX(toX);
-            piece->setY(toY);
-            
-            ChessMan* tempBestPiece = nullptr;
-            int tempBestToX = -1, tempBestToY = -1;
-            int eval = minimax(board, depth - 1, alpha, beta, false, playerColor, tempBestPiece, tempBestToX, tempBestToY);
-            
-            // 恢复移动
-            piece->setX(fromX);
-            piece->setY(fromY);
-            board[fromY][fromX] = piece;
-            board[toY][toX] = capturedPiece;
-            
-            if (eval > maxEval) {
-                maxEval = eval;
-                if (depth == 4) {
-                    bestPiece = piece;
-                    bestToX = toX;
-                    bestToY = toY;
-                }
-            }
-            
-            alpha = std::max(alpha, eval);
-            if (beta <= alpha) break;
-        }
-        return maxEval;
+Move ChessAI::chooseMove(const Position& root, const std::vector<HistoryEntry>& gameHistory,
+                         const std::atomic<bool>* stop) {
+    Position pos = root;
+    lastPv.clear();
+
+    // 优先查询开局库与残局库
+    if (useOpeningBook || useTablebases) {
+        Move knownMove = NO_MOVE;
+        if (useTablebases && pos.totalPieces() <= Tablebases::kMaxPieces)
+            knownMove = Tablebases::instance().bestMove(pos);
+        if (knownMove == NO_MOVE && useOpeningBook)
+            knownMove = OpeningBook::defaultBook().probe(pos);
+        if (knownMove != NO_MOVE)
+            return knownMove;
+    }
+
+    // 循环中的局面分数取决于对局历史，不查也不写缓存；蒙特卡洛的结果没有搜索深度，也不用缓存
+    const bool cacheable = useAnalysisCache && engine == AiEngine::AlphaBeta && findRepetition(gameHistory) < 0;
+    const int cacheDepth = kDifficulties[difficulty].cacheDepth;
+    CachedAnalysis cached;
+    if (cacheable && cacheDepth > 0 && !(ponderValid && ponderKey == pos.key())
+        && AnalysisCache::defaultCache().probe(pos.key(), cacheDepth, cached)
+        && pos.isLegalMove(cached.pv.front())) {
+        ponderValid = false;
+        lastPv = cached.pv;
+        return cached.pv.front();
+    }
+
+    SearchResult result;
+    if (ponderValid && ponderKey == pos.key()) {
+        // 猜中对手应着，直接使用后台思考的结果
+        result = ponderResult;
+    } else if (engine == AiEngine::MonteCarlo) {
+        SearchLimits limits = searchLimits;
+        limits.nodes = std::max<uint64_t>(1, searchLimits.nodes / kNodesPerPlayout);
+        result = mcts.search(pos, gameHistory, limits, stop);
     } else {
-        int minEval = 999999;
-        for (auto& move : moves) {
-            ChessMan* piece = std::get<0>(move);
-            int toX = std::get<1>(move);
-            int toY = std::get<2>(move);
-            
-            int fromX = piece->x();
-            int fromY = piece->y();
-            ChessMan* capturedPiece = board[toY][toX];
-            
-            // 执行移动
-            board[fromY][fromX] = nullptr;
-            board[toY][toX] = piece;
-            piece->setX(toX);
-            piece->setY(toY);
-            
-            ChessMan* tempBestPiece = nullptr;
-            int tempBestToX = -1, tempBestToY = -1;
-            int eval = minimax(board, depth - 1, alpha, beta, true, playerColor, tempBestPiece, tempBestToX, tempBestToY);
-            
-            // 恢复移动
-            piece->setX(fromX);
-            piece->setY(fromY);
-            board[fromY][fromX] = piece;
-            board[toY][toX] = capturedPiece;
-            
-            minEval = std::min(minEval, eval);
-            beta = std::min(beta, eval);
-            if (beta <= alpha) break;
-        }
-        return minEval;
+        result = searcher.search(pos, gameHistory, searchLimits, stop);
+        if (cacheable)
+            AnalysisCache::defaultCache().store(pos.key(), result);
     }
-}
-
-// 生成所有合法移动 - 包含将军检查
-std::vector<std::tuple<ChessMan*, int, int>> ChessAI::generateMoves(ChessMan* board[10][9], QString playerColor) {
-    std::vector<std::tuple<ChessMan*, int, int>> moves;
-    bool isInCheck = checkForCheckAI(board, playerColor);
-    
-    for (int y = 0; y < 10; ++y) {
-        for (int x = 0; x < 9; ++x) {
-            ChessMan* piece = board[y][x];
-            if (piece && piece->color() == playerColor) {
-                for (int ty = 0; ty < 10; ++ty) {
-                    for (int tx = 0; tx < 9; ++tx) {
-                        if ((x != tx || y != ty) && piece->canMove(tx, ty, board)) {
-                            // 检查移动后是否会造成王对王
-                            if (!wouldCauseKingFacing(piece, tx, ty, board)) {
-                                // 检查移动后是否会让自己被将军
-                                if (!wouldCauseSelfCheck(piece, tx, ty, board)) {
-                                    // 如果被将军，只添加能解除将军的移动
-                                    if (isInCheck) {
-                                        if (canMoveResolveCheckAI(piece, tx, ty, board)) {
-                                            moves.emplace_back(piece, tx, ty);
-                                        }
-                                    } else {
-                                        moves.emplace_back(piece, tx, ty);
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-        }
-    }
-    
-    // 如果被将军但没有解除将军的移动，返回所有不会自杀的移动
-    if (isInCheck && moves.empty()) {
-        for (int y = 0; y < 10; ++y) {
-            for (int x = 0; x < 9; ++x) {
-                ChessMan* piece = board[y][x];
-                if (piece && piece->color() == playerColor) {
-                    for (int ty = 0; ty < 10; ++ty) {
-                        for (int tx = 0; tx < 9; ++tx) {
-                            if ((x != tx || y != ty) && piece->canMove(tx, ty, board)) {
-                                if (!wouldCauseKingFacing(piece, tx, ty, board) && 
-                                    !wouldCauseSelfCheck(piece, tx, ty, board)) {
-                                    moves.emplace_back(piece, tx, ty);
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-        }
+    ponderValid = false;
+    if (const SearchLine* line = pickLine(result)) {
+        lastPv = line->pv;
+        return line->pv.front();
     }
-    
-    return moves;
-}
 
-// 选择最佳移动
-std::tuple<ChessMan*, int, int> ChessAI::selectBestMove(ChessMan* board[10][9], QString playerColor) {
-    if (useClassicAI) {
-        ChessMan* bestPiece = nullptr;
-        int bestToX = -1, bestToY = -1;
-        
-        // 使用深度4的极大极小算法
-        minimax(board, 4, -999999, 999999, true, playerColor, bestPiece, bestToX, bestToY);
-        
-        if (bestPiece) {
-            return std::make_tuple(bestPiece, bestToX, bestToY);
-        }
-    }
-    
     // 备选随机移动
-    std::vector<std::tuple<ChessMan*, int, int>> moves = generateMoves(board, playerColor);
-    if (moves.empty()) return std::make_tuple(nullptr, -1, -1);
-    
-    int idx = std::rand() % moves.size();
-    return moves[idx];
+    Move moves[MAX_MOVES];
+    int count = pos.generateLegalMoves(moves);
+    if (count == 0) return NO_MOVE;
+    return moves[std::rand() % count];
 }
 
-void ChessAI::setUseClassicAI(bool useClassic) {
-    useClassicAI = useClassic;
+Move ChessAI::expectedReply() const {
+    return lastPv.size() >= 2 ? lastPv[1] : NO_MOVE;
 }
 
-bool ChessAI::getUseClassicAI() const {
-    return useClassicAI;
+void ChessAI::ponder(const Position& pos, const std::vector<HistoryEntry>& gameHistory,
+                     const std::atomic<bool>* stop, const std::atomic<bool>* ponderHit) {
+    ponderValid = false;
+    // 蒙特卡洛保留上一步的子树接着搜，不做后台思考
+    if (!kDifficulties[difficulty].ponder || engine == AiEngine::MonteCarlo) return;
+
+    SearchResult result = searcher.search(pos, gameHistory, searchLimits, stop, ponderHit);
+
+    // 被中止（猜错）的结果不完整，不保留；置换表中的内容仍可复用
+    if (stop && stop->load()) return;
+    if (useAnalysisCache && findRepetition(gameHistory) < 0)
+        AnalysisCache::defaultCache().store(pos.key(), result);
+    ponderKey = pos.key();
+    ponderResult = result;
+    ponderValid = true;
 }
 
-// === 将军检查相关函数 - 保留完整功能 ===
-
-// 检查移动后是否会造成王对王
-bool ChessAI::wouldCauseKingFacing(ChessMan* piece, int toX, int toY, ChessMan* board[10][9]) {
-    int fromX = piece->x();
-    int fromY = piece->y();
-    
-    // 暂存目标位置的棋子
-    ChessMan* originalTarget = board[toY][toX];
-    
-    // 执行移动
-    board[fromY][fromX] = nullptr;
-    board[toY][toX] = piece;
-    piece->setX(toX);
-    piece->setY(toY);
-    
-    // 获取双方的王
-    ChessMan* redKing = getKing(board, "红");
-    ChessMan* blackKing = getKing(board, "黑");
-    
-    bool wouldCauseFacing = false;
-    
-    if (redKing && blackKing) {
-        // 检查两个王是否在同一列
-        if (redKing->x() == blackKing->x()) {
-            // 检查两个王之间是否有其他棋子
-            int startY = std::min(redKing->y(), blackKing->y()) + 1;
-            int endY = std::max(redKing->y(), blackKing->y()) - 1;
-            
-            bool hasBlocker = false;
-            for (int y = startY; y <= endY; ++y) {
-                if (board[y][redKing->x()] != nullptr) {
-                    hasBlocker = true;
-                    break;
-                }
-            }
-            
-            if (!hasBlocker) {
-                wouldCauseFacing = true;
-            }
-        }
-    }
-    
-    // 恢复原状态
-    piece->setX(fromX);
-    piece->setY(fromY);
-    board[fromY][fromX] = piece;
-    board[toY][toX] = originalTarget;
-    
-    return wouldCauseFacing;
+std::tuple<ChessMan*, int, int> ChessAI::toBoardMove(ChessMan* board[10][9], Move move) const {
+    int from = moveFrom(move), to = moveTo(move);
+    return std::make_tuple(board[squareY(from)][squareX(from)], squareX(to), squareY(to));
 }
 
-// 检查移动是否能解除将军
-bool ChessAI::canMoveResolveCheckAI(ChessMan* piece, int toX, int toY, ChessMan* board[10][9]) {
-    if (!checkForCheckAI(board, piece->color())) {
-        return true; // 如果没有被将军，任何移动都可以
-    }
-
-    int fromX = piece->x();
-    int fromY = piece->y();
+const SearchLine* ChessAI::pickLine(const SearchResult& result) const {
+    if (result.lines.empty() || result.lines.front().pv.empty()) return nullptr;
 
-    // 暂存目标位置的棋子
-    ChessMan* targetPiece = board[toY][toX];
+    const int temperature = kDifficulties[difficulty].temperature;
+    if (temperature <= 0 || result.lines.size() == 1) return &result.lines.front();
 
-    // 暂时执行移动
-    board[fromY][fromX] = nullptr;
-    board[toY][toX] = piece;
-    int oldX = piece->x();
-    int oldY = piece->y();
-    piece->setX(toX);
-    piece->setY(toY);
-
-    // 如果是吃子，暂时将目标棋子移出棋盘
-    if (targetPiece) {
-        targetPiece->setX(-99);
-        targetPiece->setY(-99);
+    // 按exp(分差/温度)加权抽样，分差远大于温度的着法（如送杀）几乎不会被选中
+    const int best = result.lines.front().score;
+    std::vector<double> weights;
+    double total = 0;
+    for (const SearchLine& line : result.lines) {
+        double weight = line.pv.empty() ? 0.0 : std::exp(double(line.score - best) / temperature);
+        weights.push_back(weight);
+        total += weight;
+    }
+    double r = total * std::rand() / (double(RAND_MAX) + 1.0);
+    for (size_t i = 0; i < weights.size(); ++i) {
+        if (r < weights[i]) return &result.lines[i];
+        r -= weights[i];
     }
+    return &result.lines.front();
+}
 
-    // 检查移动后是否仍然被将军
-    bool stillInCheck = checkForCheckAI(board, piece->color());
+void ChessAI::setDifficulty(int level) {
+    difficulty = std::clamp(level, 0, kDifficultyCount - 1);
+    const AiDifficulty& d = kDifficulties[difficulty];
+    searchLimits.depth = d.depth;
+    searchLimits.nodes = d.nodes;
+    searchLimits.timeMs = d.timeMs;
+    searchLimits.multiPv = d.candidates;
+}
 
-    // 恢复原状态
-    piece->setX(oldX);
-    piece->setY(oldY);
-    board[fromY][fromX] = piece;
-    board[toY][toX] = targetPiece;
+int ChessAI::getDifficulty() const {
+    return difficulty;
+}
 
-    if (targetPiece) {
-        targetPiece->setX(toX);
-        targetPiece->setY(toY);
-    }
+void ChessAI::setEngine(AiEngine searchEngine) {
+    engine = searchEngine;
+}
 
-    return !stillInCheck;
+AiEngine ChessAI::getEngine() const {
+    return engine;
 }
 
-// 检查移动后是否会让自己被将军
-bool ChessAI::wouldCauseSelfCheck(ChessMan* piece, int toX, int toY, ChessMan* board[10][9]) {
-    int fromX = piece->x();
-    int fromY = piece->y();
+void ChessAI::setUseClassicAI(bool useClassic) {
+    setDifficulty(useClassic ? kDefaultDifficulty : 0);
+}
 
-    // 暂存目标位置的棋子
-    ChessMan* targetPiece = board[toY][toX];
+bool ChessAI::getUseClassicAI() const {
+    return difficulty > 0;
+}
 
-    // 暂时执行移动
-    board[fromY][fromX] = nullptr;
-    board[toY][toX] = piece;
-    int oldX = piece->x();
-    int oldY = piece->y();
-    piece->setX(toX);
-    piece->setY(toY);
+void ChessAI::setUseOpeningBook(bool useBook) {
+    useOpeningBook = useBook;
+}
 
-    // 如果是吃子，暂时将目标棋子移出棋盘
-    if (targetPiece) {
-        targetPiece->setX(-99);
-        targetPiece->setY(-99);
-    }
+bool ChessAI::getUseOpeningBook() const {
+    return useOpeningBook;
+}
 
-    // 检查移动后是否会被将军
-    bool wouldBeInCheck = checkForCheckAI(board, piece->color());
+void ChessAI::setUseTablebases(bool useTables) {
+    useTablebases = useTables;
+}
 
-    // 恢复原状态
-    piece->setX(oldX);
-    piece->setY(oldY);
-    board[fromY][fromX] = piece;
-    board[toY][toX] = targetPiece;
+bool ChessAI::getUseTablebases() const {
+    return useTablebases;
+}
 
-    if (targetPiece) {
-        targetPiece->setX(toX);
-        targetPiece->setY(toY);
-    }
+void ChessAI::setUseAnalysisCache(bool useCache) {
+    useAnalysisCache = useCache;
+}
 
-    return wouldBeInCheck;
+bool ChessAI::getUseAnalysisCache() const {
+    return useAnalysisCache;
 }
 
-// 在棋盘上找到指定颜色的王
-ChessMan* ChessAI::getKing(ChessMan* board[10][9], QString color) {
-    for (int y = 0; y < 10; ++y) {
-        for (int x = 0; x < 9; ++x) {
-            ChessMan* piece = board[y][x];
-            if (piece && piece->name().contains("King") && piece->color() == color) {
-                return piece;
-            }
-        }
-    }
-    return nullptr;
+void ChessAI::setHistory(const std::vector<HistoryEntry>& gameHistory) {
+    history = gameHistory;
 }
 
-// AI版本的将军检查函数
-bool ChessAI::checkForCheckAI(ChessMan* board[10][9], QString color) {
-    ChessMan* king = getKing(board, color);
-    if (!king || king->x() < 0 || king->x() >= 9 || king->y() < 0 || king->y() >= 10) {
-        return false;
-    }
-    
-    QString opponentColor = (color == "红") ? "黑" : "红";
-    int kingX = king->x();
-    int kingY = king->y();
-    
-    // 检查是否有敌方棋子能攻击到王
+Position ChessAI::toPosition(ChessMan* const board[10][9], const QString& playerColor) {
+    Position pos;
     for (int y = 0; y < 10; ++y) {
         for (int x = 0; x < 9; ++x) {
             ChessMan* piece = board[y][x];
-            if (piece && piece->color() == opponentColor) {
-                if (piece->canMove(kingX, kingY, board)) {
-                    return true;
-                }
-            }
+            if (!piece) continue;
+
+            pos.setPiece(squareOf(x, y), piece->code());
         }
     }
-    
-    return false;
+    pos.setSideToMove(playerColor == "红" ? SIDE_RED : SIDE_BLACK);
+    return pos;
 }
-
@@ -1,34 +1,104 @@
 #pragma once
 #include "ChessMan.h"
+#include "Mcts.h"
+#include "Position.h"
+#include "Search.h"
+#include <atomic>
 #include <tuple>
 #include <vector>
 
+// 难度等级：按节点数限定每步的计算量（与局面无关，服务器上每步耗时可预期）
+// 时间只作兜底上限；温度大于0时在前几个候选着中按分差随机选择，模拟失误
+struct AiDifficulty
+{
+    const char* name;
+    int depth;
+    uint64_t nodes;
+    int timeMs;
+    int candidates;     // 参与随机选择的候选着数（多变例搜索）
+    int temperature;    // 单位为分（兵=100），0为总走最佳着
+    bool ponder;        // 是否在对手思考时后台思考
+    int cacheDepth;     // 分析缓存中的结果至少这么深时直接使用，0为不用（随机选着需要多条变例）
+};
+
+// 搜索引擎：alpha-beta（默认）或蒙特卡洛树搜索，难度等级对两者都适用
+enum class AiEngine {
+    AlphaBeta,
+    MonteCarlo
+};
+
 class ChessAI
 {
 public:
+    static constexpr int kDifficultyCount = 5;
+    static const AiDifficulty kDifficulties[kDifficultyCount];
+    static constexpr int kDefaultDifficulty = 3;
+
     ChessAI();
     // 选择最佳移动，返回:棋子指针, 目标X坐标, 目标Y坐标
     std::tuple<ChessMan*, int, int> selectBestMove(ChessMan* board[10][9], QString playerColor);
+
+    // 在紧凑局面上选着，可在工作线程中调用（同一时刻只能有一个线程使用同一个ChessAI）
+    Move chooseMove(const Position& pos, const std::vector<HistoryEntry>& gameHistory,
+                    const std::atomic<bool>* stop = nullptr);
+
+    // 上一次搜索预测的对手应着（主要变例的第二步），没有时返回NO_MOVE
+    Move expectedReply() const;
+
+    // 后台思考：pos为预测应着之后轮到AI的局面，结果缓存到下一次chooseMove
+    // ponderHit置位后按正常限时继续；未置位时只在stop置位或搜完时结束
+    void ponder(const Position& pos, const std::vector<HistoryEntry>& gameHistory,
+                const std::atomic<bool>* stop, const std::atomic<bool>* ponderHit);
     
-    // 切换AI模式（经典/随机）
+    // 难度等级，0为最低
+    void setDifficulty(int level);
+    int getDifficulty() const;
+
+    // 蒙特卡洛的随机走子局数取难度节点数的1/kNodesPerPlayout（一局随机走子约合这么多个搜索节点）
+    static constexpr int kNodesPerPlayout = 100;
+    void setEngine(AiEngine engine);
+    AiEngine getEngine() const;
+
+    // 切换AI模式（经典/随机）：分别对应默认难度与最低难度
     void setUseClassicAI(bool useClassic);
     bool getUseClassicAI() const;
 
+    // 开局库（程序目录下的book.bin），命中时直接走库着
+    void setUseOpeningBook(bool useBook);
+    bool getUseOpeningBook() const;
+
+    // 残局库（程序目录下的tablebases/），少子残局直接按库走最短杀
+    void setUseTablebases(bool useTables);
+    bool getUseTablebases() const;
+
+    // 分析缓存（跨会话保存的搜索结果）：足够深时直接使用，新的搜索结果写回
+    void setUseAnalysisCache(bool useCache);
+    bool getUseAnalysisCache() const;
+
+    // 对局记录（末尾为当前局面），搜索据此判断重复、长将与长捉
+    void setHistory(const std::vector<HistoryEntry>& history);
+
+    // 将ChessMan棋盘转换为紧凑局面表示
+    static Position toPosition(ChessMan* const board[10][9], const QString& playerColor);
+
 private:
-    // 经典AI相关
-    int evaluateBoard(ChessMan* board[10][9], QString playerColor);
-    std::vector<std::tuple<ChessMan*, int, int>> generateMoves(ChessMan* board[10][9], QString playerColor);
-    int minimax(ChessMan* board[10][9], int depth, int alpha, int beta, bool maximizingPlayer, QString playerColor, ChessMan*& bestPiece, int& bestToX, int& bestToY);
-    void sortMoves(std::vector<std::tuple<ChessMan*, int, int>>& moves, ChessMan* board[10][9]);
-    
-    // 王对王检查函数
-    bool wouldCauseKingFacing(ChessMan* piece, int toX, int toY, ChessMan* board[10][9]);
-    ChessMan* getKing(ChessMan* board[10][9], QString color);
-    
-    // 将军检查相关函数
-    bool checkForCheckAI(ChessMan* board[10][9], QString color);
-    bool canMoveResolveCheckAI(ChessMan* piece, int toX, int toY, ChessMan* board[10][9]);
-    bool wouldCauseSelfCheck(ChessMan* piece, int toX, int toY, ChessMan* board[10][9]);
-    
-    bool useClassicAI = true;
+    std::tuple<ChessMan*, int, int> toBoardMove(ChessMan* board[10][9], Move move) const;
+    // 按当前难度的温度从搜索结果中选着，返回所选变例
+    const SearchLine* pickLine(const SearchResult& result) const;
+
+    Searcher searcher;
+    MctsSearcher mcts;
+    SearchLimits searchLimits;
+    std::vector<HistoryEntry> history;
+    std::vector<Move> lastPv;
+
+    // 后台思考的结果：局面键值一致时直接使用
+    uint64_t ponderKey = 0;
+    bool ponderValid = false;
+    SearchResult ponderResult;
+    int difficulty = kDefaultDifficulty;
+    AiEngine engine = AiEngine::AlphaBeta;
+    bool useOpeningBook = true;
+    bool useTablebases = true;
+    bool useAnalysisCache = true;
 };
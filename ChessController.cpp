@@ -1,8 +1,15 @@
 #include "ChessController.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QUrl>
 
 ChessController::ChessController(
     QObject* parent)
     : QObject(parent)
+    , m_pieceModel(new PieceModel(this))
     , m_currentPlayer("红")
     , m_roundNumber(1)
     , m_gameOver(false)
@@ -13,12 +20,24 @@ ChessController::ChessController(
     , m_selfCheckMove(false)
     , m_isAiMode(false)
     , aiColor("黑")
+    , m_aiPlayer(new AiPlayer(this))
+    , m_analysis(new AnalysisModel(this))
+    , m_explorer(new ExplorerModel(this))
+    , m_endgames(new EndgameBrowserModel(this))
 {
+    connect(m_aiPlayer, &AiPlayer::moveReady, this, &ChessController::onAiMoveReady);
     initializeGame();
 }
 
+ChessController::~ChessController()
+{
+    stopMateSolver();
+}
+
 void ChessController::initializeGame()
 {
+    StateBatch batch(this);
+
     // 清空棋盘
     for (int y = 0; y < 10; ++y) {
         for (int x = 0; x < 9; ++x) {
@@ -26,12 +45,15 @@ void ChessController::initializeGame()
         }
     }
 
-    // 清空棋子列表
-    qDeleteAll(m_pieces);
+    // 清空棋子列表（先让模型放开旧棋子），棋子放回池中供本局复用
+    m_pieceModel->clear();
+    m_piecePool.releaseAll();
     m_pieces.clear();
 
-    // 清空吃子记录
+    // 清空吃子记录与着法记录
     m_capturedPiecesInfo.clear();
+    m_journal.clear();
+    m_journalPly = 0;
 
     // 重置游戏状态
     m_currentPlayer = "红";
@@ -40,30 +62,35 @@ void ChessController::initializeGame()
     m_winner = "";
     m_isCheck = false;
     m_isCheckMate = false;
+    m_isStalemate = false;
     m_checkedPlayer = "";
 
     // 初始化所有棋子
-    if (m_isEndgameMode && !m_currentEndgame.isEmpty()) {
+    if (m_isEndgameMode && !m_currentEndgameId.isEmpty()) {
         // 残局模式：使用EndgameInitializer
-        m_pieces = EndgameInitializer::initializeEndgame(m_currentEndgame, m_board);
+        m_pieces = EndgameInitializer::initializeEndgame(m_currentEndgameId, m_piecePool, m_board);
         
         // 设置残局的先手方
-        QString firstPlayer = EndgameInitializer::getEndgameFirstPlayer(m_currentEndgame);
+        QString firstPlayer = EndgameInitializer::getEndgameFirstPlayer(m_currentEndgameId);
         m_currentPlayer = firstPlayer;
+    } else if (m_hasCustomStart) {
+        // 载入的棋谱：按其起始局面摆子
+        m_pieces = ChessInitializer::initializeFromPosition(m_customStart, m_piecePool, m_board);
+        m_currentPlayer = m_customStart.sideToMove() == SIDE_RED ? "红" : "黑";
     } else {
         // 标准模式：使用ChessInitializer
-        m_pieces = ChessInitializer::initializePieces(m_board);
+        m_pieces = ChessInitializer::initializePieces(m_piecePool, m_board);
     }
+    m_pieceModel->setPieces(m_pieces);
+    m_startPlayer = m_currentPlayer;
 
-    // 发送信号通知UI更新
-    emit chessDataChanged();
-    emit currentPlayerChanged();
-    emit roundNumberChanged();
-    emit capturedPiecesChanged();
-    emit gameOverChanged();
-    emit winnerChanged();
-    emit isCheckChanged();
-    emit isCheckMateChanged();
+    Position start = ChessAI::toPosition(m_board, m_currentPlayer);
+    m_startFen = start.key() == Position::startPosition().key() ? std::string() : start.toFen();
+
+    ++m_boardVersion;
+
+    resetHistory();
+    afterPositionChanged();
 }
 
 QList<QObject*> ChessController::getRawPieces() const
@@ -101,6 +128,11 @@ bool ChessController::isCheckMate() const
     return m_isCheckMate;
 }
 
+bool ChessController::isStalemate() const
+{
+    return m_isStalemate;
+}
+
 QString ChessController::checkedPlayer() const
 {
     return m_checkedPlayer;
@@ -111,14 +143,6 @@ bool ChessController::selfCheckMove() const
     return m_selfCheckMove;
 }
 
-QVariantList ChessController::getPieces() const
-{
-    QVariantList list;
-    for (QObject* obj : m_pieces)
-        list.append(QVariant::fromValue(obj));
-    return list;
-}
-
 QVariantList ChessController::capturedPieces() const
 {
     QVariantList result;
@@ -136,47 +160,27 @@ QVariantList ChessController::capturedPieces() const
 
 void ChessController::resetGame()
 {
+    StateBatch batch(this);
+
+    // 沿着法记录退回开局，棋子对象原样复用
+    while (m_journalPly > 0)
+        undoPly();
+    m_journal.clear();
+
     m_gameOver = false;
     m_winner = "";
-    m_currentPlayer = "红";
+    m_currentPlayer = m_startPlayer;
     m_roundNumber = 1;
     m_isCheck = false;
     m_isCheckMate = false;
+    m_isStalemate = false;
     m_checkedPlayer = "";
     m_selfCheckMove = false;
     m_capturedPiecesInfo.clear();
-
-    // 清空棋盘
-    for (int y = 0; y < 10; ++y) {
-        for (int x = 0; x < 9; ++x) {
-            m_board[y][x] = nullptr;
-        }
-    }
-
-    // 重新初始化棋子
-    if (m_isEndgameMode && !m_currentEndgame.isEmpty()) {
-        // 残局模式：使用EndgameInitializer
-        m_pieces = EndgameInitializer::initializeEndgame(m_currentEndgame, m_board);
-        
-        // 设置残局的先手方
-        QString firstPlayer = EndgameInitializer::getEndgameFirstPlayer(m_currentEndgame);
-        m_currentPlayer = firstPlayer;
-    } else {
-        // 标准模式：使用ChessInitializer
-        m_pieces = ChessInitializer::initializePieces(m_board);
-    }
-
-    // 发送信号通知UI更新
-    emit gameOverChanged();
-    emit winnerChanged();
-    emit currentPlayerChanged();
-    emit roundNumberChanged();
-    emit isCheckChanged();
-    emit isCheckMateChanged();
-    emit checkedPlayerChanged();
     emit selfCheckMoveChanged();
-    emit capturedPiecesChanged();
-    emit chessDataChanged();
+
+    resetHistory();
+    afterPositionChanged();
 }
 
 ChessMan* ChessController::getKing(
@@ -184,7 +188,7 @@ ChessMan* ChessController::getKing(
 {
     for (QObject* obj : m_pieces) {
         ChessMan* piece = qobject_cast<ChessMan*>(obj);
-        if (piece && piece->name().contains("King") && piece->color() == color && piece->x() >= 0) {
+        if (piece && piece->type() == PT_KING && piece->color() == color && piece->x() >= 0) {
             return piece;
         }
     }
@@ -193,177 +197,25 @@ ChessMan* ChessController::getKing(
 
 bool ChessController::checkForCheck(const QString& color)
 {
-    static int checkDepth = 0;
-    if (++checkDepth > 3) {
-        checkDepth--;
-        return false;
-    }
-
-    ChessMan* king = getKing(color);
-    if (!king || king->x() < 0 || king->x() >= 9 || king->y() < 0 || king->y() >= 10) {
-        checkDepth--;
-        return false;
-    }
-
-    int kingX = king->x(), kingY = king->y();
-    int pieceChecked = 0;
-    const int maxChecks = 32;
-
-    for (QObject* obj : m_pieces) {
-        if (pieceChecked++ > maxChecks) break;
-        
-        ChessMan* piece = qobject_cast<ChessMan*>(obj);
-        if (piece && piece->color() != color && piece->x() >= 0 && piece->y() >= 0 && piece->canMove(kingX, kingY, m_board)) {
-            checkDepth--;
-            return true;
-        }
-    }
-
-    checkDepth--;
-    return false;
+    // 在紧凑局面上判断，包含王对王照面
+    Position pos = ChessAI::toPosition(m_board, color);
+    if (pos.kingSquare(pos.sideToMove()) < 0) return false;
+    return pos.isInCheck(pos.sideToMove());
 }
 
 bool ChessController::checkForCheckMate(const QString& color)
 {
-    static int mateCheckDepth = 0;
-    if (++mateCheckDepth > 2) {
-        mateCheckDepth--;
-        return false;
-    }
-
-    if (!checkForCheck(color)) {
-        mateCheckDepth--;
-        return false;
-    }
-
-    int piecesChecked = 0;
-    const int maxPiecesToCheck = 32;
-
-    for (QObject* obj : m_pieces) {
-        if (piecesChecked++ > maxPiecesToCheck) {
-            mateCheckDepth--;
-            return false;
-        }
-
-        ChessMan* piece = qobject_cast<ChessMan*>(obj);
-        if (!piece || piece->color() != color || 
-            piece->x() < 0 || piece->x() >= 9 || piece->y() < 0 || piece->y() >= 10) continue;
-
-        int fromX = piece->x(), fromY = piece->y();
-        int positionsChecked = 0;
-        const int maxPositionsToCheck = 100;
-
-        for (int toY = 0; toY < 10 && positionsChecked < maxPositionsToCheck; ++toY) {
-            for (int toX = 0; toX < 9 && positionsChecked < maxPositionsToCheck; ++toX) {
-                positionsChecked++;
-                if (toX == fromX && toY == fromY) continue;
-                if (abs(toX - fromX) + abs(toY - fromY) > 10) continue;
-
-                try {
-                    if (piece->canMove(toX, toY, m_board)) {
-                        ChessMan* targetPiece = m_board[toY][toX];
-                        
-                        // 临时移动
-                        m_board[fromY][fromX] = nullptr;
-                        m_board[toY][toX] = piece;
-                        int oldX = piece->x(), oldY = piece->y();
-                        piece->setX(toX);
-                        piece->setY(toY);
-
-                        bool isCapture = targetPiece != nullptr;
-                        int targetOldX = -99, targetOldY = -99;
-                        if (isCapture) {
-                            targetOldX = targetPiece->x();
-                            targetOldY = targetPiece->y();
-                            targetPiece->setX(-99);
-                            targetPiece->setY(-99);
-                        }
-
-                        bool stillInCheck = checkForCheck(color);
-
-                        // 恢复状态
-                        piece->setX(oldX);
-                        piece->setY(oldY);
-                        m_board[fromY][fromX] = piece;
-                        m_board[toY][toX] = targetPiece;
-                        if (isCapture) {
-                            targetPiece->setX(targetOldX);
-                            targetPiece->setY(targetOldY);
-                        }
-
-                        if (!stillInCheck) {
-                            mateCheckDepth--;
-                            return false;
-                        }
-                    }
-                } catch (...) {
-                    continue;
-                }
-            }
-        }
-    }
-
-    mateCheckDepth--;
-    return true;
+    // 找到第一个合法着法即返回，不必生成全部着法
+    Position pos = ChessAI::toPosition(m_board, color);
+    if (pos.kingSquare(pos.sideToMove()) < 0) return false;
+    return pos.isInCheck(pos.sideToMove()) && !pos.hasLegalMove();
 }
 
-bool ChessController::canMoveResolveCheck(
-    ChessMan* piece, int toX, int toY)
+bool ChessController::checkForStalemate(const QString& color)
 {
-    if (!m_isCheck)
-        return true; // 如果没有被将军，任何移动都可以
-
-    int fromX = piece->x();
-    int fromY = piece->y();
-
-    // 暂存目标位置的棋子（如果有）
-    ChessMan* targetPiece = m_board[toY][toX];
-
-    m_board[toY][toX] = nullptr;
-
-    // 暂时执行这个移动
-    m_board[fromY][fromX] = nullptr;
-    m_board[toY][toX] = piece;
-    int oldX = piece->x();
-    int oldY = piece->y();
-    piece->setX(toX);
-    piece->setY(toY);
-
-    // 如果是吃子，暂时将目标棋子移出棋盘
-    int targetOldX = -99;
-    int targetOldY = -99;
-    bool isCapture = targetPiece != nullptr;
-
-    if (isCapture) {
-        // 保存原始坐标
-        targetOldX = targetPiece->x();
-        targetOldY = targetPiece->y();
-        // 临时设置为棋盘外位置
-        targetPiece->setX(-99);
-        targetPiece->setY(-99);
-    }
-
-    // 检查移动后是否仍然被将军
-    bool stillInCheck = checkForCheck(piece->color());
-
-    // 恢复棋盘状态
-    piece->setX(oldX);
-    piece->setY(oldY);
-    m_board[fromY][fromX] = piece;
-    m_board[toY][toX] = targetPiece;
-
-    // 如果是吃子，恢复被吃掉的棋子状态
-    if (isCapture && targetPiece) {
-        targetPiece->setX(targetOldX);
-        targetPiece->setY(targetOldY);
-    }
-
-    if (isCapture && !stillInCheck) {
-        return true; // 通过吃掉可以解除将军状态
-    }
-
-    // 如果这个移动可以解除将军，则返回true
-    return !stillInCheck;
+    Position pos = ChessAI::toPosition(m_board, color);
+    if (pos.kingSquare(pos.sideToMove()) < 0) return false;
+    return !pos.isInCheck(pos.sideToMove()) && !pos.hasLegalMove();
 }
 
 bool ChessController::isKingFacingKing() const
@@ -394,6 +246,8 @@ bool ChessController::isKingFacingKing() const
 
 void ChessController::updateCheckStatus()
 {
+    StateBatch batch(this);
+
     // 首先检查是否有"将/帅"被吃掉（游戏应该已经结束）
     ChessMan* redKing = getKing("红");
     ChessMan* blackKing = getKing("黑");
@@ -404,11 +258,6 @@ void ChessController::updateCheckStatus()
         m_isCheck = false;
         m_isCheckMate = false;
         m_checkedPlayer = "";
-        emit gameOverChanged();
-        emit winnerChanged();
-        emit isCheckChanged();
-        emit isCheckMateChanged();
-        emit checkedPlayerChanged();
         return;
     }
     
@@ -418,11 +267,6 @@ void ChessController::updateCheckStatus()
         m_isCheck = false;
         m_isCheckMate = false;
         m_checkedPlayer = "";
-        emit gameOverChanged();
-        emit winnerChanged();
-        emit isCheckChanged();
-        emit isCheckMateChanged();
-        emit checkedPlayerChanged();
         return;
     }
 
@@ -444,11 +288,12 @@ void ChessController::updateCheckStatus()
     } else {
         m_isCheckMate = false;
         m_checkedPlayer = "";
+        m_isStalemate = checkForStalemate(m_currentPlayer);
+        if (m_isStalemate) {
+            m_gameOver = true;
+            m_winner = (m_currentPlayer == "红") ? "黑" : "红";
+        }
     }
-
-    emit isCheckChanged();
-    emit isCheckMateChanged();
-    emit checkedPlayerChanged();
 }
 
 void ChessController::capturePieceAt(int x, int y, ChessMan* capturingPiece)
@@ -458,6 +303,8 @@ void ChessController::capturePieceAt(int x, int y, ChessMan* capturingPiece)
     ChessMan* targetPiece = m_board[y][x];
     if (!targetPiece || targetPiece->color() == capturingPiece->color()) return;
 
+    StateBatch batch(this);
+
     // 记录被吃掉的棋子
     CapturePieceInfo capturedInfo;
     capturedInfo.name = targetPiece->name();
@@ -468,19 +315,16 @@ void ChessController::capturePieceAt(int x, int y, ChessMan* capturingPiece)
     m_capturedPiecesInfo.append(capturedInfo);
 
     // 检查是否吃掉了将/帅
-    if (targetPiece->name().contains("King")) {
+    if (targetPiece->type() == PT_KING) {
         m_gameOver = true;
         m_winner = capturingPiece->color();
-        emit gameOverChanged();
-        emit winnerChanged();
     }
 
     // 更新棋盘数组
     m_board[y][x] = nullptr;
     targetPiece->setX(-99);
     targetPiece->setY(-99);
-
-    emit capturedPiecesChanged();
+    ++m_boardVersion;
 }
 
 void ChessController::handleMove(int fromIndex, int toX, int toY)
@@ -503,103 +347,46 @@ void ChessController::handleMove(int fromIndex, int toX, int toY)
 
     if (m_board[fromY][fromX] != piece) return;
 
-    ChessMan* targetPiece = m_board[toY][toX];
-    bool canMove = piece->canMove(toX, toY, m_board);
-    if (!canMove) return;
-
-    // 检查是否能解除将军
-    if (m_isCheck && m_checkedPlayer == piece->color()) {
-        if (!canMoveResolveCheck(piece, toX, toY)) {
-            m_selfCheckMove = true;
-            emit selfCheckMoveChanged();
-            QTimer::singleShot(1000, this, [this]() {
-                m_selfCheckMove = false;
-                emit selfCheckMoveChanged();
-            });
-            return;
-        }
-    }
-
-    // 检查移动后是否会自己被将军
-    m_board[fromY][fromX] = nullptr;
-    m_board[toY][toX] = piece;
-    int oldX = piece->x(), oldY = piece->y();
-    piece->setX(toX);
-    piece->setY(toY);
-
-    bool isCapture = targetPiece != nullptr;
-    int targetOldX = -99, targetOldY = -99;
-    if (isCapture) {
-        targetOldX = targetPiece->x();
-        targetOldY = targetPiece->y();
-        targetPiece->setX(-99);
-        targetPiece->setY(-99);
+    // 按本回合生成的合法着法查表；符合走法但会送将的着法给出提示
+    const int from = squareOf(fromX, fromY), to = squareOf(toX, toY);
+    if (!m_legalTargets[from].test(to)) {
+        if (m_pseudoTargets[from].test(to))
+            flashSelfCheckMove();
+        return;
     }
 
-    bool wouldBeInCheck = checkForCheck(piece->color());
+    // 走子引起的全部状态变化在批处理结束时合并通知
+    StateBatch batch(this);
 
-    // 恢复状态
-    piece->setX(oldX);
-    piece->setY(oldY);
-    m_board[fromY][fromX] = piece;
-    m_board[toY][toX] = targetPiece;
-    if (isCapture) {
-        targetPiece->setX(targetOldX);
-        targetPiece->setY(targetOldY);
-    }
+    // 从中间局面走出新着时丢弃原来的后续着法
+    m_journal.resize(m_journalPly);
+    applyMove(fromIndex, toX, toY);
+    afterPositionChanged();
+}
 
-    if (wouldBeInCheck) {
-        m_selfCheckMove = true;
-        emit selfCheckMoveChanged();
-        QTimer::singleShot(1000, this, [this]() {
-            m_selfCheckMove = false;
-            emit selfCheckMoveChanged();
-        });
-        return;
-    }
+void ChessController::applyMove(int pieceIndex, int toX, int toY)
+{
+    ChessMan* piece = qobject_cast<ChessMan*>(m_pieces[pieceIndex]);
+    const int fromX = piece->x();
+    const int fromY = piece->y();
+    ChessMan* targetPiece = m_board[toY][toX];
 
-    // 检查移动后是否会造成王对王（所有移动都需要检查）
-    // 模拟移动后的棋盘状态
-    ChessMan* tempBoard[10][9];
-    for (int y = 0; y < 10; ++y) {
-        for (int x = 0; x < 9; ++x) {
-            tempBoard[y][x] = m_board[y][x];
-        }
-    }
-    
-    // 在临时棋盘上执行移动
-    tempBoard[fromY][fromX] = nullptr;
-    tempBoard[toY][toX] = piece;
-    
-    // 检查移动后的王对王
-    ChessMan* redKing = getKing("红");
-    ChessMan* blackKing = getKing("黑");
-    
-    if (redKing && blackKing) {
-        // 获取移动后的王的位置
-        int redKingX = (redKing == piece) ? toX : redKing->x();
-        int redKingY = (redKing == piece) ? toY : redKing->y();
-        int blackKingX = (blackKing == piece) ? toX : blackKing->x();
-        int blackKingY = (blackKing == piece) ? toY : blackKing->y();
-        
-        // 检查是否在同一列
-        if (redKingX == blackKingX) {
-            int minY = qMin(redKingY, blackKingY);
-            int maxY = qMax(redKingY, blackKingY);
-            
-            bool blocked = false;
-            for (int y = minY + 1; y < maxY; ++y) {
-                if (tempBoard[y][redKingX]) {
-                    blocked = true;
-                    break;
-                }
-            }
-            if (!blocked) {
-                // 移动后会造成王对王，阻止移动
-                return;
-            }
-        }
-    }
+    // 记录走子前的状态，悔棋时原样恢复
+    JournalEntry entry;
+    entry.from = uint8_t(squareOf(fromX, fromY));
+    entry.to = uint8_t(squareOf(toX, toY));
+    entry.pieceIndex = int8_t(pieceIndex);
+    entry.capturedIndex = int8_t(targetPiece ? m_pieces.indexOf(targetPiece) : -1);
+    entry.flags = (m_isCheck ? JournalCheck : 0) | (m_isCheckMate ? JournalCheckMate : 0)
+                | (m_isStalemate ? JournalStalemate : 0) | (m_gameOver ? JournalGameOver : 0);
+    entry.checkedPlayer = colorCode(m_checkedPlayer);
+    entry.winner = colorCode(m_winner);
+    entry.roundNumber = int16_t(m_roundNumber);
+    if (m_journalPly < m_journal.size())
+        m_journal[m_journalPly] = entry;
+    else
+        m_journal.push_back(entry);
+    ++m_journalPly;
 
     // 执行移动
     if (targetPiece) {
@@ -610,17 +397,14 @@ void ChessController::handleMove(int fromIndex, int toX, int toY)
         captureInfo.capturedBy = piece->name();
         captureInfo.round = m_roundNumber;
         m_capturedPiecesInfo.append(captureInfo);
-        emit capturedPiecesChanged();
 
         targetPiece->setX(-99);
         targetPiece->setY(-99);
 
         // 检查游戏结束
-        if (targetPiece->name().contains("King")) {
+        if (targetPiece->type() == PT_KING) {
             m_gameOver = true;
             m_winner = piece->color();
-            emit gameOverChanged();
-            emit winnerChanged();
         }
     }
 
@@ -629,13 +413,11 @@ void ChessController::handleMove(int fromIndex, int toX, int toY)
     piece->setX(toX);
     piece->setY(toY);
     m_board[toY][toX] = piece;
+    ++m_boardVersion;
 
     // 切换玩家
     m_currentPlayer = (m_currentPlayer == "红") ? "黑" : "红";
-    emit currentPlayerChanged();
-
     m_roundNumber++;
-    emit roundNumberChanged();
 
     // 检查将军状态
     QString opponentColor = (piece->color() == "红") ? "黑" : "红";
@@ -649,51 +431,38 @@ void ChessController::handleMove(int fromIndex, int toX, int toY)
             m_isCheckMate = true;
             m_gameOver = true;
             m_winner = piece->color();
-            emit gameOverChanged();
-            emit winnerChanged();
         }
     } else {
         m_isCheck = false;
         m_isCheckMate = false;
         m_checkedPlayer = "";
+        // 困毙：无子可动的一方判负
+        if (checkForStalemate(opponentColor)) {
+            m_isStalemate = true;
+            m_gameOver = true;
+            m_winner = piece->color();
+        }
     }
 
-    emit isCheckChanged();
-    emit isCheckMateChanged();
-    emit checkedPlayerChanged();
-    emit chessDataChanged();
+    recordMove(fromX, fromY, toX, toY, targetPiece != nullptr);
+}
+
+void ChessController::afterPositionChanged()
+{
+    updateLegalMoves();
 
-    // AI回合
-    if (m_isAiMode && m_currentPlayer == aiColor && !m_gameOver) {
-        QTimer::singleShot(500, this, [this]() {
-            if (m_currentPlayer != aiColor) return;
-
-            ChessAI ai;
-            auto [selectedPiece, targetX, targetY] = ai.selectBestMove(m_board, aiColor);
-
-            if (selectedPiece && targetX >= 0 && targetX < 9 && targetY >= 0 && targetY < 10 &&
-                selectedPiece->color() == aiColor && selectedPiece->canMove(targetX, targetY, m_board)) {
-                
-                int pieceIndex = -1;
-                for (int i = 0; i < m_pieces.size(); ++i) {
-                    if (m_pieces[i] == selectedPiece) {
-                        pieceIndex = i;
-                        break;
-                    }
-                }
-
-                if (pieceIndex >= 0) {
-                    handleMove(pieceIndex, targetX, targetY);
-                }
-            } else {
-                // AI认输
-                m_gameOver = true;
-                m_winner = (aiColor == "红") ? "黑" : "红";
-                emit gameOverChanged();
-                emit winnerChanged();
-            }
-        });
+    // 残局模式下每步之后重新求解连杀；先手方取胜即记为已完成
+    if (m_isEndgameMode) {
+        updateMateSolver();
+        if (m_gameOver && m_winner == EndgameInitializer::getEndgameFirstPlayer(m_currentEndgameId))
+            m_endgames->setSolved(m_currentEndgameId, true);
     }
+    updateAnalysis();
+    updateExplorer();
+
+    // AI回合
+    updateAiPlayer();
+    emit journalChanged();
 }
 
 void ChessController::toggleAIMode()
@@ -703,57 +472,20 @@ void ChessController::toggleAIMode()
     emit aiModeChanged();
 }
 
+void ChessController::toggleAnalysisMode()
+{
+    m_analysisMode = !m_analysisMode;
+    updateAnalysis();
+    emit analysisModeChanged();
+}
+
 void ChessController::switchTurn()
 {
+    StateBatch batch(this);
     m_currentPlayer = (m_currentPlayer == "红") ? "黑" : "红";
-    emit currentPlayerChanged();
-
-    if (m_isAiMode && m_currentPlayer == aiColor) {
-        QTimer::singleShot(500, this, [this]() {
-            if (m_currentPlayer != aiColor) return;
-
-            ChessAI ai;
-            auto [selectedPiece, targetX, targetY] = ai.selectBestMove(m_board, aiColor);
-
-            if (selectedPiece && targetX >= 0 && targetX < 9 && targetY >= 0 && targetY < 10 &&
-                selectedPiece->color() == aiColor && selectedPiece->canMove(targetX, targetY, m_board)) {
-                
-                int pieceIndex = -1;
-                for (int i = 0; i < m_pieces.size(); ++i) {
-                    if (m_pieces[i] == selectedPiece) {
-                        pieceIndex = i;
-                        break;
-                    }
-                }
-
-                if (pieceIndex >= 0) {
-                    handleMove(pieceIndex, targetX, targetY);
-                } else {
-                    // 尝试通过坐标查找
-                    int fromX = selectedPiece->x(), fromY = selectedPiece->y();
-                    ChessMan* boardPiece = m_board[fromY][fromX];
-                    if (boardPiece == selectedPiece) {
-                        for (int i = 0; i < m_pieces.size(); ++i) {
-                            ChessMan* p = qobject_cast<ChessMan*>(m_pieces[i]);
-                            if (p && p->x() == fromX && p->y() == fromY && p->color() == aiColor) {
-                                pieceIndex = i;
-                                break;
-                            }
-                        }
-                        if (pieceIndex >= 0) {
-                            handleMove(pieceIndex, targetX, targetY);
-                        }
-                    }
-                }
-            } else {
-                // AI认输
-                m_gameOver = true;
-                m_winner = (aiColor == "红") ? "黑" : "红";
-                emit gameOverChanged();
-                emit winnerChanged();
-            }
-        });
-    }
+
+    updateLegalMoves();
+    updateAiPlayer();
 }
 
 bool ChessController::isAiMode() const
@@ -761,6 +493,44 @@ bool ChessController::isAiMode() const
     return m_isAiMode;
 }
 
+int ChessController::aiLevel() const
+{
+    return m_aiPlayer->difficulty();
+}
+
+void ChessController::setAiLevel(int level)
+{
+    if (level == m_aiPlayer->difficulty()) return;
+    m_aiPlayer->setDifficulty(level);
+    emit aiLevelChanged();
+}
+
+QStringList ChessController::getAiLevelNames() const
+{
+    QStringList names;
+    for (const AiDifficulty& difficulty : ChessAI::kDifficulties)
+        names.append(QString::fromUtf8(difficulty.name));
+    return names;
+}
+
+int ChessController::aiEngine() const
+{
+    return int(m_aiPlayer->engine());
+}
+
+void ChessController::setAiEngine(int engine)
+{
+    const AiEngine value = engine == int(AiEngine::MonteCarlo) ? AiEngine::MonteCarlo : AiEngine::AlphaBeta;
+    if (value == m_aiPlayer->engine()) return;
+    m_aiPlayer->setEngine(value);
+    emit aiEngineChanged();
+}
+
+QStringList ChessController::getAiEngineNames() const
+{
+    return { "搜索树", "蒙特卡洛" };
+}
+
 bool ChessController::isEndgameMode() const
 {
     return m_isEndgameMode;
@@ -768,13 +538,19 @@ bool ChessController::isEndgameMode() const
 
 QString ChessController::currentEndgame() const
 {
-    return m_currentEndgame;
+    return EndgameInitializer::getEndgameName(m_currentEndgameId);
 }
 
-void ChessController::startEndgame(const QString& endgameName)
+QString ChessController::currentEndgameId() const
+{
+    return m_currentEndgameId;
+}
+
+void ChessController::startEndgame(const QString& endgameId)
 {
     m_isEndgameMode = true;
-    m_currentEndgame = endgameName;
+    m_currentEndgameId = endgameId;
+    m_hasCustomStart = false;
     
     // 重新初始化游戏
     initializeGame();
@@ -792,9 +568,10 @@ QStringList ChessController::getEndgameList()
 void ChessController::exitEndgameMode()
 {
     m_isEndgameMode = false;
-    m_currentEndgame = "";
-    
-    // 重新初始化为标准游戏
+    m_currentEndgameId = "";
+    m_hasCustomStart = false;
+
+    // 重新初始化为标准游戏（同时清除连杀结果）
     initializeGame();
     
     // 发送信号通知UI更新
@@ -802,12 +579,580 @@ void ChessController::exitEndgameMode()
     emit currentEndgameChanged();
 }
 
-QString ChessController::getEndgameDescription(const QString& endgameName)
+QString ChessController::getEndgameDescription(const QString& endgameId)
+{
+    return EndgameInitializer::getEndgameDescription(endgameId);
+}
+
+int ChessController::getEndgameDifficulty(const QString& endgameId)
+{
+    return EndgameInitializer::getEndgameDifficulty(endgameId);
+}
+
+QString ChessController::getEndgameFirstPlayer(const QString& endgameId)
+{
+    return EndgameInitializer::getEndgameFirstPlayer(endgameId);
+}
+
+int ChessController::mateInMoves() const
+{
+    return m_mateInMoves;
+}
+
+QString ChessController::mateSolution() const
+{
+    return m_mateSolution;
+}
+
+QVariantList ChessController::mateHint() const
+{
+    if (m_mateMoves.empty()) return {};
+
+    // 只有局面与求解时一致才给出提示
+    Position pos = ChessAI::toPosition(m_board, m_currentPlayer);
+    if (pos.key() != m_mateKey) return {};
+
+    Move move = m_mateMoves.front();
+    return { squareX(moveFrom(move)), squareY(moveFrom(move)), squareX(moveTo(move)), squareY(moveTo(move)) };
+}
+
+bool ChessController::solverRunning() const
+{
+    return m_solverRunning;
+}
+
+void ChessController::stopMateSolver()
+{
+    if (!m_mateThread) return;
+
+    // 求解器每1024个节点检查一次中止标志，这里的等待很短
+    m_mateStop->store(true);
+    m_mateThread->wait();
+    delete m_mateThread;
+    m_mateThread = nullptr;
+}
+
+void ChessController::updateMateSolver()
+{
+    stopMateSolver();
+    ++m_mateGeneration;
+    m_mateMoves.clear();
+    m_mateInMoves = 0;
+    m_mateSolution.clear();
+
+    // 只在轮到残局先手方（攻方）时求解
+    bool running = m_isEndgameMode && !m_gameOver &&
+                   m_currentPlayer == EndgameInitializer::getEndgameFirstPlayer(m_currentEndgameId);
+    if (running) {
+        Position pos = ChessAI::toPosition(m_board, m_currentPlayer);
+        m_mateKey = pos.key();
+        m_mateStop = std::make_shared<std::atomic<bool>>(false);
+
+        int generation = m_mateGeneration;
+        auto stop = m_mateStop;
+        m_mateThread = QThread::create([this, pos, stop, generation]() {
+            MateSolver solver;
+            MateResult result = solver.solve(pos, kMateNodeLimit, stop.get());
+            QMetaObject::invokeMethod(this, [this, generation, result]() {
+                onMateSolved(generation, result);
+            }, Qt::QueuedConnection);
+        });
+        m_mateThread->start();
+    }
+
+    if (m_solverRunning != running) {
+        m_solverRunning = running;
+        emit solverRunningChanged();
+    }
+    emit mateSolutionChanged();
+}
+
+void ChessController::onMateSolved(int generation, const MateResult& result)
+{
+    if (generation != m_mateGeneration) return;
+
+    if (result.found) {
+        m_mateMoves = result.pv;
+        m_mateInMoves = result.mateInMoves;
+        QStringList moves;
+        for (Move move : result.pv)
+            moves.append(QString::fromStdString(Position::moveToIccs(move)));
+        m_mateSolution = moves.join(" ");
+    }
+
+    m_solverRunning = false;
+    emit solverRunningChanged();
+    emit mateSolutionChanged();
+}
+
+void ChessController::resetHistory()
+{
+    Position pos = ChessAI::toPosition(m_board, m_currentPlayer);
+    m_history.clear();
+    m_history.push_back({ pos.key(), NO_MOVE, pos.isInCheck(pos.sideToMove()), true });
+}
+
+void ChessController::recordMove(int fromX, int fromY, int toX, int toY, bool capture)
+{
+    Position pos = ChessAI::toPosition(m_board, m_currentPlayer);
+    Move move = encodeMove(squareOf(fromX, fromY), squareOf(toX, toY));
+    m_history.push_back({ pos.key(), move, pos.isInCheck(pos.sideToMove()), capture });
+
+    // 同一局面第三次出现时裁决：长将、长捉一方判负，其余判和
+    if (m_gameOver || repetitionCount(m_history) < 3) return;
+
+    RepetitionResult result = judgeRepetition(pos, m_history, findRepetition(m_history));
+    QString opponent = (m_currentPlayer == "红") ? "黑" : "红";
+    if (result == RepetitionResult::Win)
+        m_winner = m_currentPlayer;
+    else if (result == RepetitionResult::Loss)
+        m_winner = opponent;
+    else
+        m_winner = "";
+    m_gameOver = true;
+}
+
+bool ChessController::analysisMode() const
+{
+    return m_analysisMode;
+}
+
+QObject* ChessController::analysis() const
+{
+    return m_analysis;
+}
+
+QObject* ChessController::pieces() const
+{
+    return m_pieceModel;
+}
+
+void ChessController::updateAnalysis()
+{
+    if (!m_analysisMode || m_gameOver) {
+        m_analysis->stop();
+        return;
+    }
+    m_analysis->start(ChessAI::toPosition(m_board, m_currentPlayer), m_history);
+}
+
+bool ChessController::explorerMode() const
+{
+    return m_explorerMode;
+}
+
+QObject* ChessController::explorer() const
 {
-    return EndgameInitializer::getEndgameDescription(endgameName);
+    return m_explorer;
 }
 
-int ChessController::getEndgameDifficulty(const QString& endgameName)
+QObject* ChessController::endgames() const
 {
-    return EndgameInitializer::getEndgameDifficulty(endgameName);
+    return m_endgames;
+}
+
+void ChessController::toggleExplorerMode()
+{
+    m_explorerMode = !m_explorerMode;
+    if (m_explorerMode)
+        m_explorer->setDatabase(recordPath(QString()));
+    updateExplorer();
+    emit explorerModeChanged();
+}
+
+void ChessController::updateExplorer()
+{
+    if (m_explorerMode)
+        m_explorer->setPosition(ChessAI::toPosition(m_board, m_currentPlayer));
+}
+
+bool ChessController::playMove(const QString& iccs)
+{
+    Move move = Position::moveFromIccs(iccs.toStdString());
+    if (move == NO_MOVE) return false;
+
+    ChessMan* piece = m_board[squareY(moveFrom(move))][squareX(moveFrom(move))];
+    int pieceIndex = piece ? int(m_pieces.indexOf(piece)) : -1;
+    if (pieceIndex < 0 || !m_legalTargets[moveFrom(move)].test(moveTo(move))) return false;
+
+    handleMove(pieceIndex, squareX(moveTo(move)), squareY(moveTo(move)));
+    return true;
+}
+
+void ChessController::updateAiPlayer()
+{
+    if (!m_isAiMode || m_gameOver) {
+        m_aiPlayer->cancel();
+        return;
+    }
+    Position pos = ChessAI::toPosition(m_board, m_currentPlayer);
+    if (m_currentPlayer == aiColor)
+        m_aiPlayer->requestMove(pos, m_history);
+    else
+        m_aiPlayer->startPondering(pos, m_history);
+}
+
+void ChessController::onAiMoveReady(Move move)
+{
+    if (!m_isAiMode || m_gameOver || m_currentPlayer != aiColor) return;
+
+    ChessMan* selectedPiece = nullptr;
+    int targetX = -1, targetY = -1;
+    if (move != NO_MOVE) {
+        selectedPiece = m_board[squareY(moveFrom(move))][squareX(moveFrom(move))];
+        targetX = squareX(moveTo(move));
+        targetY = squareY(moveTo(move));
+    }
+
+    if (selectedPiece && selectedPiece->color() == aiColor && m_legalTargets[moveFrom(move)].test(moveTo(move))) {
+        int pieceIndex = m_pieces.indexOf(selectedPiece);
+        if (pieceIndex >= 0) {
+            handleMove(pieceIndex, targetX, targetY);
+            return;
+        }
+    }
+
+    // AI认输
+    StateBatch batch(this);
+    m_gameOver = true;
+    m_winner = (aiColor == "红") ? "黑" : "红";
+    m_aiPlayer->cancel();
+}
+
+void ChessController::updateLegalMoves()
+{
+    for (int sq = 0; sq < 90; ++sq) {
+        m_legalTargets[sq].reset();
+        m_pseudoTargets[sq].reset();
+    }
+    m_legalMoveCount = 0;
+
+    if (!m_gameOver) {
+        Position pos = ChessAI::toPosition(m_board, m_currentPlayer);
+        Move moves[MAX_MOVES];
+        int count = pos.generateMoves(moves);
+        for (int i = 0; i < count; ++i)
+            m_pseudoTargets[moveFrom(moves[i])].set(moveTo(moves[i]));
+        m_legalMoveCount = pos.generateLegalMoves(moves);
+        for (int i = 0; i < m_legalMoveCount; ++i)
+            m_legalTargets[moveFrom(moves[i])].set(moveTo(moves[i]));
+    }
+    emit legalMovesChanged();
+}
+
+void ChessController::flashSelfCheckMove()
+{
+    m_selfCheckMove = true;
+    emit selfCheckMoveChanged();
+    QTimer::singleShot(1000, this, [this]() {
+        m_selfCheckMove = false;
+        emit selfCheckMoveChanged();
+    });
+}
+
+QVariantList ChessController::legalTargets(int pieceIndex) const
+{
+    QVariantList targets;
+    if (pieceIndex < 0 || pieceIndex >= m_pieces.size()) return targets;
+
+    ChessMan* piece = qobject_cast<ChessMan*>(m_pieces[pieceIndex]);
+    if (!piece || piece->x() < 0 || piece->y() < 0) return targets;
+
+    const std::bitset<90>& bits = m_legalTargets[squareOf(piece->x(), piece->y())];
+    for (int sq = 0; sq < 90; ++sq) {
+        if (bits.test(sq)) {
+            targets.append(squareX(sq));
+            targets.append(squareY(sq));
+        }
+    }
+    return targets;
+}
+
+bool ChessController::isLegalMove(int fromIndex, int toX, int toY) const
+{
+    if (fromIndex < 0 || fromIndex >= m_pieces.size()) return false;
+    if (toX < 0 || toX >= 9 || toY < 0 || toY >= 10) return false;
+
+    ChessMan* piece = qobject_cast<ChessMan*>(m_pieces[fromIndex]);
+    if (!piece || piece->x() < 0 || piece->y() < 0) return false;
+    return m_legalTargets[squareOf(piece->x(), piece->y())].test(squareOf(toX, toY));
+}
+
+int ChessController::legalMoveCount() const
+{
+    return m_legalMoveCount;
+}
+
+ChessController::StateBatch::StateBatch(ChessController* controller)
+    : m_controller(controller)
+    , m_outermost(controller->m_batchDepth++ == 0)
+{
+    if (!m_outermost) return;
+    m_before = controller->snapshot();
+    controller->m_pieceModel->beginBatch();
+}
+
+ChessController::StateBatch::~StateBatch()
+{
+    --m_controller->m_batchDepth;
+    if (!m_outermost) return;
+    m_controller->m_pieceModel->endBatch();
+    m_controller->emitStateChanges(m_before);
+}
+
+ChessController::StateSnapshot ChessController::snapshot() const
+{
+    return { m_currentPlayer, m_roundNumber, m_gameOver, m_winner, m_isCheck, m_isCheckMate,
+             m_isStalemate, m_checkedPlayer, m_capturedPiecesInfo.size(), m_boardVersion };
+}
+
+void ChessController::emitStateChanges(const StateSnapshot& before)
+{
+    const StateSnapshot after = snapshot();
+    if (after.boardVersion != before.boardVersion)
+        emit chessDataChanged();
+    if (after.currentPlayer != before.currentPlayer)
+        emit currentPlayerChanged();
+    if (after.roundNumber != before.roundNumber)
+        emit roundNumberChanged();
+    if (after.capturedCount != before.capturedCount)
+        emit capturedPiecesChanged();
+    if (after.isCheck != before.isCheck)
+        emit isCheckChanged();
+    if (after.isCheckMate != before.isCheckMate || after.isStalemate != before.isStalemate)
+        emit isCheckMateChanged();
+    if (after.checkedPlayer != before.checkedPlayer)
+        emit checkedPlayerChanged();
+    if (after.winner != before.winner)
+        emit winnerChanged();
+    if (after.gameOver != before.gameOver)
+        emit gameOverChanged();
+}
+
+int8_t ChessController::colorCode(const QString& color)
+{
+    return color == "红" ? 0 : (color == "黑" ? 1 : -1);
+}
+
+QString ChessController::colorName(int8_t code)
+{
+    return code == 0 ? "红" : (code == 1 ? "黑" : "");
+}
+
+void ChessController::undoPly()
+{
+    const JournalEntry& entry = m_journal[--m_journalPly];
+    ChessMan* piece = qobject_cast<ChessMan*>(m_pieces[entry.pieceIndex]);
+    const int fromX = squareX(entry.from), fromY = squareY(entry.from);
+    const int toX = squareX(entry.to), toY = squareY(entry.to);
+
+    m_board[toY][toX] = nullptr;
+    piece->setX(fromX);
+    piece->setY(fromY);
+    m_board[fromY][fromX] = piece;
+
+    // 被吃的棋子从记录中放回原位
+    if (entry.capturedIndex >= 0) {
+        ChessMan* captured = qobject_cast<ChessMan*>(m_pieces[entry.capturedIndex]);
+        captured->setX(toX);
+        captured->setY(toY);
+        m_board[toY][toX] = captured;
+        m_capturedPiecesInfo.removeLast();
+    }
+    ++m_boardVersion;
+
+    m_currentPlayer = piece->color();
+    m_roundNumber = entry.roundNumber;
+    m_isCheck = entry.flags & JournalCheck;
+    m_isCheckMate = entry.flags & JournalCheckMate;
+    m_isStalemate = entry.flags & JournalStalemate;
+    m_gameOver = entry.flags & JournalGameOver;
+    m_checkedPlayer = colorName(entry.checkedPlayer);
+    m_winner = colorName(entry.winner);
+    m_history.pop_back();
+}
+
+void ChessController::redoPly()
+{
+    const JournalEntry& entry = m_journal[m_journalPly];
+    applyMove(entry.pieceIndex, squareX(entry.to), squareY(entry.to));
+}
+
+bool ChessController::undoMove()
+{
+    if (m_journalPly == 0) return false;
+
+    StateBatch batch(this);
+    undoPly();
+    // 人机模式下连同AI的应着一起退回，回到人方走棋
+    if (m_isAiMode && m_currentPlayer == aiColor && m_journalPly > 0)
+        undoPly();
+    afterPositionChanged();
+    return true;
+}
+
+bool ChessController::redoMove()
+{
+    if (m_journalPly >= m_journal.size()) return false;
+
+    StateBatch batch(this);
+    redoPly();
+    if (m_isAiMode && m_currentPlayer == aiColor && m_journalPly < m_journal.size())
+        redoPly();
+    afterPositionChanged();
+    return true;
+}
+
+void ChessController::jumpToPly(int ply)
+{
+    ply = qBound(0, ply, int(m_journal.size()));
+    if (ply == int(m_journalPly)) return;
+
+    StateBatch batch(this);
+    while (int(m_journalPly) > ply)
+        undoPly();
+    while (int(m_journalPly) < ply)
+        redoPly();
+    afterPositionChanged();
+}
+
+int ChessController::ply() const
+{
+    return int(m_journalPly);
+}
+
+int ChessController::plyCount() const
+{
+    return int(m_journal.size());
+}
+
+QString ChessController::recordPath(const QString& path)
+{
+    if (path.isEmpty()) {
+        QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+        QDir().mkpath(dir);
+        return dir + "/games.xdb";
+    }
+    // QML文件对话框给出的是file:// URL
+    if (path.startsWith("file:"))
+        return QUrl(path).toLocalFile();
+    return path;
+}
+
+GameRecord ChessController::currentRecord() const
+{
+    GameRecord game;
+    game.setTag("Event", m_isEndgameMode ? currentEndgame().toStdString()
+                                         : (m_isAiMode ? "人机对局" : "双人对局"));
+    game.setTag("Date", QDateTime::currentDateTime().toString("yyyy.MM.dd").toStdString());
+    if (m_isAiMode) {
+        game.setTag("Red", aiColor == "红" ? "AI" : "玩家");
+        game.setTag("Black", aiColor == "黑" ? "AI" : "玩家");
+    }
+    game.fen = m_startFen;
+
+    // 只保存棋盘上已走的着法，悔棋后未重做的部分不保存
+    for (size_t i = 0; i < m_journalPly; ++i)
+        game.moves.push_back(encodeMove(m_journal[i].from, m_journal[i].to));
+
+    if (m_gameOver) {
+        if (m_winner == "红") game.result = GameResult::RedWin;
+        else if (m_winner == "黑") game.result = GameResult::BlackWin;
+        else game.result = GameResult::Draw;
+    }
+    return game;
+}
+
+bool ChessController::saveGame(const QString& path)
+{
+    const QString file = recordPath(path);
+    const GameRecord game = currentRecord();
+    if (file.endsWith(".xdb")) {
+        if (!GameDatabase::append(file, game)) return false;
+        // 浏览器使用的对局库有了新对局，索引在后台重建
+        if (m_explorerMode && file == recordPath(QString()))
+            m_explorer->refresh();
+        return true;
+    }
+
+    QFile out(file);
+    if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    const std::string text = game.toText(MoveFormat::Iccs);
+    return out.write(text.data(), qint64(text.size())) == qint64(text.size());
+}
+
+bool ChessController::readRecord(const QString& path, int index, GameRecord& game) const
+{
+    const QString file = recordPath(path);
+    if (file.endsWith(".xdb")) {
+        GameDatabase database;
+        if (!database.open(file) || database.count() == 0) return false;
+        if (index < 0) index = int(database.count()) - 1;
+        return database.game(uint32_t(index), game);
+    }
+
+    QFile in(file);
+    if (!in.open(QIODevice::ReadOnly))
+        return false;
+    GameRecordReader reader(&in);
+    GameRecord current;
+    bool found = false;
+    for (int i = 0; reader.next(current); ++i) {
+        if (index < 0 || i == index) {
+            game = std::move(current);
+            found = true;
+            if (index >= 0) break;
+        }
+    }
+    return found;
+}
+
+bool ChessController::loadGame(const QString& path, int index)
+{
+    GameRecord game;
+    if (!readRecord(path, index, game))
+        return false;
+
+    StateBatch batch(this);
+
+    if (m_isEndgameMode) {
+        m_isEndgameMode = false;
+        m_currentEndgameId = "";
+        emit endgameModeChanged();
+        emit currentEndgameChanged();
+    }
+    Position pos = game.startPosition();
+    m_customStart = pos;
+    m_hasCustomStart = pos.key() != Position::startPosition().key();
+    initializeGame();
+
+    // 逐着按合法性回放，对局库中损坏或不合法的着法之后截断
+    for (Move move : game.moves) {
+        if (m_gameOver || !pos.isLegalMove(move)) break;
+        pos.makeMove(move);
+        ChessMan* piece = m_board[squareY(moveFrom(move))][squareX(moveFrom(move))];
+        applyMove(int(m_pieces.indexOf(piece)), squareX(moveTo(move)), squareY(moveTo(move)));
+    }
+    afterPositionChanged();
+    return true;
+}
+
+int ChessController::savedGameCount(const QString& path) const
+{
+    const QString file = recordPath(path);
+    if (file.endsWith(".xdb")) {
+        GameDatabase database;
+        return database.open(file) ? int(database.count()) : 0;
+    }
+
+    QFile in(file);
+    if (!in.open(QIODevice::ReadOnly))
+        return 0;
+    GameRecordReader reader(&in);
+    GameRecord game;
+    int count = 0;
+    while (reader.next(game))
+        ++count;
+    return count;
 }
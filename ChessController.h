@@ -6,10 +6,24 @@
 #include <QString>
 // QDebug removed - no longer needed
 #include <QTimer>
+#include <QThread>
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <memory>
+#include <vector>
 #include "ChessMan.h"
 #include "ChessInitializer.h"
 #include "ChessAi.h"
 #include "EndgameInitializer.h"
+#include "MateSolver.h"
+#include "AnalysisModel.h"
+#include "ExplorerModel.h"
+#include "EndgameBrowserModel.h"
+#include "AiPlayer.h"
+#include "PieceModel.h"
+#include "GameRecord.h"
+#include "GameDatabase.h"
 
 struct CapturePieceInfo {
     QString name;
@@ -29,14 +43,32 @@ class ChessController : public QObject
     Q_PROPERTY(QString winner READ winner NOTIFY winnerChanged)
     Q_PROPERTY(bool isCheck READ isCheck NOTIFY isCheckChanged)
     Q_PROPERTY(bool isCheckMate READ isCheckMate NOTIFY isCheckMateChanged)
+    Q_PROPERTY(bool isStalemate READ isStalemate NOTIFY isCheckMateChanged)
     Q_PROPERTY(QString checkedPlayer READ checkedPlayer NOTIFY checkedPlayerChanged)
     Q_PROPERTY(bool selfCheckMove READ selfCheckMove NOTIFY selfCheckMoveChanged)
     Q_PROPERTY(bool isAiMode READ isAiMode NOTIFY aiModeChanged)
+    Q_PROPERTY(int aiLevel READ aiLevel WRITE setAiLevel NOTIFY aiLevelChanged)
+    Q_PROPERTY(int aiEngine READ aiEngine WRITE setAiEngine NOTIFY aiEngineChanged)
     Q_PROPERTY(bool isEndgameMode READ isEndgameMode NOTIFY endgameModeChanged)
     Q_PROPERTY(QString currentEndgame READ currentEndgame NOTIFY currentEndgameChanged)
+    Q_PROPERTY(QString currentEndgameId READ currentEndgameId NOTIFY currentEndgameChanged)
+    Q_PROPERTY(int mateInMoves READ mateInMoves NOTIFY mateSolutionChanged)
+    Q_PROPERTY(QString mateSolution READ mateSolution NOTIFY mateSolutionChanged)
+    Q_PROPERTY(QVariantList mateHint READ mateHint NOTIFY mateSolutionChanged)
+    Q_PROPERTY(bool solverRunning READ solverRunning NOTIFY solverRunningChanged)
+    Q_PROPERTY(bool analysisMode READ analysisMode NOTIFY analysisModeChanged)
+    Q_PROPERTY(int legalMoveCount READ legalMoveCount NOTIFY legalMovesChanged)
+    Q_PROPERTY(QObject* analysis READ analysis CONSTANT)
+    Q_PROPERTY(bool explorerMode READ explorerMode NOTIFY explorerModeChanged)
+    Q_PROPERTY(QObject* explorer READ explorer CONSTANT)
+    Q_PROPERTY(QObject* endgames READ endgames CONSTANT)
+    Q_PROPERTY(QObject* pieces READ pieces CONSTANT)
+    Q_PROPERTY(int ply READ ply NOTIFY journalChanged)
+    Q_PROPERTY(int plyCount READ plyCount NOTIFY journalChanged)
 
 public:
     explicit ChessController(QObject* parent = nullptr);
+    ~ChessController() override;
 
     void initializeGame();
     QList<QObject*> getRawPieces() const;
@@ -48,31 +80,74 @@ public:
     QString winner() const;
     bool isCheck() const;
     bool isCheckMate() const;
+    bool isStalemate() const;
     QString checkedPlayer() const;
     bool selfCheckMove() const;
     bool isAiMode() const;
+    int aiLevel() const;
+    void setAiLevel(int level);
+    // 0为alpha-beta，1为蒙特卡洛树搜索
+    int aiEngine() const;
+    void setAiEngine(int engine);
     bool isEndgameMode() const;
+    // 当前残局的名称（显示用）与目录编号
     QString currentEndgame() const;
+    QString currentEndgameId() const;
+    int mateInMoves() const;
+    QString mateSolution() const;
+    QVariantList mateHint() const;
+    bool solverRunning() const;
+    bool analysisMode() const;
+    QObject* analysis() const;
+    bool explorerMode() const;
+    QObject* explorer() const;
+    QObject* endgames() const;
+    QObject* pieces() const;
 
     // QML invokable methods
-    Q_INVOKABLE QVariantList getPieces() const;
     Q_INVOKABLE QVariantList capturedPieces() const;
     Q_INVOKABLE void resetGame();
     Q_INVOKABLE void handleMove(int fromIndex, int toX, int toY);
     Q_INVOKABLE void toggleAIMode();
+    Q_INVOKABLE QStringList getAiLevelNames() const;
+    Q_INVOKABLE QStringList getAiEngineNames() const;
+    Q_INVOKABLE void toggleAnalysisMode();
+    // 开局浏览器：列出默认对局库中当前局面之后的着法统计，playMove按ICCS走出其中一着
+    Q_INVOKABLE void toggleExplorerMode();
+    Q_INVOKABLE bool playMove(const QString& iccs);
     Q_INVOKABLE void switchTurn();
-    Q_INVOKABLE void startEndgame(const QString& endgameName);
+
+    // 悔棋/重做：人机模式下一次退回或重走一个回合（双方各一步）
+    Q_INVOKABLE bool undoMove();
+    Q_INVOKABLE bool redoMove();
+    Q_INVOKABLE void jumpToPly(int ply);
+    int ply() const;
+    int plyCount() const;
+
+    // 棋谱保存/载入：.xdb追加到对局库（path为空时用默认对局库），其他扩展名写文本棋谱
+    // index为库或文本文件中的第几局，-1表示最后一局；载入后可用悔棋/重做逐步回看
+    Q_INVOKABLE bool saveGame(const QString& path = QString());
+    Q_INVOKABLE bool loadGame(const QString& path = QString(), int index = -1);
+    Q_INVOKABLE int savedGameCount(const QString& path = QString()) const;
+    // 残局按目录编号指定，名称可能重复
+    Q_INVOKABLE void startEndgame(const QString& endgameId);
     Q_INVOKABLE QStringList getEndgameList();
     Q_INVOKABLE void exitEndgameMode();
-    Q_INVOKABLE QString getEndgameDescription(const QString& endgameName);
-    Q_INVOKABLE int getEndgameDifficulty(const QString& endgameName);
+    Q_INVOKABLE QString getEndgameDescription(const QString& endgameId);
+    Q_INVOKABLE int getEndgameDifficulty(const QString& endgameId);
+    Q_INVOKABLE QString getEndgameFirstPlayer(const QString& endgameId);
+
+    // 当前行棋方的合法着法（每回合生成一次）：目标按 [x0, y0, x1, y1, ...] 返回
+    Q_INVOKABLE QVariantList legalTargets(int pieceIndex) const;
+    Q_INVOKABLE bool isLegalMove(int fromIndex, int toX, int toY) const;
+    int legalMoveCount() const;
     // AI depth and time limit functions removed - not needed for current implementation
 
     // Game logic methods
     ChessMan* getKing(const QString& color) const;
     bool checkForCheck(const QString& color);
     bool checkForCheckMate(const QString& color);
-    bool canMoveResolveCheck(ChessMan* piece, int toX, int toY);
+    bool checkForStalemate(const QString& color);
     bool isKingFacingKing() const;
     void updateCheckStatus();
     void capturePieceAt(int x, int y, ChessMan* capturingPiece);
@@ -89,12 +164,22 @@ signals:
     void checkedPlayerChanged();
     void selfCheckMoveChanged();
     void aiModeChanged();
+    void aiLevelChanged();
+    void aiEngineChanged();
+    void legalMovesChanged();
+    void journalChanged();
     void endgameModeChanged();
     void currentEndgameChanged();
+    void mateSolutionChanged();
+    void solverRunningChanged();
+    void analysisModeChanged();
+    void explorerModeChanged();
 
 private:
     ChessMan* m_board[10][9];
+    PiecePool m_piecePool;          // 棋子归池所有，重新摆子时复用
     QList<QObject*> m_pieces;
+    PieceModel* m_pieceModel;      // QML棋盘的数据源，行号与m_pieces下标一致
     QString m_currentPlayer;
     int m_roundNumber;
     QList<CapturePieceInfo> m_capturedPiecesInfo;
@@ -102,12 +187,119 @@ private:
     QString m_winner;
     bool m_isCheck;
     bool m_isCheckMate;
+    bool m_isStalemate = false;     // 困毙：未被将军但无合法着法，判负
     QString m_checkedPlayer;
     bool m_selfCheckMove;
     bool m_isAiMode = false;
     QString aiColor = "黑";
-    ChessAI ai;
+
+    // AI在工作线程中思考，轮到人方时按预测应着后台思考
+    void updateAiPlayer();
+    void onAiMoveReady(Move move);
+    AiPlayer* m_aiPlayer;
     bool m_isEndgameMode = false;
-    QString m_currentEndgame = "";
+    QString m_currentEndgameId = "";
+
+    // 对局局面记录：用于重复局面、长将与长捉判定
+    void resetHistory();
+    void recordMove(int fromX, int fromY, int toX, int toY, bool capture);
+    std::vector<HistoryEntry> m_history;
+
+    // 着法记录：每步一条紧凑记录（起止格、棋子下标、被吃棋子下标与走子前的状态）
+    // 悔棋只移动已有的棋子对象，被吃的棋子按记录放回，不重新创建
+    enum JournalFlags : uint8_t {
+        JournalCheck = 1,
+        JournalCheckMate = 2,
+        JournalStalemate = 4,
+        JournalGameOver = 8
+    };
+    struct JournalEntry {
+        uint8_t from;
+        uint8_t to;
+        int8_t pieceIndex;
+        int8_t capturedIndex;     // -1表示未吃子
+        uint8_t flags;
+        int8_t checkedPlayer;     // 0红 1黑 -1无
+        int8_t winner;
+        int16_t roundNumber;
+    };
+    static int8_t colorCode(const QString& color);
+    static QString colorName(int8_t code);
+    void applyMove(int pieceIndex, int toX, int toY);
+    void afterPositionChanged();
+    void undoPly();
+    void redoPly();
+    std::vector<JournalEntry> m_journal;
+    size_t m_journalPly = 0;
+
+    // 棋谱：起始局面加着法记录；载入非标准开局的棋谱时按其局面摆子
+    GameRecord currentRecord() const;
+    bool readRecord(const QString& path, int index, GameRecord& game) const;
+    static QString recordPath(const QString& path);
+    QString m_startPlayer = "红";
+    std::string m_startFen;            // 开局时的FEN，标准开局为空
+    bool m_hasCustomStart = false;
+    Position m_customStart;
+
+    // 状态变更批处理：构造时记录快照，析构时只发出真正变化的属性信号
+    // 可嵌套，只有最外层生效；期间棋子模型的行变化也合并为每行一次
+    struct StateSnapshot {
+        QString currentPlayer;
+        int roundNumber;
+        bool gameOver;
+        QString winner;
+        bool isCheck;
+        bool isCheckMate;
+        bool isStalemate;
+        QString checkedPlayer;
+        qsizetype capturedCount;
+        int boardVersion;
+    };
+    class StateBatch {
+    public:
+        explicit StateBatch(ChessController* controller);
+        ~StateBatch();
+    private:
+        ChessController* m_controller;
+        bool m_outermost;
+        StateSnapshot m_before;
+    };
+    StateSnapshot snapshot() const;
+    void emitStateChanges(const StateSnapshot& before);
+    int m_batchDepth = 0;
+    int m_boardVersion = 0;        // 棋子位置每变化一次加一，用于判断chessDataChanged
+
+    // 合法着法缓存：按起点格存目标格位集，handleMove直接查表
+    // 伪合法（符合走法但送将或王对王）的着法单独记录，用于提示"不能送将"
+    void updateLegalMoves();
+    void flashSelfCheckMove();
+    std::array<std::bitset<90>, 90> m_legalTargets;
+    std::array<std::bitset<90>, 90> m_pseudoTargets;
+    int m_legalMoveCount = 0;
+
+    // 分析模式：局面变化后立即重新开始分析
+    void updateAnalysis();
+    AnalysisModel* m_analysis;
+    bool m_analysisMode = false;
+
+    void updateExplorer();
+    ExplorerModel* m_explorer;
+    bool m_explorerMode = false;
+    EndgameBrowserModel* m_endgames;
+
+    // 残局连杀求解：轮到攻方时在后台线程求解，结果按代数过滤过期的求解
+    void updateMateSolver();
+    void stopMateSolver();
+    void onMateSolved(int generation, const MateResult& result);
+
+    static constexpr uint64_t kMateNodeLimit = 20000000;
+    QThread* m_mateThread = nullptr;
+    std::shared_ptr<std::atomic<bool>> m_mateStop;
+    int m_mateGeneration = 0;
+    bool m_solverRunning = false;
+    uint64_t m_mateKey = 0;
+    std::vector<Move> m_mateMoves;
+    int m_mateInMoves = 0;
+    QString m_mateSolution;
 };
 
@@ -2,9 +2,39 @@
 #include <QObject>
 #include <QString>
 #include <QList>
+#include <array>
+#include "Position.h"
 // QDebug removed - no debug output needed
 
+// 每类棋子共用的静态数据，下标为Position的棋子编码（side * 8 + type）
+struct PieceTraits {
+    const char* typeName;      // 名称前缀，如"Rook"
+    const char* icon;          // 图标文件名
+    const char* displayName;   // 棋盘上的字
+    int firstNumber;           // 编号起点：红方从1起，黑方接在标准开局的红方之后
+};
+
+inline constexpr PieceTraits kPieceTraits[16] = {
+    { "", "", "", 0 },
+    { "King", "king_red.png", "帅", 1 },
+    { "Advisor", "advisor_red.png", "仕", 1 },
+    { "Elephant", "elephant_red.png", "相", 1 },
+    { "Horse", "horse_red.png", "马", 1 },
+    { "Rook", "rook_red.png", "车", 1 },
+    { "Cannon", "cannon_red.png", "炮", 1 },
+    { "Soldier", "soldier_red.png", "兵", 1 },
+    { "", "", "", 0 },
+    { "King", "king_black.png", "将", 2 },
+    { "Advisor", "advisor_black.png", "士", 3 },
+    { "Elephant", "elephant_black.png", "象", 3 },
+    { "Horse", "horse_black.png", "马", 3 },
+    { "Rook", "rook_black.png", "车", 3 },
+    { "Cannon", "cannon_black.png", "炮", 3 },
+    { "Soldier", "soldier_black.png", "卒", 6 }
+};
+
 // 默认红下黑上(棋盘)
+// 每枚棋子只保存编码、编号与坐标；名称、颜色、图标取自共享表，颜色与图标的QString进程内各只建一份
 class ChessMan : public QObject
 {
     Q_OBJECT
@@ -13,33 +43,53 @@ class ChessMan : public QObject
     Q_PROPERTY(int x READ x WRITE setX NOTIFY positionChanged)
     Q_PROPERTY(int y READ y WRITE setY NOTIFY positionChanged)
     Q_PROPERTY(QString icon READ icon CONSTANT)
+    Q_PROPERTY(QString displayName READ displayName CONSTANT)
 
 public:
-    ChessMan(QString name, QString color, int x, int y, QString icon, QObject* parent = nullptr)
+    // number为同类同色棋子中的序号（从0起），名称编号为firstNumber + number
+    ChessMan(uint8_t code, int number, int x, int y, QObject* parent = nullptr)
         : QObject(parent)
-        , m_name(name)
-        , m_color(color)
-        , m_x(x)
-        , m_y(y)
-        , m_icon(icon)
+        , m_code(code)
+        , m_number(uint8_t(number))
+        , m_x(int8_t(x))
+        , m_y(int8_t(y))
     {}
 
-    QString name() const { return m_name; }
-    QString color() const { return m_color; }
+    uint8_t code() const { return m_code; }
+    int type() const { return pieceType(m_code); }
+    int side() const { return pieceSide(m_code); }
+    const PieceTraits& traits() const { return kPieceTraits[m_code]; }
+
+    QString name() const {
+        return QString::fromLatin1(traits().typeName) + QString::number(traits().firstNumber + m_number);
+    }
+    const QString& color() const {
+        static const QString colors[2] = { QStringLiteral("红"), QStringLiteral("黑") };
+        return colors[side()];
+    }
     int x() const { return m_x; }
     int y() const { return m_y; }
-    QString icon() const { return m_icon; }
+    const QString& icon() const {
+        static const std::array<QString, 16> icons = [] {
+            std::array<QString, 16> result;
+            for (int code = 0; code < 16; ++code)
+                result[code] = QString::fromLatin1(kPieceTraits[code].icon);
+            return result;
+        }();
+        return icons[m_code];
+    }
+    QString displayName() const { return QString::fromUtf8(traits().displayName); }
 
     void setX(int x) {
         if (m_x != x) {
-            m_x = x;
+            m_x = int8_t(x);
             emit positionChanged();
         }
     }
 
     void setY(int y) {
         if (m_y != y) {
-            m_y = y;
+            m_y = int8_t(y);
             emit positionChanged();
         }
     }
@@ -59,14 +109,14 @@ public:
     bool isSameColorPieceAt(int x, int y, ChessMan* board[10][9]) const {
         if (x < 0 || x >= 9 || y < 0 || y >= 10) return false;
         ChessMan* piece = board[y][x];
-        return piece != nullptr && piece->color() == this->color();
+        return piece != nullptr && piece->side() == side();
     }
     
     //判断目标格是否有敌方棋子
     bool isEnemyPieceAt(int x, int y, ChessMan* board[10][9]) const {
         if (x < 0 || x >= 9 || y < 0 || y >= 10) return false;
         ChessMan* piece = board[y][x];
-        return piece != nullptr && piece->color() != this->color();
+        return piece != nullptr && piece->side() != side();
     }
     
     //能移动（使用棋子数组）
@@ -111,8 +161,7 @@ signals:
     void positionChanged();
 
 protected:
-    QString m_name;
-    QString m_color;
-    int m_x, m_y;
-    QString m_icon;
+    uint8_t m_code;
+    uint8_t m_number;
+    int8_t m_x, m_y;     // 被吃后为-99
 };
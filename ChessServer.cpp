@@ -0,0 +1,221 @@
+#include "ChessServer.h"
+#include "StateCodec.h"
+
+namespace {
+
+// 各难度的搜索上限与延迟上限
+struct ServerLevel {
+    int depth;
+    uint64_t nodes;
+    int deadlineMs;
+};
+
+const ServerLevel kLevels[ChessServer::kLevelCount] = {
+    { 2, 3000, 200 },
+    { 3, 30000, 500 },
+    { 6, 200000, 1000 },
+    { 64, 1000000, 3000 },
+    { 64, 4000000, 8000 },
+};
+
+// 单行命令的长度上限，防止不换行的客户端占满内存
+const qint64 kMaxLineLength = 512;
+
+} // namespace
+
+ChessServer::ChessServer(int engineThreads, QObject* parent)
+    : QObject(parent)
+    , m_engine(engineThreads)
+{
+    // 结果在工作线程中产生，转到事件循环中再改会话
+    m_engine.setResultHandler([this](uint32_t sessionId, uint64_t ticket, const SearchResult& result) {
+        QMetaObject::invokeMethod(this, [this, sessionId, ticket, result]() {
+            onEngineResult(sessionId, ticket, result);
+        }, Qt::QueuedConnection);
+    });
+    connect(&m_server, &QTcpServer::newConnection, this, &ChessServer::onNewConnection);
+}
+
+ChessServer::~ChessServer()
+{
+    m_server.close();
+}
+
+bool ChessServer::listen(quint16 port)
+{
+    return m_server.listen(QHostAddress::LocalHost, port);
+}
+
+void ChessServer::onNewConnection()
+{
+    while (QTcpSocket* socket = m_server.nextPendingConnection()) {
+        socket->setParent(this);
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { onReadyRead(socket); });
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() { onDisconnected(socket); });
+    }
+}
+
+void ChessServer::onReadyRead(QTcpSocket* socket)
+{
+    // 已因超长行断开的连接不再执行后到的数据
+    if (socket->state() != QAbstractSocket::ConnectedState) return;
+
+    // 先在长度上限内找换行再整行读出：超长行的任何片段都不当作命令执行
+    while (true) {
+        const qsizetype newline = socket->peek(kMaxLineLength).indexOf('\n');
+        if (newline < 0) {
+            if (socket->bytesAvailable() >= kMaxLineLength) {
+                socket->readAll();
+                socket->write("error line too long\n");
+                socket->disconnectFromHost();
+            }
+            return;
+        }
+        const QByteArray line = socket->read(newline + 1).trimmed();
+        if (line.isEmpty()) continue;
+        socket->write(handle(socket, line.split(' ')) + '\n');
+    }
+}
+
+void ChessServer::onDisconnected(QTcpSocket* socket)
+{
+    for (uint32_t id : m_socketSessions.value(socket)) {
+        m_engine.cancel(id);
+        m_sessions.close(id);
+        m_owners.remove(id);
+    }
+    m_socketSessions.remove(socket);
+    socket->deleteLater();
+}
+
+GameSession* ChessServer::ownedSession(QTcpSocket* socket, const QByteArray& id)
+{
+    bool ok = false;
+    const uint32_t sessionId = id.toUInt(&ok);
+    if (!ok || m_owners.value(sessionId) != socket) return nullptr;
+    return m_sessions.find(sessionId);
+}
+
+QByteArray ChessServer::stateText(GameSession& session)
+{
+    QByteArray text = QByteArray::fromStdString(session.pos.toFen());
+    if (!session.pos.hasLegalMove())
+        text += session.pos.isInCheck(session.pos.sideToMove()) ? " mate" : " stalemate";
+    return text;
+}
+
+QByteArray ChessServer::handle(QTcpSocket* socket, const QList<QByteArray>& args)
+{
+    const QByteArray& command = args.first();
+
+    if (command == "new") {
+        Position start = Position::startPosition();
+        if (args.size() > 1) {
+            // FEN中含空格（行棋方），按原样拼回
+            const QList<QByteArray> fenParts = args.mid(1);
+            if (!start.fromFen(fenParts.join(' ').toStdString()))
+                return "error bad fen";
+        }
+        GameSession* session = m_sessions.create(start);
+        m_owners.insert(session->id, socket);
+        m_socketSessions[socket].insert(session->id);
+        return "ok " + QByteArray::number(session->id) + ' ' + stateText(*session);
+    }
+
+    if (command == "stats") {
+        return "stats sessions=" + QByteArray::number(qulonglong(m_sessions.count()))
+             + " queued=" + QByteArray::number(qulonglong(m_engine.queued()))
+             + " running=" + QByteArray::number(m_engine.running())
+             + " threads=" + QByteArray::number(m_engine.threadCount())
+             + " memory=" + QByteArray::number(qulonglong(m_sessions.memoryUsage()));
+    }
+
+    if (args.size() < 2)
+        return "error missing session";
+    GameSession* session = ownedSession(socket, args[1]);
+    if (!session)
+        return "error unknown session";
+
+    if (command == "move") {
+        if (args.size() < 3) return "error missing move";
+        if (session->ticket) return "error engine thinking";
+        if (!session->makeMove(Position::moveFromIccs(args[2].toStdString())))
+            return "error illegal move";
+        return "ok " + QByteArray::number(session->id) + ' ' + stateText(*session);
+    }
+
+    if (command == "go") {
+        if (session->ticket) return "error engine thinking";
+        if (!session->pos.hasLegalMove()) return "error game over";
+        const int level = args.size() > 2 ? qBound(0, args[2].toInt(), kLevelCount - 1) : session->level;
+        session->level = level;
+
+        EngineScheduler::Request request;
+        request.session = session->id;
+        request.pos = session->pos;
+        request.history = session->history;
+        request.limits.depth = kLevels[level].depth;
+        request.limits.nodes = kLevels[level].nodes;
+        request.deadlineMs = kLevels[level].deadlineMs;
+        session->ticket = m_engine.submit(std::move(request));
+        return "queued " + QByteArray::number(session->id);
+    }
+
+    if (command == "undo") {
+        if (session->ticket) return "error engine thinking";
+        if (!session->undo()) return "error nothing to undo";
+        return "ok " + QByteArray::number(session->id) + ' ' + stateText(*session);
+    }
+
+    if (command == "fen")
+        return "ok " + QByteArray::number(session->id) + ' ' + stateText(*session);
+
+    if (command == "sync") {
+        // 序号即步数：快照对应当前步数，第n步的增量序号为n
+        bool ok = false;
+        const int sequence = args.size() > 2 ? args[2].toInt(&ok) : -1;
+        if (ok && sequence >= 0 && sequence <= session->ply()) {
+            QByteArray deltas;
+            uint8_t buffer[StateCodec::kDeltaSize];
+            for (int i = sequence + 1; i <= session->ply(); ++i) {
+                const HistoryEntry& entry = session->history[i];
+                StateCodec::encodeDelta(uint32_t(i), entry.move, entry.key, buffer);
+                deltas.append(reinterpret_cast<const char*>(buffer), int(sizeof(buffer)));
+            }
+            return "delta " + QByteArray::number(session->id) + ' ' + deltas.toHex();
+        }
+        uint8_t snapshot[StateCodec::kSnapshotSize];
+        if (!StateCodec::encodeSnapshot(session->pos, uint32_t(session->ply()), uint16_t(session->ply()), snapshot))
+            return "error unsupported material";
+        return "snapshot " + QByteArray::number(session->id) + ' '
+             + QByteArray(reinterpret_cast<const char*>(snapshot), int(sizeof(snapshot))).toHex();
+    }
+
+    if (command == "close") {
+        const uint32_t id = session->id;
+        m_engine.cancel(id);
+        m_sessions.close(id);
+        m_owners.remove(id);
+        m_socketSessions[socket].remove(id);
+        return "ok " + QByteArray::number(id);
+    }
+
+    return "error unknown command";
+}
+
+void ChessServer::onEngineResult(uint32_t sessionId, uint64_t ticket, const SearchResult& result)
+{
+    GameSession* session = m_sessions.find(sessionId);
+    if (!session || session->ticket != ticket) return;
+    session->ticket = 0;
+
+    QTcpSocket* socket = m_owners.value(sessionId);
+    if (!socket) return;
+    if (result.bestMove == NO_MOVE || !session->makeMove(result.bestMove)) {
+        socket->write("bestmove " + QByteArray::number(sessionId) + " none\n");
+        return;
+    }
+    socket->write("bestmove " + QByteArray::number(sessionId) + ' '
+                  + QByteArray::fromStdString(Position::moveToIccs(result.bestMove)) + ' '
+                  + QByteArray::number(result.score) + ' ' + stateText(*session) + '\n');
+}
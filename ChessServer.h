@@ -0,0 +1,50 @@
+#pragma once
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include "EngineScheduler.h"
+#include "GameSession.h"
+
+// 多会话对局服务：本地TCP文本协议，一行一条命令，应答也是一行
+//   new [FEN]             → ok <会话> <FEN>
+//   move <会话> <ICCS>     → ok <会话> <FEN> [mate|stalemate]
+//   go <会话> [难度0~4]    → 立即返回 queued <会话>；算完后推送 bestmove <会话> <ICCS> <分数> <FEN> [mate|stalemate]
+//   undo <会话>            → ok <会话> <FEN>
+//   fen <会话>             → ok <会话> <FEN>
+//   close <会话>           → ok <会话>
+//   sync <会话> [序号]     → 序号不超过当前步数时返回 delta <会话> <其后各步增量的十六进制>，
+//                           否则或省略序号时返回 snapshot <会话> <快照的十六进制>（格式见StateCodec）
+//   stats                  → stats sessions=… queued=… running=… threads=… memory=…
+// 出错时返回 error <原因>。会话属于创建它的连接，连接断开时一并关闭
+class ChessServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    ChessServer(int engineThreads, QObject* parent = nullptr);
+    ~ChessServer() override;
+
+    bool listen(quint16 port);
+    quint16 port() const { return m_server.serverPort(); }
+
+    static constexpr int kLevelCount = 5;
+
+private:
+    void onNewConnection();
+    void onReadyRead(QTcpSocket* socket);
+    void onDisconnected(QTcpSocket* socket);
+    QByteArray handle(QTcpSocket* socket, const QList<QByteArray>& args);
+    void onEngineResult(uint32_t sessionId, uint64_t ticket, const SearchResult& result);
+
+    GameSession* ownedSession(QTcpSocket* socket, const QByteArray& id);
+    // FEN，终局时后接mate或stalemate
+    static QByteArray stateText(GameSession& session);
+
+    QTcpServer m_server;
+    SessionManager m_sessions;
+    EngineScheduler m_engine;
+    QHash<uint32_t, QTcpSocket*> m_owners;
+    QHash<QTcpSocket*, QSet<uint32_t>> m_socketSessions;
+};
@@ -0,0 +1,222 @@
+// 局面同步编解码的模糊测试：用随机对局检查快照往返与增量应用，再把随机字节与变异后的快照、
+// 增量交给decodeSnapshot/applyDelta，检查不崩溃、接受的快照编码唯一（重新编码逐字节相同）、
+// 接受的增量确为合法着法且键值相符。发现问题时输出对应数据并返回1
+//
+// 用法：codecFuzz [-n 1000000] [--games 200] [--seed 1]
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QTextStream>
+#include <QtEndian>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "StateCodec.h"
+
+namespace {
+
+constexpr int kSlots = 32;
+constexpr uint8_t kEmptySlot = 0xFF;
+
+QString toHex(const uint8_t* data, size_t size)
+{
+    return QString::fromLatin1(QByteArray(reinterpret_cast<const char*>(data), qsizetype(size)).toHex());
+}
+
+// 按槽位重算快照中的键值：随机改动棋子槽后键值仍然相符，才能测到键值之前的各项校验
+void fixKey(uint8_t* snapshot)
+{
+    static const uint8_t kSlotTypes[16] = {
+        PT_KING, PT_ADVISOR, PT_ADVISOR, PT_ELEPHANT, PT_ELEPHANT, PT_HORSE, PT_HORSE,
+        PT_ROOK, PT_ROOK, PT_CANNON, PT_CANNON,
+        PT_SOLDIER, PT_SOLDIER, PT_SOLDIER, PT_SOLDIER, PT_SOLDIER
+    };
+    uint64_t key = snapshot[1] == SIDE_BLACK ? Zobrist::sideKey : 0;
+    for (int i = 0; i < kSlots; ++i) {
+        const uint8_t sq = snapshot[8 + i];
+        if (sq < 90)
+            key ^= Zobrist::pieceKeys[makePiece(i / 16, kSlotTypes[i % 16])][sq];
+    }
+    qToLittleEndian<quint64>(key, snapshot + 40);
+}
+
+// 对合法快照做几种结构性变异：改格号、清空或交换槽位、复制槽位、改行棋方，多数情况下随后重算键值
+void mutateSnapshot(std::mt19937& rng, uint8_t* snapshot)
+{
+    const int edits = 1 + int(rng() % 3);
+    for (int e = 0; e < edits; ++e) {
+        uint8_t* squares = snapshot + 8;
+        const int a = int(rng() % kSlots), b = int(rng() % kSlots);
+        switch (rng() % 7) {
+        case 0:
+            squares[a] = uint8_t(rng() % 90);
+            break;
+        case 1:
+            squares[a] = kEmptySlot;
+            break;
+        case 2:
+            std::swap(squares[a], squares[b]);
+            break;
+        case 3:
+            squares[a] = squares[b];
+            break;
+        case 4:
+            snapshot[1] ^= 1;
+            break;
+        case 5:
+            snapshot[rng() % StateCodec::kSnapshotSize] ^= uint8_t(1u << (rng() % 8));
+            break;
+        default:
+            snapshot[rng() % StateCodec::kSnapshotSize] = uint8_t(rng());
+            break;
+        }
+    }
+    if (rng() % 8 != 0)
+        fixKey(snapshot);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("codecFuzz");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Fuzz the snapshot and delta codec with random and mutated inputs");
+    parser.addHelpOption();
+    QCommandLineOption iterationsOption({ "n", "iterations" }, "Number of random and mutated inputs.", "n", "1000000");
+    QCommandLineOption gamesOption("games", "Random games for round trips and mutation seeds.", "n", "200");
+    QCommandLineOption seedOption("seed", "Random seed.", "n", "1");
+    parser.addOptions({ iterationsOption, gamesOption, seedOption });
+    parser.process(app);
+
+    const qint64 iterations = std::max<qint64>(1, parser.value(iterationsOption).toLongLong());
+    const int games = std::max(1, parser.value(gamesOption).toInt());
+    std::mt19937 rng(parser.value(seedOption).toUInt());
+    QTextStream out(stdout);
+
+    // 随机对局：每步快照往返，发送方与接收方按增量同步
+    std::vector<Position> positions;
+    qint64 roundTrips = 0, deltas = 0;
+    for (int g = 0; g < games; ++g) {
+        Position sender = Position::startPosition(), receiver = sender;
+        uint32_t sequence = 0;
+        for (int ply = 0; ply < 200; ++ply) {
+            uint8_t snapshot[StateCodec::kSnapshotSize];
+            if (!StateCodec::encodeSnapshot(sender, sequence, uint16_t(ply), snapshot)) {
+                out << "encode failed: " << QString::fromStdString(sender.toFen()) << Qt::endl;
+                return 1;
+            }
+            Position decoded;
+            uint32_t decodedSequence = 0;
+            uint16_t decodedPly = 0;
+            if (!StateCodec::decodeSnapshot(snapshot, sizeof(snapshot), decoded, decodedSequence, decodedPly)
+                || decoded.key() != sender.key() || decoded.toFen() != sender.toFen()
+                || decodedSequence != sequence || decodedPly != ply) {
+                out << "round trip failed: " << toHex(snapshot, sizeof(snapshot)) << Qt::endl;
+                return 1;
+            }
+            ++roundTrips;
+            positions.push_back(sender);
+
+            Move moves[MAX_MOVES];
+            const int count = sender.generateLegalMoves(moves);
+            if (count == 0) break;
+            const Move move = moves[rng() % count];
+            sender.makeMove(move);
+
+            uint8_t delta[StateCodec::kDeltaSize];
+            StateCodec::encodeDelta(sequence + 2, move, sender.key(), delta);
+            uint32_t skipped = sequence;
+            Position untouched = receiver;
+            if (StateCodec::applyDelta(delta, sizeof(delta), untouched, skipped) != StateCodec::DeltaStatus::Gap) {
+                out << "gap not detected: " << toHex(delta, sizeof(delta)) << Qt::endl;
+                return 1;
+            }
+            StateCodec::encodeDelta(sequence + 1, move, sender.key(), delta);
+            if (StateCodec::applyDelta(delta, sizeof(delta), receiver, sequence) != StateCodec::DeltaStatus::Applied
+                || receiver.key() != sender.key()
+                || StateCodec::applyDelta(delta, sizeof(delta), receiver, sequence) != StateCodec::DeltaStatus::Duplicate) {
+                out << "delta failed: " << toHex(delta, sizeof(delta)) << Qt::endl;
+                return 1;
+            }
+            ++deltas;
+        }
+    }
+
+    qint64 acceptedSnapshots = 0, acceptedDeltas = 0;
+    for (qint64 i = 0; i < iterations; ++i) {
+        const Position& base = positions[rng() % positions.size()];
+
+        // 快照：一半随机字节，一半由随机局面变异而来；长度也随机，不足时应拒绝
+        uint8_t snapshot[StateCodec::kSnapshotSize];
+        if (i & 1) {
+            StateCodec::encodeSnapshot(base, uint32_t(rng()), uint16_t(rng()), snapshot);
+            mutateSnapshot(rng, snapshot);
+        } else {
+            for (uint8_t& byte : snapshot)
+                byte = uint8_t(rng());
+        }
+        const size_t size = rng() % 8 == 0 ? rng() % StateCodec::kSnapshotSize : StateCodec::kSnapshotSize;
+        Position decoded;
+        uint32_t sequence = 0;
+        uint16_t ply = 0;
+        if (StateCodec::decodeSnapshot(snapshot, size, decoded, sequence, ply)) {
+            ++acceptedSnapshots;
+            uint8_t encoded[StateCodec::kSnapshotSize];
+            if (!StateCodec::encodeSnapshot(decoded, sequence, ply, encoded)
+                || std::memcmp(encoded, snapshot, sizeof(encoded)) != 0) {
+                out << "snapshot not canonical: " << toHex(snapshot, sizeof(snapshot)) << Qt::endl;
+                return 1;
+            }
+            Move moves[MAX_MOVES];
+            decoded.generateLegalMoves(moves);
+        }
+
+        // 增量：序号多数恰好加一，着法多数取自本局面的伪合法着法，以测到着法与键值校验
+        uint8_t delta[StateCodec::kDeltaSize];
+        for (uint8_t& byte : delta)
+            byte = uint8_t(rng());
+        const uint32_t current = uint32_t(rng() % 1000);
+        if (rng() % 4 != 0)
+            qToLittleEndian<quint32>(current + 1, delta);
+        Move pseudo[MAX_MOVES];
+        const int pseudoCount = base.generateMoves(pseudo);
+        if (pseudoCount > 0 && rng() % 2 == 0) {
+            const Move move = pseudo[rng() % pseudoCount];
+            qToLittleEndian<quint16>(move, delta + 4);
+            Position after = base;
+            if (rng() % 2 == 0 && after.isLegalMove(move)) {
+                after.makeMove(move);
+                qToLittleEndian<quint16>(quint16(after.key()), delta + 6);
+            }
+        }
+        Position receiver = base;
+        uint32_t receiverSequence = current;
+        const Move move = qFromLittleEndian<quint16>(delta + 4);
+        const size_t deltaSize = rng() % 8 == 0 ? rng() % StateCodec::kDeltaSize : StateCodec::kDeltaSize;
+        if (StateCodec::applyDelta(delta, deltaSize, receiver, receiverSequence) == StateCodec::DeltaStatus::Applied) {
+            ++acceptedDeltas;
+            Position expected = base;
+            bool valid = expected.isLegalMove(move);
+            if (valid) {
+                expected.makeMove(move);
+                valid = expected.key() == receiver.key() && quint16(receiver.key()) == qFromLittleEndian<quint16>(delta + 6)
+                    && receiverSequence == current + 1;
+            }
+            if (!valid) {
+                out << "bad delta accepted: " << toHex(delta, sizeof(delta)) << " on "
+                    << QString::fromStdString(base.toFen()) << Qt::endl;
+                return 1;
+            }
+        } else if (receiver.key() != base.key() || receiverSequence != current) {
+            out << "rejected delta changed the position: " << toHex(delta, sizeof(delta)) << Qt::endl;
+            return 1;
+        }
+    }
+
+    out << roundTrips << " round trips, " << deltas << " deltas, " << iterations << " fuzz inputs ("
+        << acceptedSnapshots << " snapshots and " << acceptedDeltas << " deltas accepted)" << Qt::endl;
+    return 0;
+}
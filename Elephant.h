@@ -14,11 +14,11 @@ public:
         // 必须走田字格
         if (abs(dx) == 2 && abs(dy) == 2) {
             // 红方不能过河
-            if ((color() == "红" || color() == "red") && targetY <= 4)
+            if (side() == SIDE_RED && targetY <= 4)
                 return false;
 
             // 黑方不能过河
-            if ((color() == "黑" || color() == "black") && targetY >= 5)
+            if (side() == SIDE_BLACK && targetY >= 5)
                 return false;
 
             // 象眼是否被堵
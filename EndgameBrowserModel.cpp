@@ -0,0 +1,207 @@
+#include "EndgameBrowserModel.h"
+#include <QDir>
+#include <QSettings>
+#include <QStandardPaths>
+
+namespace {
+
+const int kPageSize = 50;
+const char kSolvedKey[] = "endgames/solved";
+
+// 完成记录与其他用户数据一起放在应用数据目录
+QString settingsPath()
+{
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(dir);
+    return dir + "/endgames.ini";
+}
+
+} // namespace
+
+EndgameBrowserModel::EndgameBrowserModel(QObject* parent)
+    : QAbstractListModel(parent)
+    , m_catalog(EndgameCatalog::defaultCatalog())
+{
+    m_searchText.reserve(m_catalog.count());
+    for (const EndgameEntry& entry : m_catalog.entries())
+        m_searchText.push_back((entry.id + '\n' + entry.name + '\n' + entry.description).toLower());
+
+    for (const QString& id : QSettings(settingsPath(), QSettings::IniFormat).value(kSolvedKey).toStringList())
+        m_solved.insert(id);
+
+    refilter(false);
+}
+
+int EndgameBrowserModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_loaded;
+}
+
+QVariant EndgameBrowserModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= m_loaded)
+        return QVariant();
+
+    const EndgameEntry& entry = m_catalog.at(m_matches[index.row()]);
+    switch (role) {
+    case IdRole:
+        return entry.id;
+    case NameRole:
+        return entry.name;
+    case DescriptionRole:
+        return entry.description;
+    case DifficultyRole:
+        return entry.difficulty;
+    case SideRole:
+        return entry.side == SIDE_RED ? QString("红") : QString("黑");
+    case MaterialRole:
+        return entry.material;
+    case SolvedRole:
+        return m_solved.contains(entry.id);
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int, QByteArray> EndgameBrowserModel::roleNames() const
+{
+    return {
+        { IdRole, "endgameId" },
+        { NameRole, "name" },
+        { DescriptionRole, "description" },
+        { DifficultyRole, "difficulty" },
+        { SideRole, "side" },
+        { MaterialRole, "material" },
+        { SolvedRole, "solved" }
+    };
+}
+
+bool EndgameBrowserModel::canFetchMore(const QModelIndex& parent) const
+{
+    return !parent.isValid() && m_loaded < int(m_matches.size());
+}
+
+void EndgameBrowserModel::fetchMore(const QModelIndex& parent)
+{
+    if (parent.isValid()) return;
+    const int count = qMin(kPageSize, int(m_matches.size()) - m_loaded);
+    if (count <= 0) return;
+    beginInsertRows(QModelIndex(), m_loaded, m_loaded + count - 1);
+    m_loaded += count;
+    endInsertRows();
+}
+
+void EndgameBrowserModel::setFilterText(const QString& text)
+{
+    if (text == m_filterText) return;
+    const QString needle = text.trimmed().toLower();
+    const bool narrowing = needle.startsWith(m_needle);
+    m_filterText = text;
+    m_needle = needle;
+    refilter(narrowing);
+    emit filterChanged();
+}
+
+void EndgameBrowserModel::setDifficulty(int difficulty)
+{
+    if (difficulty == m_difficulty) return;
+    const bool narrowing = m_difficulty == 0;
+    m_difficulty = difficulty;
+    refilter(narrowing);
+    emit filterChanged();
+}
+
+void EndgameBrowserModel::setSide(int side)
+{
+    if (side == m_side) return;
+    const bool narrowing = m_side < 0;
+    m_side = side;
+    refilter(narrowing);
+    emit filterChanged();
+}
+
+void EndgameBrowserModel::setMaterial(const QString& material)
+{
+    if (material == m_material) return;
+    const bool narrowing = material.startsWith(m_material);
+    m_material = material;
+    refilter(narrowing);
+    emit filterChanged();
+}
+
+void EndgameBrowserModel::setSolvedFilter(int filter)
+{
+    if (filter == m_solvedFilter) return;
+    const bool narrowing = m_solvedFilter == AllEndgames;
+    m_solvedFilter = filter;
+    refilter(narrowing);
+    emit filterChanged();
+}
+
+bool EndgameBrowserModel::matches(int index) const
+{
+    const EndgameEntry& entry = m_catalog.at(index);
+    if (m_difficulty > 0 && entry.difficulty != m_difficulty) return false;
+    if (m_side >= 0 && entry.side != m_side) return false;
+    if (!m_material.isEmpty() && !entry.material.startsWith(m_material)) return false;
+    if (m_solvedFilter != AllEndgames
+        && m_solved.contains(entry.id) != (m_solvedFilter == SolvedOnly))
+        return false;
+    return m_needle.isEmpty() || m_searchText[index].contains(m_needle);
+}
+
+void EndgameBrowserModel::refilter(bool narrowing)
+{
+    beginResetModel();
+    if (narrowing) {
+        // 条件只会变严：上次的结果是这次结果的超集
+        std::vector<int> kept;
+        for (int index : m_matches)
+            if (matches(index))
+                kept.push_back(index);
+        m_matches.swap(kept);
+    } else {
+        m_matches.clear();
+        for (int index = 0; index < m_catalog.count(); ++index)
+            if (matches(index))
+                m_matches.push_back(index);
+    }
+    m_loaded = qMin(kPageSize, int(m_matches.size()));
+    endResetModel();
+    emit resultsChanged();
+}
+
+bool EndgameBrowserModel::isSolved(const QString& id) const
+{
+    return m_solved.contains(id);
+}
+
+void EndgameBrowserModel::setSolved(const QString& id, bool solved)
+{
+    const EndgameEntry* entry = m_catalog.findId(id);
+    if (!entry || m_solved.contains(entry->id) == solved) return;
+    if (solved)
+        m_solved.insert(entry->id);
+    else
+        m_solved.remove(entry->id);
+    saveSolved();
+
+    if (m_solvedFilter != AllEndgames) {
+        refilter(false);
+        return;
+    }
+    for (int row = 0; row < m_loaded; ++row) {
+        if (&m_catalog.at(m_matches[row]) == entry) {
+            const QModelIndex changed = index(row);
+            emit dataChanged(changed, changed, { SolvedRole });
+            break;
+        }
+    }
+}
+
+void EndgameBrowserModel::saveSolved() const
+{
+    QStringList ids(m_solved.begin(), m_solved.end());
+    ids.sort();
+    QSettings(settingsPath(), QSettings::IniFormat).setValue(kSolvedKey, ids);
+}
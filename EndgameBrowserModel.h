@@ -0,0 +1,86 @@
+#pragma once
+#include <QAbstractListModel>
+#include <QSet>
+#include <QString>
+#include <vector>
+#include "EndgameCatalog.h"
+
+// 残局浏览器：在EndgameCatalog上按关键字、难度、先手方、子力和完成状态过滤
+// 每个条目的小写检索文本在构造时建好；关键字只是在上次基础上追加字符时，只在上次结果中再筛
+// 结果按页通过fetchMore交给视图，上万条的目录也只创建可见的委托
+class EndgameBrowserModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(QString filterText READ filterText WRITE setFilterText NOTIFY filterChanged)
+    Q_PROPERTY(int difficulty READ difficulty WRITE setDifficulty NOTIFY filterChanged)
+    Q_PROPERTY(int side READ side WRITE setSide NOTIFY filterChanged)
+    Q_PROPERTY(QString material READ material WRITE setMaterial NOTIFY filterChanged)
+    Q_PROPERTY(int solvedFilter READ solvedFilter WRITE setSolvedFilter NOTIFY filterChanged)
+    Q_PROPERTY(int matchCount READ matchCount NOTIFY resultsChanged)
+    Q_PROPERTY(int totalCount READ totalCount CONSTANT)
+
+public:
+    enum Roles {
+        IdRole = Qt::UserRole + 1,
+        NameRole,
+        DescriptionRole,
+        DifficultyRole,
+        SideRole,                      // "红"/"黑"
+        MaterialRole,
+        SolvedRole
+    };
+
+    enum SolvedFilter { AllEndgames, SolvedOnly, UnsolvedOnly };
+
+    explicit EndgameBrowserModel(QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role) const override;
+    QHash<int, QByteArray> roleNames() const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+    QString filterText() const { return m_filterText; }
+    void setFilterText(const QString& text);
+    // 0表示不限
+    int difficulty() const { return m_difficulty; }
+    void setDifficulty(int difficulty);
+    // -1表示不限，否则为SIDE_RED/SIDE_BLACK
+    int side() const { return m_side; }
+    void setSide(int side);
+    // 子力签名前缀，如"KRRv"只列出红方为将双车的残局
+    QString material() const { return m_material; }
+    void setMaterial(const QString& material);
+    int solvedFilter() const { return m_solvedFilter; }
+    void setSolvedFilter(int filter);
+
+    int matchCount() const { return int(m_matches.size()); }
+    int totalCount() const { return m_catalog.count(); }
+
+    // 完成状态按条目编号保存在应用数据目录的endgames.ini中
+    Q_INVOKABLE bool isSolved(const QString& id) const;
+    Q_INVOKABLE void setSolved(const QString& id, bool solved);
+
+signals:
+    void filterChanged();
+    void resultsChanged();
+
+private:
+    bool matches(int index) const;
+    void refilter(bool narrowing);
+    void saveSolved() const;
+
+    const EndgameCatalog& m_catalog;
+    std::vector<QString> m_searchText;     // 与目录同序：编号、名称、说明的小写拼接
+    QSet<QString> m_solved;
+
+    QString m_filterText;
+    QString m_needle;                      // 小写后的关键字
+    int m_difficulty = 0;
+    int m_side = -1;
+    QString m_material;
+    int m_solvedFilter = AllEndgames;
+
+    std::vector<int> m_matches;            // 目录下标
+    int m_loaded = 0;                      // 已交给视图的行数
+};
@@ -0,0 +1,134 @@
+#include "EndgameCatalog.h"
+#include <QCoreApplication>
+#include <QFile>
+#include <QStandardPaths>
+
+Position EndgameEntry::position() const
+{
+    Position pos;
+    if (!pos.fromFen(fen.toStdString()))
+        pos = Position();
+    return pos;
+}
+
+bool EndgameCatalog::load(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return false;
+
+    // 整个文件一次读入后按行切分，几千局的目录也只需一次系统调用
+    const QString text = QString::fromUtf8(file.readAll());
+    for (const QString& line : text.split('\n', Qt::SkipEmptyParts)) {
+        EndgameEntry entry;
+        if (!parseLine(line, entry)) continue;
+
+        int index = m_byId.value(entry.id, -1);
+        if (index >= 0) {
+            m_byName.remove(m_entries[index].name);
+            m_byName.insert(entry.name, index);
+            m_names[index] = entry.name;
+            m_entries[index] = std::move(entry);
+        } else {
+            index = int(m_entries.size());
+            m_byId.insert(entry.id, index);
+            m_byName.insert(entry.name, index);
+            m_names.append(entry.name);
+            m_entries.append(std::move(entry));
+        }
+    }
+    return true;
+}
+
+void EndgameCatalog::clear()
+{
+    m_entries.clear();
+    m_names.clear();
+    m_byName.clear();
+    m_byId.clear();
+}
+
+bool EndgameCatalog::parseLine(const QString& line, EndgameEntry& entry) const
+{
+    const QString trimmed = line.trimmed();
+    if (trimmed.isEmpty() || trimmed.startsWith('#'))
+        return false;
+
+    const QStringList fields = trimmed.split('\t');
+    if (fields.size() < 4)
+        return false;
+
+    entry.id = fields[0].trimmed();
+    entry.name = fields[1].trimmed();
+    entry.difficulty = qBound(1, fields[2].trimmed().toInt(), 5);
+    entry.fen = fields[3].trimmed();
+    entry.description = fields.size() > 4 ? fields[4].trimmed() : QString();
+    entry.solution = fields.size() > 5 ? fields[5].trimmed() : QString();
+    if (entry.id.isEmpty() || entry.name.isEmpty() || entry.fen.isEmpty())
+        return false;
+
+    // 只看FEN的行棋方字段，完整解析留到摆子时
+    const int space = entry.fen.indexOf(' ');
+    entry.side = (space >= 0 && entry.fen.mid(space + 1, 1) == "b") ? SIDE_BLACK : SIDE_RED;
+    entry.material = materialSignature(entry.fen);
+    return true;
+}
+
+const EndgameEntry* EndgameCatalog::find(const QString& name) const
+{
+    const int index = m_byName.value(name, -1);
+    return index < 0 ? nullptr : &m_entries[index];
+}
+
+const EndgameEntry* EndgameCatalog::findId(const QString& id) const
+{
+    const int index = m_byId.value(id, -1);
+    return index < 0 ? nullptr : &m_entries[index];
+}
+
+QString EndgameCatalog::formatEntry(const EndgameEntry& entry)
+{
+    // 字段中不能出现制表符和换行
+    auto clean = [](QString field) {
+        return field.replace("\t", " ").replace("\n", " ");
+    };
+    QString line = clean(entry.id) + '\t' + clean(entry.name) + '\t' + QString::number(entry.difficulty)
+                 + '\t' + clean(entry.fen) + '\t' + clean(entry.description);
+    if (!entry.solution.isEmpty())
+        line += '\t' + clean(entry.solution);
+    return line;
+}
+
+QString EndgameCatalog::materialSignature(const QString& fen)
+{
+    // 按将士象马车炮兵的顺序统计双方子力，红方大写在前，黑方小写在后
+    static const char order[] = "KABNRCP";
+    int counts[2][7] = {};
+    for (char ch : fen.toStdString()) {
+        if (ch == ' ') break;
+        for (int i = 0; i < 7; ++i) {
+            if (ch == order[i]) ++counts[0][i];
+            else if (ch == order[i] + ('a' - 'A')) ++counts[1][i];
+        }
+    }
+
+    std::string signature;
+    for (int i = 0; i < 7; ++i)
+        signature.append(counts[0][i], order[i]);
+    signature += 'v';
+    for (int i = 0; i < 7; ++i)
+        signature.append(counts[1][i], char(order[i] + ('a' - 'A')));
+    return QString::fromStdString(signature);
+}
+
+const EndgameCatalog& EndgameCatalog::defaultCatalog()
+{
+    static const EndgameCatalog catalog = [] {
+        EndgameCatalog c;
+        c.load(":/endgames.tsv");
+        c.load(QCoreApplication::applicationDirPath() + "/endgames.tsv");
+        c.load(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/endgames.tsv");
+        return c;
+    }();
+    return catalog;
+}
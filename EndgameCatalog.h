@@ -0,0 +1,58 @@
+#pragma once
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include "Position.h"
+
+// 残局目录条目：只保存FEN文本，摆子时才解析成局面
+struct EndgameEntry {
+    QString id;
+    QString name;
+    int difficulty = 1;        // 1~5
+    int side = SIDE_RED;       // 先手方，取自FEN
+    QString fen;
+    QString description;
+    QString solution;          // 解着（ICCS），可选；不在列表中显示，也不参与搜索
+    QString material;          // 子力签名，如"KRRCPPPvkbpppp"
+
+    Position position() const;
+};
+
+// 残局目录：文本文件，每行一局，制表符分隔，#开头为注释
+//   编号  名称  难度  FEN  说明  [解着]
+// 首次使用时依次读入内置目录(:/endgames.tsv)、程序目录与应用数据目录下的endgames.tsv，
+// 编号相同的条目以后读入的为准；之后按名称、编号查找均为哈希表查询
+class EndgameCatalog
+{
+public:
+    EndgameCatalog() = default;
+
+    // 追加一个目录文件，无法读取时返回false
+    bool load(const QString& path);
+    void clear();
+
+    int count() const { return int(m_entries.size()); }
+    const EndgameEntry& at(int index) const { return m_entries[index]; }
+    const QList<EndgameEntry>& entries() const { return m_entries; }
+    const QStringList& names() const { return m_names; }
+
+    // 未找到返回nullptr
+    const EndgameEntry* find(const QString& name) const;
+    const EndgameEntry* findId(const QString& id) const;
+
+    // 按目录格式写出一行（不含换行），供生成目录的工具使用
+    static QString formatEntry(const EndgameEntry& entry);
+    static QString materialSignature(const QString& fen);
+
+    // 进程内共享的目录，首次使用时读入
+    static const EndgameCatalog& defaultCatalog();
+
+private:
+    bool parseLine(const QString& line, EndgameEntry& entry) const;
+
+    QList<EndgameEntry> m_entries;
+    QStringList m_names;
+    QHash<QString, int> m_byName;
+    QHash<QString, int> m_byId;
+};
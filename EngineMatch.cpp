@@ -0,0 +1,185 @@
+// 引擎对比工具：alpha-beta（Searcher）与蒙特卡洛树搜索（MctsSearcher）自对弈
+//
+// 两边每步的CPU时间相同：蒙特卡洛一方用N个线程时每步的墙钟时间为总时间的1/N，
+// 比较的是单位CPU秒的棋力。每个开局（双方随机走几步）红黑各下一局，超过步数上限判和，
+// 重复局面按长将/长捉规则裁决。对局依次进行，避免两边争抢CPU
+//
+// 用法：engineMatch [-g 20] [--move-time 200] [--mcts-threads 1] [--random-plies 4] [--max-plies 300]
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QTextStream>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "Mcts.h"
+#include "Search.h"
+
+namespace {
+
+enum class GameResult {
+    RedWin,
+    BlackWin,
+    Draw
+};
+
+struct EngineStats {
+    uint64_t nodes = 0;
+    int moves = 0;
+};
+
+struct MatchOptions {
+    int moveTimeMs = 200;
+    int mctsThreads = 1;
+    int maxPlies = 300;
+};
+
+class Match
+{
+public:
+    explicit Match(const MatchOptions& options)
+        : m_options(options), m_searcher(20), m_mcts(options.mctsThreads)
+    {}
+
+    // opening为双方开局的随机着法，mctsSide为蒙特卡洛一方
+    GameResult play(const std::vector<Move>& opening, int mctsSide)
+    {
+        Position pos = Position::startPosition();
+        std::vector<HistoryEntry> history{ { pos.key(), NO_MOVE, false, true } };
+        for (Move move : opening)
+            push(pos, history, move);
+
+        m_searcher.clearHash();
+        m_mcts.clearTree();
+        while (int(history.size()) <= m_options.maxPlies) {
+            if (!pos.hasLegalMove())
+                return pos.sideToMove() == SIDE_RED ? GameResult::BlackWin : GameResult::RedWin;
+
+            const int cycleStart = findRepetition(history);
+            if (cycleStart >= 0 && repetitionCount(history) >= 3) {
+                const RepetitionResult verdict = judgeRepetition(pos, history, cycleStart);
+                if (verdict == RepetitionResult::Draw) return GameResult::Draw;
+                const bool redWins = (verdict == RepetitionResult::Win) == (pos.sideToMove() == SIDE_RED);
+                return redWins ? GameResult::RedWin : GameResult::BlackWin;
+            }
+
+            SearchLimits limits;
+            SearchResult result;
+            if (pos.sideToMove() == mctsSide) {
+                limits.timeMs = std::max(1, m_options.moveTimeMs / m_options.mctsThreads);
+                result = m_mcts.search(pos, history, limits);
+                m_mctsStats.nodes += result.nodes;
+                ++m_mctsStats.moves;
+            } else {
+                limits.timeMs = m_options.moveTimeMs;
+                result = m_searcher.search(pos, history, limits);
+                m_searcherStats.nodes += result.nodes;
+                ++m_searcherStats.moves;
+            }
+            if (result.bestMove == NO_MOVE || !pos.isLegalMove(result.bestMove))
+                return pos.sideToMove() == SIDE_RED ? GameResult::BlackWin : GameResult::RedWin;
+            push(pos, history, result.bestMove);
+        }
+        return GameResult::Draw;
+    }
+
+    const EngineStats& searcherStats() const { return m_searcherStats; }
+    const EngineStats& mctsStats() const { return m_mctsStats; }
+
+private:
+    static void push(Position& pos, std::vector<HistoryEntry>& history, Move move)
+    {
+        const uint8_t captured = pos.makeMove(move);
+        history.push_back({ pos.key(), move, pos.isInCheck(pos.sideToMove()), captured != 0 });
+    }
+
+    MatchOptions m_options;
+    Searcher m_searcher;
+    MctsSearcher m_mcts;
+    EngineStats m_searcherStats;
+    EngineStats m_mctsStats;
+};
+
+std::vector<Move> randomOpening(std::mt19937& rng, int plies)
+{
+    Position pos = Position::startPosition();
+    std::vector<Move> opening;
+    for (int i = 0; i < plies; ++i) {
+        Move moves[MAX_MOVES];
+        const int count = pos.generateLegalMoves(moves);
+        if (count == 0) break;
+        const Move move = moves[rng() % count];
+        pos.makeMove(move);
+        opening.push_back(move);
+    }
+    return opening;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("engineMatch");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Play alpha-beta against Monte Carlo tree search at equal CPU time per move");
+    parser.addHelpOption();
+    QCommandLineOption gamesOption({ "g", "games" }, "Number of games (rounded up to pairs).", "n", "20");
+    QCommandLineOption moveTimeOption("move-time", "CPU milliseconds per move for each engine.", "ms", "200");
+    QCommandLineOption threadsOption("mcts-threads", "Search threads for the Monte Carlo engine.", "n", "1");
+    QCommandLineOption randomPliesOption("random-plies", "Random opening plies before the engines take over.", "n", "4");
+    QCommandLineOption maxPliesOption("max-plies", "Adjudicate a draw after this many plies.", "n", "300");
+    QCommandLineOption seedOption("seed", "Random seed for the openings.", "n", "1");
+    parser.addOptions({ gamesOption, moveTimeOption, threadsOption, randomPliesOption, maxPliesOption, seedOption });
+    parser.process(app);
+
+    MatchOptions options;
+    options.moveTimeMs = std::max(1, parser.value(moveTimeOption).toInt());
+    options.mctsThreads = std::max(1, parser.value(threadsOption).toInt());
+    options.maxPlies = parser.value(maxPliesOption).toInt();
+    const int pairs = (std::max(1, parser.value(gamesOption).toInt()) + 1) / 2;
+    const int randomPlies = parser.value(randomPliesOption).toInt();
+    std::mt19937 rng(parser.value(seedOption).toUInt());
+
+    QTextStream out(stdout);
+    Match match(options);
+    int wins = 0, draws = 0, losses = 0;    // 以蒙特卡洛一方计
+    for (int i = 0; i < pairs; ++i) {
+        const std::vector<Move> opening = randomOpening(rng, randomPlies);
+        for (int mctsSide : { SIDE_RED, SIDE_BLACK }) {
+            const GameResult result = match.play(opening, mctsSide);
+            const char* outcome;
+            if (result == GameResult::Draw) {
+                ++draws;
+                outcome = "draw";
+            } else if ((result == GameResult::RedWin) == (mctsSide == SIDE_RED)) {
+                ++wins;
+                outcome = "mcts wins";
+            } else {
+                ++losses;
+                outcome = "alpha-beta wins";
+            }
+            out << "game " << (2 * i + (mctsSide == SIDE_RED ? 1 : 2)) << ": mcts plays "
+                << (mctsSide == SIDE_RED ? "red" : "black") << ", " << outcome << Qt::endl;
+        }
+    }
+
+    const int games = wins + draws + losses;
+    const double score = (wins + 0.5 * draws) / games;
+    out << "mcts +" << wins << " =" << draws << " -" << losses
+        << QString(" (%1%)").arg(score * 100, 0, 'f', 1);
+    if (score > 0 && score < 1)
+        out << QString(", elo %1").arg(-400 * std::log10(1 / score - 1), 0, 'f', 0);
+    out << Qt::endl;
+
+    // 每CPU秒的搜索量：alpha-beta为节点数，蒙特卡洛为随机走子局数
+    const double cpuSeconds = options.moveTimeMs / 1000.0;
+    const EngineStats& ab = match.searcherStats();
+    const EngineStats& mc = match.mctsStats();
+    if (ab.moves && mc.moves) {
+        out << "alpha-beta " << qulonglong(ab.nodes / ab.moves / cpuSeconds) << " nodes per cpu-second, "
+            << "mcts " << qulonglong(mc.nodes / mc.moves / cpuSeconds) << " playouts per cpu-second" << Qt::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,127 @@
+#include "EngineScheduler.h"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+int64_t nowMs()
+{
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// 过期请求的最短时限：只求尽快给出一着合法应着
+const int kMinimumTimeMs = 5;
+
+} // namespace
+
+EngineScheduler::EngineScheduler(int threadCount, int hashBits)
+{
+    for (int i = 0; i < std::max(1, threadCount); ++i) {
+        auto worker = std::make_unique<Worker>();
+        worker->searcher = std::make_unique<Searcher>(hashBits);
+        m_workers.push_back(std::move(worker));
+    }
+    for (auto& worker : m_workers) {
+        Worker* w = worker.get();
+        w->thread = std::thread([this, w]() { workerLoop(*w); });
+    }
+}
+
+EngineScheduler::~EngineScheduler()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_shutdown = true;
+        m_queue.clear();
+        m_queuedBySession.clear();
+        for (auto& worker : m_workers)
+            worker->stop.store(true);
+        m_condition.wakeAll();
+    }
+    for (auto& worker : m_workers)
+        worker->thread.join();
+}
+
+uint64_t EngineScheduler::submit(Request request)
+{
+    QMutexLocker locker(&m_mutex);
+    auto old = m_queuedBySession.find(request.session);
+    if (old != m_queuedBySession.end()) {
+        m_queue.erase(old->second);
+        m_queuedBySession.erase(old);
+    }
+
+    const uint64_t ticket = m_nextTicket++;
+    const auto slot = std::make_pair(nowMs() + request.deadlineMs, ticket);
+    const uint32_t session = request.session;
+    m_queue.emplace(slot, Job{ ticket, slot.first, std::move(request) });
+    m_queuedBySession.emplace(session, slot);
+    m_condition.wakeOne();
+    return ticket;
+}
+
+void EngineScheduler::cancel(uint32_t session)
+{
+    QMutexLocker locker(&m_mutex);
+    auto queued = m_queuedBySession.find(session);
+    if (queued != m_queuedBySession.end()) {
+        m_queue.erase(queued->second);
+        m_queuedBySession.erase(queued);
+    }
+    for (auto& worker : m_workers)
+        if (worker->session == session)
+            worker->stop.store(true);
+}
+
+size_t EngineScheduler::queued() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_queue.size();
+}
+
+void EngineScheduler::workerLoop(Worker& worker)
+{
+    uint32_t lastSession = 0;     // 置换表内容所属的会话
+    for (;;) {
+        Job job;
+        {
+            QMutexLocker locker(&m_mutex);
+            while (m_queue.empty() && !m_shutdown)
+                m_condition.wait(&m_mutex);
+            if (m_shutdown) return;
+
+            auto first = m_queue.begin();
+            job = std::move(first->second);
+            m_queuedBySession.erase(job.request.session);
+            m_queue.erase(first);
+            worker.session = job.request.session;
+            worker.stop.store(false);
+        }
+
+        // 按剩余时间收紧时限；会话之间不共享置换表内容，换会话时清空
+        SearchLimits limits = job.request.limits;
+        const int remaining = int(std::max<int64_t>(kMinimumTimeMs, job.deadline - nowMs()));
+        limits.timeMs = limits.timeMs > 0 ? std::min(limits.timeMs, remaining) : remaining;
+        if (remaining <= kMinimumTimeMs)
+            limits.depth = 1;
+
+        ++m_running;
+        if (job.request.session != lastSession) {
+            worker.searcher->clearHash();
+            lastSession = job.request.session;
+        }
+        const SearchResult result = worker.searcher->search(job.request.pos, job.request.history,
+                                                            limits, &worker.stop);
+        --m_running;
+
+        bool cancelled;
+        {
+            QMutexLocker locker(&m_mutex);
+            cancelled = worker.stop.load();
+            worker.session = 0;
+        }
+        if (!cancelled && m_handler)
+            m_handler(job.request.session, job.ticket, result);
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <QMutex>
+#include <QWaitCondition>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "Search.h"
+
+// 多会话共用的搜索线程池：线程数固定，每个线程有自己的Searcher（置换表较小）
+// 每个会话最多排队一个请求，新请求替换未开始的旧请求；队列按截止时间先到先算（EDF），
+// 截止时间相同按提交顺序。开始计算时按剩余时间收紧时限，已过期的请求只搜一层尽快给出应着
+class EngineScheduler
+{
+public:
+    struct Request {
+        uint32_t session = 0;
+        Position pos;
+        std::vector<HistoryEntry> history;   // 末尾对应pos
+        SearchLimits limits;
+        int deadlineMs = 2000;               // 从提交起算的延迟上限
+    };
+
+    // 在工作线程中调用；ticket为submit的返回值
+    using ResultHandler = std::function<void(uint32_t session, uint64_t ticket, const SearchResult& result)>;
+
+    explicit EngineScheduler(int threadCount, int hashBits = 16);
+    ~EngineScheduler();
+    EngineScheduler(const EngineScheduler&) = delete;
+    EngineScheduler& operator=(const EngineScheduler&) = delete;
+
+    // 须在submit之前设置
+    void setResultHandler(ResultHandler handler) { m_handler = std::move(handler); }
+
+    uint64_t submit(Request request);
+    // 移除排队中的请求并中止正在计算的请求，被中止的请求不回调
+    void cancel(uint32_t session);
+
+    size_t queued() const;
+    int running() const { return m_running.load(); }
+    int threadCount() const { return int(m_workers.size()); }
+
+private:
+    struct Job {
+        uint64_t ticket;
+        int64_t deadline;     // 稳定时钟毫秒
+        Request request;
+    };
+
+    struct Worker {
+        std::thread thread;
+        std::unique_ptr<Searcher> searcher;
+        std::atomic<bool> stop{ false };
+        uint32_t session = 0;             // 正在计算的会话，0表示空闲
+    };
+
+    void workerLoop(Worker& worker);
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_condition;
+    std::map<std::pair<int64_t, uint64_t>, Job> m_queue;        // (截止时间, 编号)
+    std::unordered_map<uint32_t, std::pair<int64_t, uint64_t>> m_queuedBySession;
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    uint64_t m_nextTicket = 1;
+    bool m_shutdown = false;
+    std::atomic<int> m_running{ 0 };
+    ResultHandler m_handler;
+};
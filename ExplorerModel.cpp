@@ -0,0 +1,177 @@
+#include "ExplorerModel.h"
+#include <QFile>
+
+ExplorerModel::ExplorerModel(QObject* parent)
+    : QAbstractListModel(parent)
+{}
+
+ExplorerModel::~ExplorerModel()
+{
+    // 构建不可中断，对局库较大时等待其写完，避免留下半个索引文件
+    if (m_thread) {
+        m_thread->wait();
+        delete m_thread;
+    }
+}
+
+int ExplorerModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : int(m_rows.size());
+}
+
+QVariant ExplorerModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= m_rows.size())
+        return QVariant();
+
+    const Row& row = m_rows[index.row()];
+    const ExplorerMove& stats = row.stats;
+    switch (role) {
+    case MoveRole:
+        return row.wxf;
+    case IccsRole:
+        return QString::fromStdString(Position::moveToIccs(stats.move));
+    case GamesRole:
+        return int(stats.games);
+    case RedWinsRole:
+        return int(stats.redWins);
+    case BlackWinsRole:
+        return int(stats.blackWins);
+    case DrawsRole:
+        return int(stats.draws);
+    case ScoreTextRole: {
+        auto percent = [&stats](uint32_t n) { return QString::number((n * 100 + stats.games / 2) / stats.games) + "%"; };
+        return "红胜 " + percent(stats.redWins) + " 和 " + percent(stats.draws)
+             + " 黑胜 " + percent(stats.blackWins);
+    }
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int, QByteArray> ExplorerModel::roleNames() const
+{
+    return {
+        { MoveRole, "move" },
+        { IccsRole, "iccs" },
+        { GamesRole, "games" },
+        { RedWinsRole, "redWins" },
+        { BlackWinsRole, "blackWins" },
+        { DrawsRole, "draws" },
+        { ScoreTextRole, "scoreText" }
+    };
+}
+
+int ExplorerModel::totalGames() const
+{
+    return int(m_totalGames);
+}
+
+int ExplorerModel::databaseGames() const
+{
+    return int(m_databaseGames);
+}
+
+bool ExplorerModel::indexing() const
+{
+    return m_thread != nullptr;
+}
+
+void ExplorerModel::setDatabase(const QString& path)
+{
+    if (path == m_databasePath && m_index.isOpen()) return;
+    m_databasePath = path;
+    m_index.close();
+    m_index.open(PositionIndex::indexPath(path));
+    refresh();
+}
+
+void ExplorerModel::refresh()
+{
+    if (m_databasePath.isEmpty()) return;
+
+    GameDatabase database;
+    m_databaseGames = database.open(m_databasePath) ? database.count() : 0;
+    const bool failedBefore = m_databasePath == m_failedPath && m_databaseGames == m_failedGames;
+    if (m_databaseGames > 0 && !failedBefore && (!m_index.isOpen() || m_index.gameCount() != m_databaseGames))
+        rebuild();
+    query();
+}
+
+void ExplorerModel::setPosition(const Position& pos)
+{
+    m_pos = pos;
+    m_hasPosition = true;
+    query();
+}
+
+void ExplorerModel::query()
+{
+    beginResetModel();
+    m_rows.clear();
+    m_totalGames = 0;
+    if (m_hasPosition && m_index.isOpen()) {
+        Position pos = m_pos;
+        for (const ExplorerMove& stats : m_index.moves(pos.key(), &m_totalGames)) {
+            // 哈希冲突时索引中可能出现本局面不合法的着法
+            if (!pos.isLegalMove(stats.move)) continue;
+            m_rows.append({ stats, QString::fromStdString(moveToWxf(pos, stats.move)) });
+        }
+    }
+    endResetModel();
+    emit resultsChanged();
+}
+
+void ExplorerModel::rebuild()
+{
+    if (m_thread) {
+        m_rebuildPending = true;
+        return;
+    }
+
+    // 先写临时文件，完成后在界面线程中替换，查询不会读到写了一半的索引
+    const QString databasePath = m_databasePath;
+    const QString tempPath = PositionIndex::indexPath(databasePath) + ".tmp";
+    const uint32_t games = m_databaseGames;
+    m_thread = QThread::create([this, databasePath, tempPath, games]() {
+        GameDatabase database;
+        bool ok = database.open(databasePath) && PositionIndex::build(database, tempPath);
+        QMetaObject::invokeMethod(this, [this, databasePath, games, ok]() { onRebuilt(databasePath, games, ok); },
+                                  Qt::QueuedConnection);
+    });
+    m_thread->start(QThread::LowPriority);
+    emit indexingChanged();
+}
+
+void ExplorerModel::onRebuilt(const QString& databasePath, uint32_t games, bool ok)
+{
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+
+    // 重建期间切换了对局库时只替换文件，结果由新库的刷新重新判断
+    const QString indexPath = PositionIndex::indexPath(databasePath);
+    if (!ok) {
+        // 失败时删掉写了一半的临时文件，记下局数，库里有新对局时才再试
+        QFile::remove(indexPath + ".tmp");
+        m_failedPath = databasePath;
+        m_failedGames = games;
+    } else if (databasePath != m_databasePath) {
+        QFile::remove(indexPath);
+        QFile::rename(indexPath + ".tmp", indexPath);
+        m_rebuildPending = true;
+    } else {
+        m_index.close();
+        QFile::remove(indexPath);
+        QFile::rename(indexPath + ".tmp", indexPath);
+        m_index.open(indexPath);
+    }
+    emit indexingChanged();
+
+    if (m_rebuildPending) {
+        m_rebuildPending = false;
+        refresh();
+    } else {
+        query();
+    }
+}
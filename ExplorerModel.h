@@ -0,0 +1,71 @@
+#pragma once
+#include <QAbstractListModel>
+#include <QThread>
+#include "PositionIndex.h"
+
+// 开局浏览器：按局面索引列出对局库中当前局面之后的着法及胜负统计
+// 查询为mmap上的二分查找，在界面线程同步完成；索引落后于对局库时在工作线程中重建
+class ExplorerModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(int totalGames READ totalGames NOTIFY resultsChanged)
+    Q_PROPERTY(int databaseGames READ databaseGames NOTIFY resultsChanged)
+    Q_PROPERTY(bool indexing READ indexing NOTIFY indexingChanged)
+
+public:
+    enum Roles {
+        MoveRole = Qt::UserRole + 1,   // WXF记法
+        IccsRole,
+        GamesRole,
+        RedWinsRole,
+        BlackWinsRole,
+        DrawsRole,
+        ScoreTextRole                  // "红胜 40% 和 20% 黑胜 40%"
+    };
+
+    explicit ExplorerModel(QObject* parent = nullptr);
+    ~ExplorerModel() override;
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    int totalGames() const;
+    int databaseGames() const;
+    bool indexing() const;
+
+    // 打开对局库对应的局面索引（games.xdb → games.xpi），必要时重建
+    void setDatabase(const QString& path);
+    // 对局库追加对局后调用：索引中的局数落后时重建
+    void refresh();
+    void setPosition(const Position& pos);
+
+signals:
+    void resultsChanged();
+    void indexingChanged();
+
+private:
+    struct Row {
+        ExplorerMove stats;
+        QString wxf;
+    };
+
+    void query();
+    void rebuild();
+    void onRebuilt(const QString& databasePath, uint32_t games, bool ok);
+
+    QString m_databasePath;
+    PositionIndex m_index;
+    uint32_t m_databaseGames = 0;
+    Position m_pos;
+    bool m_hasPosition = false;
+
+    QThread* m_thread = nullptr;
+    bool m_rebuildPending = false;     // 重建期间又有新对局，结束后再建一次
+    // 上次重建失败的对局库及当时的局数：局数变化之前不再重建，避免每次刷新都失败一次
+    QString m_failedPath;
+    uint32_t m_failedGames = 0;
+
+    QList<Row> m_rows;
+    uint32_t m_totalGames = 0;
+};
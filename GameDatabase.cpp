@@ -0,0 +1,373 @@
+#include "GameDatabase.h"
+#include <QtEndian>
+#include <cstring>
+
+namespace {
+
+// 文件头：魔数、版本、保留字段，共16字节
+const char kDataMagic[4] = { 'X', 'Q', 'D', 'B' };
+const char kIndexMagic[4] = { 'X', 'Q', 'D', 'X' };
+const quint32 kDatabaseVersion = 1;
+const qint64 kHeaderSize = 16;
+const qint64 kRecordHeaderSize = 6;
+const qint64 kEntrySize = sizeof(GameIndexEntry);
+
+bool writeHeader(QFile& file, const char magic[4])
+{
+    uchar header[kHeaderSize] = {};
+    std::memcpy(header, magic, 4);
+    qToLittleEndian<quint32>(kDatabaseVersion, header + 4);
+    return file.write(reinterpret_cast<const char*>(header), kHeaderSize) == kHeaderSize;
+}
+
+bool checkHeader(const uchar* data, const char magic[4])
+{
+    return std::memcmp(data, magic, 4) == 0 && qFromLittleEndian<quint32>(data + 4) == kDatabaseVersion;
+}
+
+void encodeEntry(const GameIndexEntry& entry, uchar* p)
+{
+    qToLittleEndian<quint64>(entry.offset, p);
+    qToLittleEndian<quint32>(entry.length, p + 8);
+    qToLittleEndian<quint16>(entry.moveCount, p + 12);
+    p[14] = uchar(entry.result);
+    p[15] = 0;
+}
+
+GameIndexEntry decodeEntry(const uchar* p)
+{
+    GameIndexEntry entry;
+    entry.offset = qFromLittleEndian<quint64>(p);
+    entry.length = qFromLittleEndian<quint32>(p + 8);
+    entry.moveCount = qFromLittleEndian<quint16>(p + 12);
+    entry.result = GameResult(p[14]);
+    entry.reserved = 0;
+    return entry;
+}
+
+// 只读记录头即可得到一局的长度，不解析标签与着法
+bool recordAt(const uchar* data, qint64 dataSize, qint64 offset, GameIndexEntry& entry)
+{
+    if (offset + kRecordHeaderSize > dataSize) return false;
+    const uchar* p = data + offset;
+    quint16 moveCount = qFromLittleEndian<quint16>(p);
+    qint64 length = kRecordHeaderSize + p[3] + qFromLittleEndian<quint16>(p + 4) + 2 * qint64(moveCount);
+    if (offset + length > dataSize) return false;   // 末尾写了一半的记录
+
+    entry.offset = quint64(offset);
+    entry.length = quint32(length);
+    entry.moveCount = moveCount;
+    entry.result = GameResult(p[2]);
+    entry.reserved = 0;
+    return true;
+}
+
+// 索引末条记录的结束位置：索引写在数据之后，此位置之前的记录都是完整的；
+// 索引缺失、无效或超出数据文件大小时从文件头之后算起
+qint64 indexedDataEnd(const QString& indexPath, qint64 dataSize)
+{
+    QFile indexFile(indexPath);
+    if (!indexFile.open(QIODevice::ReadOnly))
+        return kHeaderSize;
+    const qint64 indexSize = indexFile.size();
+    if (indexSize <= kHeaderSize || (indexSize - kHeaderSize) % kEntrySize != 0)
+        return kHeaderSize;
+    uchar existing[kHeaderSize];
+    uchar last[kEntrySize];
+    if (indexFile.read(reinterpret_cast<char*>(existing), kHeaderSize) != kHeaderSize || !checkHeader(existing, kIndexMagic)
+        || !indexFile.seek(indexSize - kEntrySize)
+        || indexFile.read(reinterpret_cast<char*>(last), kEntrySize) != kEntrySize)
+        return kHeaderSize;
+    const GameIndexEntry entry = decodeEntry(last);
+    const qint64 end = qint64(entry.offset) + entry.length;
+    return entry.offset >= quint64(kHeaderSize) && end <= dataSize ? end : kHeaderSize;
+}
+
+// 从start起逐条读记录头，返回最后一条完整记录的结束位置；失败返回-1
+qint64 completeDataEnd(QFile& dataFile, qint64 start)
+{
+    const qint64 dataSize = dataFile.size();
+    uchar* data = dataFile.map(0, dataSize);
+    if (!data)
+        return -1;
+    qint64 end = start;
+    GameIndexEntry entry;
+    while (recordAt(data, dataSize, end, entry))
+        end += entry.length;
+    dataFile.unmap(data);
+    return end;
+}
+
+// 标签值中的制表符与换行会破坏"键\t值\n"格式，替换为空格
+std::string sanitize(const std::string& text)
+{
+    std::string result = text;
+    for (char& c : result) {
+        if (c == '\t' || c == '\n' || c == '\r') c = ' ';
+    }
+    return result;
+}
+
+} // namespace
+
+GameDatabase::~GameDatabase()
+{
+    close();
+}
+
+QString GameDatabase::indexPath(const QString& path)
+{
+    if (path.endsWith(".xdb"))
+        return path.left(path.size() - 4) + ".xdx";
+    return path + ".xdx";
+}
+
+bool GameDatabase::open(const QString& path)
+{
+    close();
+
+    m_dataFile.setFileName(path);
+    if (!m_dataFile.open(QIODevice::ReadOnly))
+        return false;
+    m_dataSize = m_dataFile.size();
+    if (m_dataSize < kHeaderSize) {
+        close();
+        return false;
+    }
+    uchar* data = m_dataFile.map(0, m_dataSize);
+    if (!data || !checkHeader(data, kDataMagic)) {
+        if (data) m_dataFile.unmap(data);
+        close();
+        return false;
+    }
+    m_data = data;
+
+    // 索引与数据对得上（末条之后不再有完整记录）才使用，否则重建一次
+    auto mapIndex = [this]() {
+        if (!m_indexFile.open(QIODevice::ReadOnly)) return false;
+        m_indexSize = m_indexFile.size();
+        if (m_indexSize < kHeaderSize || (m_indexSize - kHeaderSize) % kEntrySize != 0) return false;
+        uchar* index = m_indexFile.map(0, m_indexSize);
+        if (!index) return false;
+        m_index = index;
+        m_count = uint32_t((m_indexSize - kHeaderSize) / kEntrySize);
+        if (!checkHeader(m_index, kIndexMagic)) return false;
+
+        qint64 end = kHeaderSize;
+        if (m_count > 0) {
+            GameIndexEntry last = info(m_count - 1);
+            end = qint64(last.offset) + last.length;
+        }
+        // 末尾写了一半的记录（追加时中断）不算数
+        GameIndexEntry tail;
+        return end <= m_dataSize && !recordAt(m_data, m_dataSize, end, tail);
+    };
+    auto unmapIndex = [this]() {
+        if (m_index) m_indexFile.unmap(const_cast<uchar*>(m_index));
+        m_index = nullptr;
+        m_count = 0;
+        if (m_indexFile.isOpen()) m_indexFile.close();
+    };
+
+    m_indexFile.setFileName(indexPath(path));
+    if (!mapIndex()) {
+        unmapIndex();
+        if (!rebuildIndex(path) || !mapIndex()) {
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void GameDatabase::close()
+{
+    if (m_index) {
+        m_indexFile.unmap(const_cast<uchar*>(m_index));
+        m_index = nullptr;
+    }
+    if (m_data) {
+        m_dataFile.unmap(const_cast<uchar*>(m_data));
+        m_data = nullptr;
+    }
+    if (m_indexFile.isOpen())
+        m_indexFile.close();
+    if (m_dataFile.isOpen())
+        m_dataFile.close();
+    m_dataSize = 0;
+    m_indexSize = 0;
+    m_count = 0;
+}
+
+GameIndexEntry GameDatabase::info(uint32_t index) const
+{
+    return decodeEntry(m_index + kHeaderSize + qint64(index) * kEntrySize);
+}
+
+bool GameDatabase::game(uint32_t index, GameRecord& game) const
+{
+    game = GameRecord();
+    if (!isOpen() || index >= m_count) return false;
+
+    GameIndexEntry entry = info(index);
+    GameIndexEntry record;
+    if (!recordAt(m_data, m_dataSize, qint64(entry.offset), record) || record.length != entry.length)
+        return false;
+
+    const uchar* p = m_data + entry.offset;
+    const int fenLength = p[3];
+    const int tagLength = qFromLittleEndian<quint16>(p + 4);
+    game.result = record.result;
+    p += kRecordHeaderSize;
+
+    game.fen.assign(reinterpret_cast<const char*>(p), fenLength);
+    p += fenLength;
+
+    const char* tags = reinterpret_cast<const char*>(p);
+    std::string line;
+    for (int i = 0; i < tagLength; ++i) {
+        if (tags[i] != '\n') {
+            line += tags[i];
+            continue;
+        }
+        size_t tab = line.find('\t');
+        if (tab != std::string::npos)
+            game.tags.emplace_back(line.substr(0, tab), line.substr(tab + 1));
+        line.clear();
+    }
+    p += tagLength;
+
+    game.moves.resize(record.moveCount);
+    for (int i = 0; i < record.moveCount; ++i)
+        game.moves[i] = qFromLittleEndian<quint16>(p + 2 * i);
+    return true;
+}
+
+bool GameDatabase::append(const QString& path, const GameRecord& game)
+{
+    std::string tags;
+    for (const auto& [key, value] : game.tags)
+        tags += sanitize(key) + "\t" + sanitize(value) + "\n";
+    if (game.fen.size() > 255 || tags.size() > 65535 || game.moves.size() > 65535)
+        return false;
+
+    QByteArray record(kRecordHeaderSize, 0);
+    uchar* header = reinterpret_cast<uchar*>(record.data());
+    qToLittleEndian<quint16>(quint16(game.moves.size()), header);
+    header[2] = uchar(game.result);
+    header[3] = uchar(game.fen.size());
+    qToLittleEndian<quint16>(quint16(tags.size()), header + 4);
+    record.append(game.fen.data(), qsizetype(game.fen.size()));
+    record.append(tags.data(), qsizetype(tags.size()));
+    for (Move move : game.moves) {
+        uchar bytes[2];
+        qToLittleEndian<quint16>(move, bytes);
+        record.append(reinterpret_cast<const char*>(bytes), 2);
+    }
+
+    // 先写数据再写索引：中途失败时索引落后于数据，下次打开会重建
+    QFile dataFile(path);
+    if (!dataFile.open(QIODevice::ReadWrite))
+        return false;
+    qint64 offset = dataFile.size();
+    if (offset == 0) {
+        if (!writeHeader(dataFile, kDataMagic)) return false;
+        offset = kHeaderSize;
+    } else {
+        uchar existing[kHeaderSize];
+        if (offset < kHeaderSize || dataFile.read(reinterpret_cast<char*>(existing), kHeaderSize) != kHeaderSize
+            || !checkHeader(existing, kDataMagic))
+            return false;
+        // 上次追加中途失败时末尾留有写了一半的记录，新记录写在其后会被当作它的一部分；
+        // 从最后一条完整记录之后写起，截掉残留
+        offset = completeDataEnd(dataFile, indexedDataEnd(indexPath(path), offset));
+        if (offset < 0 || (offset < dataFile.size() && !dataFile.resize(offset)))
+            return false;
+    }
+    if (!dataFile.seek(offset) || dataFile.write(record) != record.size())
+        return false;
+    dataFile.close();
+
+    QFile indexFile(indexPath(path));
+    if (!indexFile.open(QIODevice::ReadWrite))
+        return false;
+    qint64 indexSize = indexFile.size();
+
+    // 索引末条须结束于本局之前，否则索引已过期，整体重建
+    bool consistent = false;
+    if (indexSize == 0) {
+        consistent = offset == kHeaderSize && writeHeader(indexFile, kIndexMagic);
+        indexSize = kHeaderSize;
+    } else if (indexSize >= kHeaderSize && (indexSize - kHeaderSize) % kEntrySize == 0) {
+        uchar existing[kHeaderSize];
+        qint64 end = kHeaderSize;
+        if (indexFile.read(reinterpret_cast<char*>(existing), kHeaderSize) == kHeaderSize
+            && checkHeader(existing, kIndexMagic)) {
+            if (indexSize > kHeaderSize) {
+                uchar last[kEntrySize];
+                if (indexFile.seek(indexSize - kEntrySize)
+                    && indexFile.read(reinterpret_cast<char*>(last), kEntrySize) == kEntrySize) {
+                    GameIndexEntry entry = decodeEntry(last);
+                    end = qint64(entry.offset) + entry.length;
+                } else {
+                    end = -1;
+                }
+            }
+            consistent = end == offset;
+        }
+    }
+    if (!consistent) {
+        indexFile.close();
+        return rebuildIndex(path);
+    }
+
+    GameIndexEntry entry = { quint64(offset), quint32(record.size()), quint16(game.moves.size()), game.result, 0 };
+    uchar bytes[kEntrySize];
+    encodeEntry(entry, bytes);
+    return indexFile.seek(indexSize)
+        && indexFile.write(reinterpret_cast<const char*>(bytes), kEntrySize) == kEntrySize;
+}
+
+bool GameDatabase::rebuildIndex(const QString& path)
+{
+    QFile dataFile(path);
+    if (!dataFile.open(QIODevice::ReadOnly))
+        return false;
+    qint64 dataSize = dataFile.size();
+    if (dataSize < kHeaderSize)
+        return false;
+    uchar* data = dataFile.map(0, dataSize);
+    if (!data)
+        return false;
+    if (!checkHeader(data, kDataMagic)) {
+        dataFile.unmap(data);
+        return false;
+    }
+
+    QFile indexFile(indexPath(path));
+    if (!indexFile.open(QIODevice::WriteOnly | QIODevice::Truncate) || !writeHeader(indexFile, kIndexMagic)) {
+        dataFile.unmap(data);
+        return false;
+    }
+
+    // 按块写出，百万局的索引只需扫描一遍记录头
+    QByteArray buffer;
+    buffer.reserve(4096 * kEntrySize);
+    bool ok = true;
+    qint64 offset = kHeaderSize;
+    GameIndexEntry entry;
+    while (ok && recordAt(data, dataSize, offset, entry)) {
+        uchar bytes[kEntrySize];
+        encodeEntry(entry, bytes);
+        buffer.append(reinterpret_cast<const char*>(bytes), kEntrySize);
+        offset += entry.length;
+        if (buffer.size() >= 4096 * kEntrySize) {
+            ok = indexFile.write(buffer) == buffer.size();
+            buffer.clear();
+        }
+    }
+    if (ok && !buffer.isEmpty())
+        ok = indexFile.write(buffer) == buffer.size();
+    dataFile.unmap(data);
+    return ok;
+}
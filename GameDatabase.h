@@ -0,0 +1,54 @@
+#pragma once
+#include <QFile>
+#include <QString>
+#include <cstdint>
+#include "GameRecord.h"
+
+// 对局库索引条目：数据文件中一局的位置与摘要，浏览列表时不读数据文件
+struct GameIndexEntry {
+    uint64_t offset;
+    uint32_t length;
+    uint16_t moveCount;
+    GameResult result;
+    uint8_t reserved;
+};
+static_assert(sizeof(GameIndexEntry) == 16, "GameIndexEntry must stay 16 bytes on disk");
+
+// 二进制多局对局库，文件为小端序：
+//   数据文件(.xdb)：16字节文件头后逐局追加记录，每局为
+//     着法数u16、结果u8、FEN长度u8、标签字节数u16、FEN、标签（"键\t值\n"，UTF-8）、着法u16×n
+//   索引文件(.xdx)：16字节文件头后每局一个GameIndexEntry，局数由文件大小决定
+// 只追加不改写：新对局写在数据文件末尾，再追加索引条目；索引缺失或与数据不符时打开时按记录头重建
+// 上次追加中途失败留在末尾的半条记录不算一局，下次追加时截掉
+// 打开时mmap两个文件，取某一局只解析该局的记录
+class GameDatabase
+{
+public:
+    GameDatabase() = default;
+    ~GameDatabase();
+    GameDatabase(const GameDatabase&) = delete;
+    GameDatabase& operator=(const GameDatabase&) = delete;
+
+    bool open(const QString& path);
+    void close();
+    bool isOpen() const { return m_data != nullptr; }
+    uint32_t count() const { return m_count; }
+
+    GameIndexEntry info(uint32_t index) const;
+    bool game(uint32_t index, GameRecord& game) const;
+
+    // 追加一局到path（不存在时创建），已打开的实例需重新open才能看到新对局
+    static bool append(const QString& path, const GameRecord& game);
+    // 扫描数据文件的记录头重写索引文件
+    static bool rebuildIndex(const QString& path);
+    static QString indexPath(const QString& path);
+
+private:
+    QFile m_dataFile;
+    QFile m_indexFile;
+    const uchar* m_data = nullptr;
+    qint64 m_dataSize = 0;
+    const uchar* m_index = nullptr;
+    qint64 m_indexSize = 0;
+    uint32_t m_count = 0;
+};
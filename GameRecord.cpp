@@ -0,0 +1,292 @@
+#include "GameRecord.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+namespace {
+
+const char kWxfLetters[8] = { '?', 'K', 'A', 'E', 'H', 'R', 'C', 'P' };
+
+// 纵线号：红方从右向左（x=8为1），黑方从己方右侧数（x=0为1）
+int wxfFile(int side, int x)
+{
+    return side == SIDE_RED ? 9 - x : x + 1;
+}
+
+// 向前的步数（红方y减小为前进）
+int wxfForward(int side, int fromY, int toY)
+{
+    return side == SIDE_RED ? fromY - toY : toY - fromY;
+}
+
+std::string trim(const std::string& text)
+{
+    size_t begin = text.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) return std::string();
+    size_t end = text.find_last_not_of(" \t\r\n");
+    return text.substr(begin, end - begin + 1);
+}
+
+bool isResultToken(const std::string& token)
+{
+    return token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*";
+}
+
+// "12." 或 "12..." 形式的回合号，或着法前粘连的回合号 "12.h2e2"
+size_t moveNumberLength(const std::string& token)
+{
+    size_t i = 0;
+    while (i < token.size() && std::isdigit(static_cast<unsigned char>(token[i]))) ++i;
+    if (i == 0 || i >= token.size() || token[i] != '.') return 0;
+    while (i < token.size() && token[i] == '.') ++i;
+    return i;
+}
+
+bool isIccsToken(const std::string& token)
+{
+    std::string text;
+    for (char c : token) {
+        if (c != '-') text += char(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return text.size() == 4 && text[0] >= 'a' && text[0] <= 'i' && std::isdigit(static_cast<unsigned char>(text[1]))
+        && text[2] >= 'a' && text[2] <= 'i' && std::isdigit(static_cast<unsigned char>(text[3]));
+}
+
+// 解析 [Key "Value"]
+bool parseTag(const std::string& line, std::string& key, std::string& value)
+{
+    if (line.size() < 4 || line.front() != '[' || line.back() != ']') return false;
+    size_t space = line.find(' ');
+    size_t open = line.find('"');
+    size_t close = line.rfind('"');
+    if (space == std::string::npos || open == std::string::npos || close <= open) return false;
+    key = line.substr(1, space - 1);
+    value = line.substr(open + 1, close - open - 1);
+    return !key.empty();
+}
+
+} // namespace
+
+std::string GameRecord::tag(const std::string& key) const
+{
+    for (const auto& [name, value] : tags) {
+        if (name == key) return value;
+    }
+    return std::string();
+}
+
+void GameRecord::setTag(const std::string& key, const std::string& value)
+{
+    for (auto& entry : tags) {
+        if (entry.first == key) {
+            entry.second = value;
+            return;
+        }
+    }
+    tags.emplace_back(key, value);
+}
+
+Position GameRecord::startPosition() const
+{
+    Position pos;
+    if (fen.empty() || !pos.fromFen(fen))
+        pos = Position::startPosition();
+    return pos;
+}
+
+const char* GameRecord::resultText(GameResult result)
+{
+    switch (result) {
+    case GameResult::RedWin: return "1-0";
+    case GameResult::BlackWin: return "0-1";
+    case GameResult::Draw: return "1/2-1/2";
+    default: return "*";
+    }
+}
+
+GameResult GameRecord::resultFromText(const std::string& text)
+{
+    if (text == "1-0") return GameResult::RedWin;
+    if (text == "0-1") return GameResult::BlackWin;
+    if (text == "1/2-1/2") return GameResult::Draw;
+    return GameResult::Unknown;
+}
+
+std::string GameRecord::toText(MoveFormat format) const
+{
+    std::string text = "[Game \"Chinese Chess\"]\n";
+    for (const auto& [key, value] : tags)
+        text += "[" + key + " \"" + value + "\"]\n";
+    text += std::string("[Result \"") + resultText(result) + "\"]\n";
+    if (!fen.empty())
+        text += "[FEN \"" + fen + "\"]\n";
+    text += std::string("[Format \"") + (format == MoveFormat::Wxf ? "WXF" : "ICCS") + "\"]\n";
+
+    Position pos = startPosition();
+    int moveNumber = 1;
+    bool lineOpen = false;
+    // 黑方先行的残局第一回合写作 "1. ... 着法"
+    if (pos.sideToMove() == SIDE_BLACK && !moves.empty()) {
+        text += "1. ...";
+        lineOpen = true;
+    }
+    for (Move move : moves) {
+        if (pos.sideToMove() == SIDE_RED) {
+            if (lineOpen) text += "\n";
+            text += std::to_string(moveNumber) + ".";
+            lineOpen = true;
+        }
+        text += " " + (format == MoveFormat::Wxf ? moveToWxf(pos, move) : Position::moveToIccs(move));
+        if (pos.sideToMove() == SIDE_BLACK) ++moveNumber;
+        pos.makeMove(move);
+    }
+    if (lineOpen) text += "\n";
+    text += std::string(resultText(result)) + "\n\n";
+    return text;
+}
+
+bool GameRecordReader::readLine(std::string& line)
+{
+    if (m_hasPending) {
+        line = std::move(m_pending);
+        m_hasPending = false;
+        return true;
+    }
+    if (m_device->atEnd()) return false;
+    line = trim(m_device->readLine().toStdString());
+    return true;
+}
+
+bool GameRecordReader::next(GameRecord& game)
+{
+    game = GameRecord();
+    std::string format;
+    std::vector<std::string> tokens;
+    bool started = false, inMoves = false;
+
+    // 标签段之后的着法段直到空行或下一局的标签为止
+    std::string line;
+    while (readLine(line)) {
+        if (line.empty()) {
+            if (inMoves) break;
+            continue;
+        }
+        if (line.front() == '[') {
+            if (inMoves) {
+                m_pending = line;
+                m_hasPending = true;
+                break;
+            }
+            std::string key, value;
+            if (!parseTag(line, key, value)) continue;
+            started = true;
+            if (key == "Result") game.result = GameRecord::resultFromText(value);
+            else if (key == "FEN") game.fen = value;
+            else if (key == "Format") format = value;
+            else if (key != "Game") game.setTag(key, value);
+            continue;
+        }
+
+        // 着法段：去掉 {注释}，按空白切分
+        inMoves = started = true;
+        std::string token;
+        int comment = 0;
+        for (char c : line + " ") {
+            if (c == '{') ++comment;
+            else if (c == '}') comment = std::max(0, comment - 1);
+            else if (comment) continue;
+            else if (std::isspace(static_cast<unsigned char>(c))) {
+                if (!token.empty()) tokens.push_back(std::move(token));
+                token.clear();
+            } else {
+                token += c;
+            }
+        }
+    }
+    if (!started) return false;
+
+    Position pos = game.startPosition();
+    for (std::string token : tokens) {
+        if (isResultToken(token)) {
+            if (game.result == GameResult::Unknown) game.result = GameRecord::resultFromText(token);
+            break;
+        }
+        token.erase(0, moveNumberLength(token));
+        if (token.find_first_not_of('.') == std::string::npos) continue;   // "1. ..." 中的占位
+
+        bool iccs = format == "ICCS" || (format != "WXF" && isIccsToken(token));
+        Move move = NO_MOVE;
+        if (iccs) {
+            std::string text;
+            for (char c : token) {
+                if (c != '-') text += c;
+            }
+            move = Position::moveFromIccs(text);
+        } else {
+            move = moveFromWxf(pos, token);
+        }
+        if (move == NO_MOVE || !pos.isLegalMove(move)) break;
+        pos.makeMove(move);
+        game.moves.push_back(move);
+    }
+    return true;
+}
+
+std::string moveToWxf(const Position& pos, Move move)
+{
+    const int from = moveFrom(move), to = moveTo(move);
+    const uint8_t piece = pos.pieceAt(from);
+    if (!piece) return std::string();
+
+    const int side = pieceSide(piece), type = pieceType(piece);
+    const int fx = squareX(from), fy = squareY(from);
+    const int tx = squareX(to), ty = squareY(to);
+
+    std::string text(1, kWxfLetters[type]);
+
+    // 同一纵线上的同种棋子：最前一枚记+，最后一枚记-
+    int ahead = 0, behind = 0;
+    for (int y = 0; y < 10; ++y) {
+        if (y == fy || pos.pieceAt(fx, y) != piece) continue;
+        if (wxfForward(side, fy, y) > 0) ++ahead;
+        else ++behind;
+    }
+    if (ahead + behind > 0 && ahead == 0)
+        text += '+';
+    else if (ahead + behind > 0 && behind == 0)
+        text += '-';
+    else
+        text += char('0' + wxfFile(side, fx));
+
+    const int forward = wxfForward(side, fy, ty);
+    const bool straight = type == PT_KING || type == PT_ROOK || type == PT_CANNON || type == PT_SOLDIER;
+    if (forward == 0) {
+        text += '.';
+        text += char('0' + wxfFile(side, tx));
+    } else {
+        text += forward > 0 ? '+' : '-';
+        text += char('0' + (straight ? std::abs(forward) : wxfFile(side, tx)));
+    }
+    return text;
+}
+
+Move moveFromWxf(Position& pos, const std::string& text)
+{
+    // 统一写法：兼容 = 代替 . ，B/N 代替 E/H
+    std::string normalized;
+    for (char c : text) {
+        char u = char(std::toupper(static_cast<unsigned char>(c)));
+        if (u == '=') u = '.';
+        if (u == 'B') u = 'E';
+        if (u == 'N') u = 'H';
+        normalized += u;
+    }
+
+    Move moves[MAX_MOVES];
+    int count = pos.generateLegalMoves(moves);
+    for (int i = 0; i < count; ++i) {
+        if (moveToWxf(pos, moves[i]) == normalized)
+            return moves[i];
+    }
+    return NO_MOVE;
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <QIODevice>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Position.h"
+
+enum class GameResult : uint8_t {
+    Unknown = 0,
+    RedWin,
+    BlackWin,
+    Draw
+};
+
+// 棋谱记录格式：ICCS坐标（h2e2）或WXF纵线记法（C2.5）
+enum class MoveFormat {
+    Iccs,
+    Wxf
+};
+
+// 一局棋谱：起始局面（空为标准开局）、着法与结果，其余信息以标签保存
+struct GameRecord {
+    std::vector<std::pair<std::string, std::string>> tags;   // Event、Red、Black、Date等，UTF-8
+    std::string fen;
+    GameResult result = GameResult::Unknown;
+    std::vector<Move> moves;
+
+    std::string tag(const std::string& key) const;
+    void setTag(const std::string& key, const std::string& value);
+    Position startPosition() const;
+
+    // 文本棋谱（类PGN格式）：标签行 [Key "Value"] 后接带回合号的着法与结果
+    //   [Game "Chinese Chess"]
+    //   [Result "1-0"]
+    //   [Format "ICCS"]
+    //   1. h2e2 h9g7
+    //   2. h0g2 i9h9
+    //   1-0
+    std::string toText(MoveFormat format = MoveFormat::Iccs) const;
+
+    static const char* resultText(GameResult result);
+    static GameResult resultFromText(const std::string& text);
+};
+
+// 流式读取文本棋谱：每次从设备中解析一局，不把整个文件读入内存
+// 着法格式按Format标签，缺省时逐着自动识别；遇到非法着法截断该局
+class GameRecordReader
+{
+public:
+    explicit GameRecordReader(QIODevice* device) : m_device(device) {}
+
+    bool next(GameRecord& game);
+
+private:
+    bool readLine(std::string& line);
+
+    QIODevice* m_device;
+    std::string m_pending;        // 读过头的下一局标签行
+    bool m_hasPending = false;
+};
+
+// WXF记法：棋子字母 + 原纵线（同线两子用+/-区分前后）+ 动作（+进 -退 .平）+ 步数或新纵线
+// 纵线按各自一方从右向左数1-9；同线三个以上兵卒时中间的兵仍写纵线号，解析时取第一个匹配
+std::string moveToWxf(const Position& pos, Move move);
+Move moveFromWxf(Position& pos, const std::string& text);
@@ -0,0 +1,57 @@
+#include "GameSession.h"
+
+bool GameSession::makeMove(Move move)
+{
+    if (!pos.isLegalMove(move)) return false;
+    const uint8_t captured = pos.makeMove(move);
+    history.push_back({ pos.key(), move, pos.isInCheck(pos.sideToMove()), captured != 0 });
+    return true;
+}
+
+bool GameSession::undo()
+{
+    if (history.size() <= 1) return false;
+    history.pop_back();
+    pos = start;
+    for (size_t i = 1; i < history.size(); ++i)
+        pos.makeMove(history[i].move);
+    return true;
+}
+
+size_t GameSession::memoryUsage() const
+{
+    return sizeof(GameSession) + history.capacity() * sizeof(HistoryEntry);
+}
+
+GameSession* SessionManager::create(const Position& start)
+{
+    auto session = std::make_unique<GameSession>();
+    session->id = m_nextId++;
+    session->start = start;
+    session->pos = start;
+    session->history.reserve(64);
+    session->history.push_back({ start.key(), NO_MOVE, start.isInCheck(start.sideToMove()), true });
+
+    GameSession* raw = session.get();
+    m_sessions.emplace(raw->id, std::move(session));
+    return raw;
+}
+
+GameSession* SessionManager::find(uint32_t id)
+{
+    auto it = m_sessions.find(id);
+    return it == m_sessions.end() ? nullptr : it->second.get();
+}
+
+bool SessionManager::close(uint32_t id)
+{
+    return m_sessions.erase(id) > 0;
+}
+
+size_t SessionManager::memoryUsage() const
+{
+    size_t total = 0;
+    for (const auto& [id, session] : m_sessions)
+        total += session->memoryUsage();
+    return total;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "Position.h"
+#include "Search.h"
+
+// 服务端的一局对局：紧凑局面加着法记录，不创建任何QObject
+// history[0]为起始局面（move为NO_MOVE），之后每步一项，同时用于重复局面判断与悔棋
+struct GameSession {
+    uint32_t id = 0;
+    Position start;
+    Position pos;
+    std::vector<HistoryEntry> history;
+    int level = 0;
+    uint64_t ticket = 0;      // 进行中的AI请求编号，0表示没有
+
+    // 着法不合法时返回false，局面不变
+    bool makeMove(Move move);
+    // 退回一步（从起始局面重放），没有可退的着法时返回false
+    bool undo();
+    int ply() const { return int(history.size()) - 1; }
+    // 大致占用的内存（字节），供统计
+    size_t memoryUsage() const;
+};
+
+// 会话表：只在一个线程（服务端的事件循环）中使用
+class SessionManager
+{
+public:
+    GameSession* create(const Position& start);
+    GameSession* find(uint32_t id);
+    bool close(uint32_t id);
+
+    size_t count() const { return m_sessions.size(); }
+    size_t memoryUsage() const;
+
+private:
+    std::unordered_map<uint32_t, std::unique_ptr<GameSession>> m_sessions;
+    uint32_t m_nextId = 1;
+};
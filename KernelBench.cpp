@@ -0,0 +1,153 @@
+// 棋盘计算核心测速工具：对随机对局中取得的局面，按CPU支持的各级指令集（普通循环、SSE2、AVX2）
+// 分别运行各个计算核心，检查结果与普通循环完全一致，并输出每次调用的耗时与相对普通循环的加速比
+//
+// 用法：kernelBench [-p 2000] [-i 200] [--seed 1]
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QTextStream>
+#include <chrono>
+#include <random>
+#include <vector>
+#include "BoardKernels.h"
+#include "Search.h"
+#include "Simd.h"
+
+namespace {
+
+struct Sample {
+    Position pos;
+    SquareMap board;
+    SquareMap attacks[2];
+};
+
+// 随机对局中的局面：每局走随机步数，吃子着法优先，使残局与中局都有
+std::vector<Sample> collectSamples(std::mt19937& rng, int count)
+{
+    std::vector<Sample> samples;
+    samples.reserve(count);
+    while (int(samples.size()) < count) {
+        Position pos = Position::startPosition();
+        const int plies = int(rng() % 120);
+        for (int i = 0; i < plies; ++i) {
+            Move moves[MAX_MOVES];
+            const int n = pos.generateLegalMoves(moves);
+            if (n == 0) break;
+            Move move = moves[rng() % n];
+            for (int tries = 0; tries < 3 && !pos.pieceAt(moveTo(move)); ++tries)
+                move = moves[rng() % n];
+            pos.makeMove(move);
+        }
+        Sample sample;
+        sample.pos = pos;
+        BoardKernels::loadBoard(pos, sample.board);
+        BoardKernels::loadAttacks(pos, SIDE_RED, sample.attacks[SIDE_RED]);
+        BoardKernels::loadAttacks(pos, SIDE_BLACK, sample.attacks[SIDE_BLACK]);
+        samples.push_back(sample);
+    }
+    return samples;
+}
+
+// 两方九宫与随机子力位置表，只用于测速
+struct BenchTables {
+    SquareMap palace = {};
+    PieceSquareTable table = {};
+};
+
+BenchTables makeTables(std::mt19937& rng)
+{
+    BenchTables tables;
+    for (int y : { 0, 1, 2, 7, 8, 9 })
+        for (int x = 3; x <= 5; ++x)
+            tables.palace.v[squareOf(x, y)] = 1;
+    for (int piece = 1; piece < 16; ++piece) {
+        if (!pieceType(uint8_t(piece))) continue;
+        for (int sq = 0; sq < 90; ++sq)
+            tables.table.v[piece][sq] = int16_t(int(rng() % 2001) - 1000);
+    }
+    return tables;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("kernelBench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Benchmark the vectorised board kernels against the scalar loops");
+    parser.addHelpOption();
+    QCommandLineOption positionsOption({ "p", "positions" }, "Number of positions from random games.", "n", "2000");
+    QCommandLineOption iterationsOption({ "i", "iterations" }, "Passes over the positions per kernel.", "n", "200");
+    QCommandLineOption seedOption("seed", "Random seed for the games and tables.", "n", "1");
+    parser.addOptions({ positionsOption, iterationsOption, seedOption });
+    parser.process(app);
+
+    const int positions = std::max(1, parser.value(positionsOption).toInt());
+    const int iterations = std::max(1, parser.value(iterationsOption).toInt());
+    std::mt19937 rng(parser.value(seedOption).toUInt());
+
+    const std::vector<Sample> samples = collectSamples(rng, positions);
+    const BenchTables tables = makeTables(rng);
+
+    QTextStream out(stdout);
+    out << samples.size() << " positions x " << iterations << " passes" << Qt::endl;
+
+    const SimdLevel best = supportedSimd();
+    bool mismatch = false;
+    auto bench = [&](const char* name, auto run) {
+        // 普通循环的结果作为基准
+        setSimdLevel(SimdLevel::Scalar);
+        std::vector<int> expected;
+        expected.reserve(samples.size());
+        for (const Sample& sample : samples)
+            expected.push_back(run(sample));
+
+        double scalarNs = 0;
+        for (int level = int(SimdLevel::Scalar); level <= int(best); ++level) {
+            setSimdLevel(SimdLevel(level));
+            for (size_t i = 0; i < samples.size(); ++i) {
+                if (run(samples[i]) != expected[i]) {
+                    out << name << " " << simdName(SimdLevel(level)) << ": mismatch at position " << i
+                        << " (" << QString::fromStdString(samples[i].pos.toFen()) << ")" << Qt::endl;
+                    mismatch = true;
+                    break;
+                }
+            }
+
+            int64_t checksum = 0;
+            const auto start = std::chrono::steady_clock::now();
+            for (int pass = 0; pass < iterations; ++pass)
+                for (const Sample& sample : samples)
+                    checksum += run(sample);
+            const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+            const double ns = elapsed.count() / (double(iterations) * samples.size());
+            if (level == int(SimdLevel::Scalar))
+                scalarNs = ns;
+
+            out << QString("%1 %2 %3 ns/call  x%4  (checksum %5)")
+                       .arg(QString::fromLatin1(name), -18)
+                       .arg(QString::fromLatin1(simdName(SimdLevel(level))), -7)
+                       .arg(ns, 7, 'f', 2)
+                       .arg(scalarNs / ns, 0, 'f', 2)
+                       .arg(checksum)
+                << Qt::endl;
+        }
+    };
+
+    bench("pieceSquareSum", [&](const Sample& s) { return BoardKernels::pieceSquareSum(s.board, tables.table); });
+    bench("sumMasked", [&](const Sample& s) { return BoardKernels::sumMasked(s.attacks[SIDE_RED], tables.palace); });
+    bench("countMobility", [](const Sample& s) { return BoardKernels::countMobility(s.board, s.attacks[SIDE_BLACK], SIDE_BLACK); });
+    bench("countHanging", [](const Sample& s) {
+        return BoardKernels::countHanging(s.board, s.attacks[SIDE_BLACK], s.attacks[SIDE_RED], SIDE_RED);
+    });
+    bench("evaluatePosition", [](const Sample& s) { return evaluatePosition(s.pos); });
+    bench("measureActivity", [](const Sample& s) {
+        const ActivityTerms terms = measureActivity(s.pos);
+        return terms.mobility[SIDE_RED] + 3 * terms.palacePressure[SIDE_BLACK] + 7 * terms.hanging[SIDE_RED];
+    });
+
+    setSimdLevel(best);
+    return mismatch ? 1 : 0;
+}
@@ -16,10 +16,10 @@ public:
             return false;
 
         // 判断是否在九宫格内
-        if ((color() == "红" || color() == "red")) {
+        if (side() == SIDE_RED) {
             if (targetX < 3 || targetX > 5 || targetY < 7 || targetY > 9)
                 return false;
-        } else if ((color() == "黑" || color() == "black")) {
+        } else {
             if (targetX < 3 || targetX > 5 || targetY < 0 || targetY > 2)
                 return false;
         }
@@ -229,6 +229,92 @@ Window {
                     }
                 }
 
+                // AI难度：人机模式下可随时切换，下一步生效
+                RowLayout {
+                    Layout.fillWidth: true
+                    spacing: 4
+                    visible: controller && controller.isAiMode
+
+                    Repeater {
+                        model: controller ? controller.getAiLevelNames() : []
+
+                        Rectangle {
+                            required property int index
+                            required property string modelData
+                            property bool selected: controller && controller.aiLevel === index
+
+                            Layout.fillWidth: true
+                            height: 28
+                            radius: 5
+                            color: selected ? "#000000" : "#eeeeee"
+                            border.color: "gray"
+                            border.width: 1
+
+                            Text {
+                                text: parent.modelData
+                                font.pixelSize: 12
+                                font.bold: parent.selected
+                                color: parent.selected ? "white" : "black"
+                                anchors.centerIn: parent
+                            }
+
+                            TapHandler {
+                                onTapped: controller.aiLevel = parent.index
+                            }
+                        }
+                    }
+                }
+
+                // 搜索引擎：与难度一样在下一步生效
+                RowLayout {
+                    Layout.fillWidth: true
+                    spacing: 4
+                    visible: controller && controller.isAiMode
+
+                    Repeater {
+                        model: controller ? controller.getAiEngineNames() : []
+
+                        Rectangle {
+                            required property int index
+                            required property string modelData
+                            property bool selected: controller && controller.aiEngine === index
+
+                            Layout.fillWidth: true
+                            height: 28
+                            radius: 5
+                            color: selected ? "#000000" : "#eeeeee"
+                            border.color: "gray"
+                            border.width: 1
+
+                            Text {
+                                text: parent.modelData
+                                font.pixelSize: 12
+                                font.bold: parent.selected
+                                color: parent.selected ? "white" : "black"
+                                anchors.centerIn: parent
+                            }
+
+                            TapHandler {
+                                onTapped: controller.aiEngine = parent.index
+                            }
+                        }
+                    }
+                }
+
+                CustomButton {
+                    text: (controller && controller.analysisMode) ? "关闭分析" : "分析模式"
+                    onClicked: function() {
+                        if (controller) controller.toggleAnalysisMode()
+                    }
+                }
+
+                CustomButton {
+                    text: (controller && controller.explorerMode) ? "关闭棋谱库" : "棋谱库"
+                    onClicked: function() {
+                        if (controller) controller.toggleExplorerMode()
+                    }
+                }
+
                 CustomButton {
                     text: "重新开始"
                     onClicked: function() {
@@ -236,6 +322,48 @@ Window {
                     }
                 }
 
+                RowLayout {
+                    Layout.fillWidth: true
+                    spacing: 10
+
+                    CustomButton {
+                        text: "悔棋"
+                        opacity: controller && controller.ply > 0 ? 1.0 : 0.4
+                        onClicked: function() {
+                            if (controller) controller.undoMove()
+                        }
+                    }
+
+                    CustomButton {
+                        text: "重做"
+                        opacity: controller && controller.ply < controller.plyCount ? 1.0 : 0.4
+                        onClicked: function() {
+                            if (controller) controller.redoMove()
+                        }
+                    }
+                }
+
+                // 保存到默认对局库，载入库中最后一局
+                RowLayout {
+                    Layout.fillWidth: true
+                    spacing: 10
+
+                    CustomButton {
+                        text: "保存对局"
+                        opacity: controller && controller.ply > 0 ? 1.0 : 0.4
+                        onClicked: function() {
+                            if (controller && controller.ply > 0) controller.saveGame()
+                        }
+                    }
+
+                    CustomButton {
+                        text: "载入对局"
+                        onClicked: function() {
+                            if (controller) controller.loadGame()
+                        }
+                    }
+                }
+
                 CustomButton {
                     text: controller && controller.isEndgameMode ? "退出残局" : "残局挑战"
                     onClicked: function() {
@@ -268,6 +396,167 @@ Window {
                     }
                 }
 
+                // 连杀求解：轮到攻方时后台求解，可显示下一步提示
+                Rectangle {
+                    Layout.fillWidth: true
+                    height: 30
+                    color: "#fff8e1"
+                    radius: 5
+                    border.color: "#ffb300"
+                    border.width: 1
+                    visible: controller && controller.isEndgameMode
+
+                    RowLayout {
+                        anchors.fill: parent
+                        anchors.leftMargin: 8
+                        anchors.rightMargin: 8
+                        spacing: 5
+
+                        Text {
+                            Layout.fillWidth: true
+                            text: mateStatusText()
+                            font.pixelSize: 12
+                            color: "#8d6e63"
+                            font.bold: true
+
+                            function mateStatusText() {
+                                if (!controller) return ""
+                                if (controller.solverRunning) return "求解中..."
+                                if (controller.mateInMoves > 0) return controller.mateInMoves + "步杀"
+                                if (controller.currentPlayer !== controller.getEndgameFirstPlayer(controller.currentEndgameId)) return "等待应着"
+                                return "未找到连杀"
+                            }
+                        }
+
+                        Text {
+                            text: "提示"
+                            font.pixelSize: 12
+                            font.bold: true
+                            color: hintTapHandler.pressed ? "#cccccc" : "#1565c0"
+                            visible: controller && controller.mateHint.length === 4 && !controller.gameOver
+
+                            TapHandler {
+                                id: hintTapHandler
+                                onTapped: {
+                                    if (chessLoader.item) chessLoader.item.showHint = true
+                                }
+                            }
+                        }
+                    }
+                }
+
+                // 分析结果：前几条变例，分数为红方视角
+                Rectangle {
+                    Layout.fillWidth: true
+                    Layout.preferredHeight: 130
+                    color: "#f3f7ff"
+                    radius: 5
+                    border.color: "#90a4d4"
+                    border.width: 1
+                    visible: controller && controller.analysisMode
+
+                    ColumnLayout {
+                        anchors.fill: parent
+                        anchors.margins: 5
+                        spacing: 3
+
+                        Text {
+                            text: "分析  深度 " + (controller ? controller.analysis.depth : 0) +
+                                  ((controller && controller.analysis.running) ? "" : " (已停止)")
+                            font.bold: true
+                            font.pixelSize: 12
+                            Layout.alignment: Qt.AlignHCenter
+                        }
+
+                        ListView {
+                            Layout.fillWidth: true
+                            Layout.fillHeight: true
+                            clip: true
+                            spacing: 2
+                            model: controller ? controller.analysis : null
+                            delegate: Column {
+                                width: ListView.view.width
+
+                                Text {
+                                    text: model.rank + ". " + model.scoreText
+                                    font.pixelSize: 11
+                                    font.bold: true
+                                    color: model.score >= 0 ? "#c62828" : "#212121"
+                                }
+
+                                Text {
+                                    width: parent.width
+                                    text: model.pv
+                                    font.pixelSize: 10
+                                    color: "#555555"
+                                    elide: Text.ElideRight
+                                }
+                            }
+                        }
+                    }
+                }
+
+                // 开局浏览器：对局库中当前局面之后的着法，点击走出该着
+                Rectangle {
+                    Layout.fillWidth: true
+                    Layout.preferredHeight: 130
+                    color: "#f6fbf2"
+                    radius: 5
+                    border.color: "#8fbf7a"
+                    border.width: 1
+                    visible: controller && controller.explorerMode
+
+                    ColumnLayout {
+                        anchors.fill: parent
+                        anchors.margins: 5
+                        spacing: 3
+
+                        Text {
+                            text: controller ? ("棋谱库  本局面 " + controller.explorer.totalGames + " 局 / 共 " +
+                                                controller.explorer.databaseGames + " 局" +
+                                                (controller.explorer.indexing ? " (索引中)" : "")) : ""
+                            font.bold: true
+                            font.pixelSize: 12
+                            Layout.alignment: Qt.AlignHCenter
+                        }
+
+                        ListView {
+                            Layout.fillWidth: true
+                            Layout.fillHeight: true
+                            clip: true
+                            spacing: 2
+                            model: controller ? controller.explorer : null
+                            delegate: Row {
+                                width: ListView.view.width
+                                spacing: 6
+
+                                Text {
+                                    width: 50
+                                    text: model.move
+                                    font.pixelSize: 11
+                                    font.bold: true
+                                }
+
+                                Text {
+                                    width: 40
+                                    text: model.games + "局"
+                                    font.pixelSize: 11
+                                }
+
+                                Text {
+                                    text: model.scoreText
+                                    font.pixelSize: 10
+                                    color: "#555555"
+                                }
+
+                                TapHandler {
+                                    onTapped: controller.playMove(model.iccs)
+                                }
+                            }
+                        }
+                    }
+                }
+
                 Rectangle {
                     Layout.fillWidth: true
                     Layout.fillHeight: true
@@ -362,14 +651,14 @@ Window {
                 spacing: 15
 
                 Text {
-                    text: (controller && controller.gameOver && controller.winner && controller.isCheck) ? (controller.isCheckMate ? "绝杀!" : "将军!") : "游戏结束"
+                    text: (controller && controller.gameOver && controller.isStalemate) ? "困毙!" : (controller && controller.gameOver && controller.winner && controller.isCheck) ? (controller.isCheckMate ? "绝杀!" : "将军!") : "游戏结束"
                     font.pixelSize: 24
                     font.bold: true
                     Layout.alignment: Qt.AlignHCenter
                 }
 
                 Text {
-                    text: (controller ? controller.winner : "红") + "方胜利！"
+                    text: (controller && controller.winner === "") ? "和棋" : (controller ? controller.winner : "红") + "方胜利！"
                     font.pixelSize: 20
                     color: (controller && controller.winner === "红") ? "red" : "black"
                     font.bold: true
@@ -416,8 +705,8 @@ Window {
         z: 15
 
         Rectangle {
-            width: 400
-            height: 300
+            width: 480
+            height: 460
             radius: 10
             color: "white"
             border.color: "gray"
@@ -427,7 +716,7 @@ Window {
             ColumnLayout {
                 anchors.fill: parent
                 anchors.margins: 20
-                spacing: 15
+                spacing: 10
 
                 Text {
                     text: "选择残局挑战"
@@ -436,13 +725,61 @@ Window {
                     Layout.alignment: Qt.AlignHCenter
                 }
 
+                // 过滤条件：直接写入残局浏览模型，结果分页加载
+                RowLayout {
+                    Layout.fillWidth: true
+                    spacing: 8
+
+                    TextField {
+                        Layout.fillWidth: true
+                        placeholderText: "搜索名称或说明"
+                        onTextChanged: if (controller) controller.endgames.filterText = text
+                    }
+
+                    TextField {
+                        Layout.preferredWidth: 90
+                        placeholderText: "子力 如KRRv"
+                        onTextChanged: if (controller) controller.endgames.material = text
+                    }
+                }
+
+                RowLayout {
+                    Layout.fillWidth: true
+                    spacing: 8
+
+                    ComboBox {
+                        Layout.fillWidth: true
+                        model: ["全部难度", "难度 1", "难度 2", "难度 3", "难度 4", "难度 5"]
+                        onCurrentIndexChanged: if (controller) controller.endgames.difficulty = currentIndex
+                    }
+
+                    ComboBox {
+                        Layout.fillWidth: true
+                        model: ["双方先行", "红先", "黑先"]
+                        onCurrentIndexChanged: if (controller) controller.endgames.side = currentIndex - 1
+                    }
+
+                    ComboBox {
+                        Layout.fillWidth: true
+                        model: ["全部", "已完成", "未完成"]
+                        onCurrentIndexChanged: if (controller) controller.endgames.solvedFilter = currentIndex
+                    }
+                }
+
+                Text {
+                    text: controller ? ("共 " + controller.endgames.matchCount + " / "
+                                        + controller.endgames.totalCount + " 局") : ""
+                    font.pixelSize: 12
+                    color: "#666666"
+                }
+
                 ScrollView {
                     Layout.fillWidth: true
                     Layout.fillHeight: true
                     clip: true
                     
                     ListView {
-                        model: controller ? controller.getEndgameList() : []
+                        model: controller ? controller.endgames : null
                         spacing: 10
                         delegate: Rectangle {
                             width: parent.width
@@ -462,14 +799,14 @@ Window {
                                     spacing: 5
                                     
                                     Text {
-                                        text: modelData
+                                        text: (solved ? "✓ " : "") + name + "  " + side + "先"
                                         font.pixelSize: 18
                                         font.bold: true
                                         color: "#333333"
                                     }
                                     
                                     Text {
-                                        text: controller ? controller.getEndgameDescription(modelData) : ""
+                                        text: description
                                         font.pixelSize: 12
                                         color: "#666666"
                                         wrapMode: Text.WordWrap
@@ -480,10 +817,10 @@ Window {
                                     width: 60
                                     height: 25
                                     radius: 12
-                                    color: getDifficultyColor(controller ? controller.getEndgameDifficulty(modelData) : 1)
+                                    color: getDifficultyColor(difficulty)
                                     
                                     Text {
-                                        text: "难度 " + (controller ? controller.getEndgameDifficulty(modelData) : 1)
+                                        text: "难度 " + difficulty
                                         font.pixelSize: 10
                                         color: "white"
                                         font.bold: true
@@ -509,7 +846,7 @@ Window {
                                 hoverEnabled: true
                                 onClicked: {
                                     if (controller) {
-                                        controller.startEndgame(modelData)
+                                        controller.startEndgame(endgameId)
                                         endgameSelector.visible = false
                                     }
                                 }
@@ -0,0 +1,186 @@
+#include "MateSolver.h"
+#include <algorithm>
+
+MateSolver::MateSolver(int tableBits)
+    : m_table(size_t(1) << tableBits)
+    , m_mask((uint64_t(1) << tableBits) - 1)
+{}
+
+MateSolver::Entry* MateSolver::probe(uint64_t key)
+{
+    Entry& entry = m_table[key & m_mask];
+    return entry.key == key ? &entry : nullptr;
+}
+
+const MateSolver::Entry* MateSolver::probe(uint64_t key) const
+{
+    const Entry& entry = m_table[key & m_mask];
+    return entry.key == key ? &entry : nullptr;
+}
+
+MateSolver::Node MateSolver::lookup(uint64_t key, bool attacker) const
+{
+    const Entry* entry = probe(key);
+    if (!entry) return { 1, 1 };
+    return attacker ? Node{ entry->pn, entry->dn } : Node{ entry->dn, entry->pn };
+}
+
+void MateSolver::store(uint64_t key, bool attacker, Node node, uint16_t distance)
+{
+    Entry& entry = m_table[key & m_mask];
+    entry.key = key;
+    entry.pn = attacker ? node.phi : node.delta;
+    entry.dn = attacker ? node.delta : node.phi;
+    entry.distance = distance;
+}
+
+bool MateSolver::onPath(uint64_t key, int ply) const
+{
+    // 只有同一方行棋的祖先局面才可能相同
+    for (int i = ply - 1; i >= 0; i -= 2) {
+        if (m_keyHistory[i] == key) return true;
+    }
+    return false;
+}
+
+int MateSolver::generateChildren(Position& pos, bool attacker, Move* moves)
+{
+    int count = pos.generateLegalMoves(moves);
+    if (!attacker) return count;
+
+    // 攻方只保留将军的着法
+    const int defender = pos.sideToMove() ^ 1;
+    int checks = 0;
+    for (int i = 0; i < count; ++i) {
+        uint8_t captured = pos.makeMove(moves[i]);
+        bool check = pos.isInCheck(defender);
+        pos.unmakeMove(moves[i], captured);
+        if (check) moves[checks++] = moves[i];
+    }
+    return checks;
+}
+
+void MateSolver::search(Position& pos, int ply, uint32_t thPhi, uint32_t thDelta)
+{
+    if (m_aborted) return;
+    if (++m_nodes > m_maxNodes || ((m_nodes & 1023) == 0 && m_stop && m_stop->load())) {
+        m_aborted = true;
+        return;
+    }
+
+    const bool attacker = pos.sideToMove() == m_attacker;
+    const uint64_t key = pos.key();
+    m_keyHistory[ply] = key;
+
+    Move moves[MAX_MOVES];
+    const int count = generateChildren(pos, attacker, moves);
+    if (count == 0) {
+        // 攻方无将可走即证明失败，守方无子可动即被杀，都是行棋方输
+        store(key, attacker, { kInfinity, 0 }, 0);
+        return;
+    }
+
+    uint64_t childKeys[MAX_MOVES];
+    for (int i = 0; i < count; ++i) {
+        uint8_t captured = pos.makeMove(moves[i]);
+        childKeys[i] = pos.key();
+        pos.unmakeMove(moves[i], captured);
+    }
+
+    for (;;) {
+        uint32_t phi = kInfinity;
+        uint64_t deltaSum = 0;
+        int best = 0;
+        uint32_t bestChildPhi = 0;
+        uint32_t secondDelta = kInfinity;
+        for (int i = 0; i < count; ++i) {
+            Node child;
+            if (ply + 1 >= kMaxPly || onPath(childKeys[i], ply + 1)) {
+                // 长将或超出深度：攻方失败
+                child = attacker ? Node{ 0, kInfinity } : Node{ kInfinity, 0 };
+            } else {
+                child = lookup(childKeys[i], !attacker);
+            }
+            deltaSum += child.phi;
+            if (child.delta < phi) {
+                secondDelta = phi;
+                phi = child.delta;
+                best = i;
+                bestChildPhi = child.phi;
+            } else if (child.delta < secondDelta) {
+                secondDelta = child.delta;
+            }
+        }
+        const uint32_t delta = uint32_t(std::min<uint64_t>(deltaSum, kInfinity));
+
+        if (phi >= thPhi || delta >= thDelta) {
+            // 证明成功时记录杀棋步数：攻方取最短，守方取最长
+            uint16_t distance = 0;
+            const bool proven = attacker ? phi == 0 : delta == 0;
+            if (proven) {
+                int shortest = kMaxPly, longest = 0;
+                for (int i = 0; i < count; ++i) {
+                    const Entry* entry = probe(childKeys[i]);
+                    if (!entry || entry->pn != 0) continue;
+                    shortest = std::min<int>(shortest, entry->distance);
+                    longest = std::max<int>(longest, entry->distance);
+                }
+                distance = uint16_t(1 + (attacker ? shortest : longest));
+            }
+            store(key, attacker, { phi, delta }, distance);
+            return;
+        }
+
+        const int64_t childThPhi = int64_t(thDelta) - int64_t(delta) + int64_t(bestChildPhi);
+        const uint32_t childThDelta = std::min<uint64_t>(thPhi, uint64_t(secondDelta) + 1);
+        uint8_t captured = pos.makeMove(moves[best]);
+        search(pos, ply + 1, uint32_t(std::clamp<int64_t>(childThPhi, 0, kInfinity)), childThDelta);
+        pos.unmakeMove(moves[best], captured);
+        if (m_aborted) return;
+    }
+}
+
+MateResult MateSolver::solve(const Position& root, uint64_t maxNodes, const std::atomic<bool>* stop)
+{
+    std::fill(m_table.begin(), m_table.end(), Entry());
+    m_nodes = 0;
+    m_maxNodes = maxNodes;
+    m_stop = stop;
+    m_aborted = false;
+    m_attacker = root.sideToMove();
+
+    Position pos = root;
+    search(pos, 0, kInfinity, kInfinity);
+
+    MateResult result;
+    result.nodes = m_nodes;
+    result.aborted = m_aborted;
+    const Entry* rootEntry = probe(root.key());
+    if (m_aborted || !rootEntry || rootEntry->pn != 0) return result;
+
+    result.found = true;
+    result.mateInMoves = (rootEntry->distance + 1) / 2;
+
+    // 沿证明树提取杀法：攻方走最短的杀，守方走最顽强的应着
+    Move moves[MAX_MOVES];
+    for (int ply = 0; ply < kMaxPly; ++ply) {
+        const bool attacker = pos.sideToMove() == m_attacker;
+        const int count = generateChildren(pos, attacker, moves);
+        Move chosen = NO_MOVE;
+        int chosenDistance = attacker ? kMaxPly + 1 : -1;
+        for (int i = 0; i < count; ++i) {
+            uint8_t captured = pos.makeMove(moves[i]);
+            const Entry* entry = probe(pos.key());
+            pos.unmakeMove(moves[i], captured);
+            if (!entry || entry->pn != 0) continue;
+            if (attacker ? entry->distance < chosenDistance : entry->distance > chosenDistance) {
+                chosen = moves[i];
+                chosenDistance = entry->distance;
+            }
+        }
+        if (chosen == NO_MOVE) break;
+        result.pv.push_back(chosen);
+        pos.makeMove(chosen);
+    }
+    return result;
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "Position.h"
+
+// 连杀求解结果：mateInMoves为攻方步数（回合），pv为完整杀法
+struct MateResult {
+    bool found = false;
+    bool aborted = false;     // 超出节点上限或被中止
+    int mateInMoves = 0;
+    std::vector<Move> pv;
+    uint64_t nodes = 0;
+};
+
+// 杀棋求解器：深度优先证明数搜索(df-pn)
+// 攻方只走将军的着法，守方考虑全部应着；守方无子可动（将死或困毙）即证明成功
+// 攻方重复局面视为长将，按亚洲规则判攻方失败
+class MateSolver
+{
+public:
+    explicit MateSolver(int tableBits = 20);
+
+    MateResult solve(const Position& root, uint64_t maxNodes = 5000000,
+                     const std::atomic<bool>* stop = nullptr);
+
+    static constexpr int kMaxPly = 127;
+
+private:
+    static constexpr uint32_t kInfinity = 100000000;
+
+    struct Entry {
+        uint64_t key = 0;
+        uint32_t pn = 1;
+        uint32_t dn = 1;
+        uint16_t distance = 0;   // 已证明局面到杀棋的步数(半回合)
+    };
+
+    // 以当前行棋方视角：phi为本节点需证明的数，delta为对手的数
+    struct Node {
+        uint32_t phi;
+        uint32_t delta;
+    };
+
+    void search(Position& pos, int ply, uint32_t thPhi, uint32_t thDelta);
+    int generateChildren(Position& pos, bool attacker, Move* moves);
+    Node lookup(uint64_t key, bool attacker) const;
+    void store(uint64_t key, bool attacker, Node node, uint16_t distance);
+    Entry* probe(uint64_t key);
+    const Entry* probe(uint64_t key) const;
+    bool onPath(uint64_t key, int ply) const;
+
+    std::vector<Entry> m_table;
+    uint64_t m_mask;
+    uint64_t m_keyHistory[kMaxPly + 2];
+    uint64_t m_nodes = 0;
+    uint64_t m_maxNodes = 0;
+    const std::atomic<bool>* m_stop = nullptr;
+    bool m_aborted = false;
+    int m_attacker = SIDE_RED;
+};
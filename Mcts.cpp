@@ -0,0 +1,413 @@
+#include "Mcts.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <thread>
+
+namespace {
+
+enum NodeState : uint8_t {
+    NodeLeaf,
+    NodeExpanding,
+    NodeExpanded,
+    NodeTerminal       // 行棋方无着可走（将死或困毙），判负
+};
+
+const int kPieceValues[8] = { 0, 0, 150, 150, 300, 500, 300, 100 };
+
+const double kCpuct = 1.5;
+const double kFpuReduction = 0.2;      // 未访问子节点的胜率取父节点胜率减去此值
+const uint32_t kExpandVisits = 2;      // 访问到第几次时展开
+const int kRolloutPlies = 24;
+const double kEvalScale = 300.0;       // 分差与胜率的换算：1 / (1 + exp(-分 / kEvalScale))
+const double kValueUnit = 65536.0;     // 胜率累加使用的定点单位
+
+int64_t nowMs()
+{
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+double winProbability(int score)
+{
+    return 1.0 / (1.0 + std::exp(-score / kEvalScale));
+}
+
+int scoreOf(double probability)
+{
+    const double p = std::clamp(probability, 0.001, 0.999);
+    const int score = int(std::lround(kEvalScale * std::log(p / (1.0 - p))));
+    return std::clamp(score, -Searcher::kWinValue + 1, Searcher::kWinValue - 1);
+}
+
+} // namespace
+
+struct MctsSearcher::Node {
+    std::atomic<uint32_t> visits{ 0 };
+    std::atomic<int32_t> virtualLoss{ 0 };
+    std::atomic<int64_t> valueSum{ 0 };     // 以走入本节点的一方为视角的胜率之和（定点）
+    std::atomic<uint8_t> state{ NodeLeaf };
+    Move move = NO_MOVE;
+    uint16_t childCount = 0;
+    uint32_t firstChild = 0;
+    float prior = 0;
+
+    // 子节点的字段在父节点置为NodeExpanded之前写好，之后只读
+    void reset(Move m, float p)
+    {
+        visits.store(0, std::memory_order_relaxed);
+        virtualLoss.store(0, std::memory_order_relaxed);
+        valueSum.store(0, std::memory_order_relaxed);
+        state.store(NodeLeaf, std::memory_order_relaxed);
+        move = m;
+        childCount = 0;
+        firstChild = 0;
+        prior = p;
+    }
+};
+
+struct MctsSearcher::Worker {
+    std::mt19937 rng;
+    std::vector<uint32_t> path;
+    std::vector<uint64_t> keys;     // 本次下行经过的局面键值
+};
+
+MctsSearcher::MctsSearcher(int threads, int treeBits)
+    : m_threads(std::max(1, threads))
+    , m_capacity(size_t(1) << treeBits)
+{}
+
+MctsSearcher::~MctsSearcher() = default;
+
+void MctsSearcher::setThreads(int threads)
+{
+    m_threads = std::max(1, threads);
+}
+
+void MctsSearcher::clearTree()
+{
+    m_used.store(0);
+    m_root = 0;
+}
+
+SearchResult MctsSearcher::search(const Position& root, const std::vector<HistoryEntry>& history,
+                                  const SearchLimits& limits, const std::atomic<bool>* stop)
+{
+    SearchResult result;
+    Position pos = root;
+    Move moves[MAX_MOVES];
+    const int count = pos.generateLegalMoves(moves);
+    if (count == 0) return result;
+    if (count == 1) {
+        // 只有一着可走，不必搜索
+        result.bestMove = moves[0];
+        result.pv = { moves[0] };
+        result.lines.push_back({ 0, result.pv });
+        return result;
+    }
+
+    if (!m_nodes) m_nodes.reset(new Node[m_capacity]);
+    reuseTree(root);
+
+    // 最后一次吃子之前的局面不可能重复
+    m_historyKeys.clear();
+    for (int i = int(history.size()) - 1; i >= 0; --i) {
+        m_historyKeys.push_back(history[i].key);
+        if (history[i].capture) break;
+    }
+    if (history.empty()) m_historyKeys.push_back(root.key());
+
+    m_limits = limits;
+    m_stop = stop;
+    m_deadline = limits.timeMs > 0 ? nowMs() + limits.timeMs : 0;
+    m_playouts.store(0);
+    m_done.store(false);
+
+    std::random_device seed;
+    std::vector<Worker> workers(m_threads);
+    for (Worker& worker : workers)
+        worker.rng.seed(seed());
+    std::vector<std::thread> threads;
+    for (int i = 1; i < m_threads; ++i)
+        threads.emplace_back([this, &workers, i]() { runWorker(workers[i]); });
+    runWorker(workers[0]);
+    for (std::thread& thread : threads)
+        thread.join();
+
+    fillResult(result, std::max(1, limits.multiPv));
+    return result;
+}
+
+void MctsSearcher::runWorker(Worker& worker)
+{
+    while (!m_done.load(std::memory_order_relaxed)) {
+        playout(worker);
+        const uint64_t playouts = m_playouts.fetch_add(1, std::memory_order_relaxed) + 1;
+        if ((m_limits.nodes && playouts >= m_limits.nodes)
+            || (m_stop && m_stop->load(std::memory_order_relaxed))
+            || ((playouts & 63) == 0 && timeUp()))
+            m_done.store(true, std::memory_order_relaxed);
+    }
+}
+
+bool MctsSearcher::timeUp() const
+{
+    return m_deadline && nowMs() >= m_deadline;
+}
+
+void MctsSearcher::playout(Worker& worker)
+{
+    Position pos = m_rootPos;
+    worker.path.assign(1, m_root);
+    worker.keys.clear();
+
+    // 下行到叶节点；value为叶节点局面行棋方的胜率
+    Node* node = &m_nodes[m_root];
+    double value;
+    for (;;) {
+        uint8_t state = node->state.load(std::memory_order_acquire);
+        if (state == NodeTerminal) {
+            value = 0.0;
+            break;
+        }
+        if (state != NodeExpanded) {
+            const bool wantExpand = state == NodeLeaf
+                && (node == &m_nodes[m_root] || node->visits.load(std::memory_order_relaxed) >= kExpandVisits);
+            // 其他线程正在展开或节点池已满时，直接从该节点随机走子
+            if (wantExpand && node->state.compare_exchange_strong(state, NodeExpanding) && expand(*node, pos))
+                continue;
+            value = rollout(worker, pos);
+            break;
+        }
+
+        Node& child = m_nodes[selectChild(*node)];
+        child.virtualLoss.fetch_add(1, std::memory_order_relaxed);
+        pos.makeMove(child.move);
+        worker.path.push_back(uint32_t(&child - m_nodes.get()));
+        node = &child;
+        if (isRepetition(worker, pos.key())) {
+            value = 0.5;
+            break;
+        }
+        worker.keys.push_back(pos.key());
+    }
+
+    // 回传：每个节点记录走入该节点一方的胜率
+    for (size_t i = worker.path.size(); i-- > 0;) {
+        Node& n = m_nodes[worker.path[i]];
+        n.valueSum.fetch_add(int64_t((1.0 - value) * kValueUnit), std::memory_order_relaxed);
+        n.visits.fetch_add(1, std::memory_order_relaxed);
+        if (i > 0) n.virtualLoss.fetch_sub(1, std::memory_order_relaxed);
+        value = 1.0 - value;
+    }
+}
+
+uint32_t MctsSearcher::selectChild(const Node& node) const
+{
+    const uint32_t parentVisits = node.visits.load(std::memory_order_relaxed)
+                                + uint32_t(node.virtualLoss.load(std::memory_order_relaxed));
+    const double sqrtVisits = std::sqrt(double(std::max<uint32_t>(1, parentVisits)));
+    // 父节点存的是对手视角的胜率
+    const double parentValue = parentVisits
+        ? 1.0 - node.valueSum.load(std::memory_order_relaxed) / kValueUnit / std::max<uint32_t>(1, node.visits.load())
+        : 0.5;
+    const double firstPlayValue = std::max(0.0, parentValue - kFpuReduction);
+
+    uint32_t best = node.firstChild;
+    double bestScore = -1.0;
+    for (uint32_t i = node.firstChild; i < node.firstChild + node.childCount; ++i) {
+        const Node& child = m_nodes[i];
+        // 虚拟败局按未取得胜率的访问计入
+        const uint32_t visits = child.visits.load(std::memory_order_relaxed)
+                              + uint32_t(child.virtualLoss.load(std::memory_order_relaxed));
+        const double q = visits ? child.valueSum.load(std::memory_order_relaxed) / kValueUnit / visits
+                                : firstPlayValue;
+        const double score = q + kCpuct * child.prior * sqrtVisits / (1 + visits);
+        if (score > bestScore) {
+            bestScore = score;
+            best = i;
+        }
+    }
+    return best;
+}
+
+bool MctsSearcher::expand(Node& node, Position& pos)
+{
+    Move moves[MAX_MOVES];
+    const int count = pos.generateLegalMoves(moves);
+    if (count == 0) {
+        node.state.store(NodeTerminal, std::memory_order_release);
+        return true;
+    }
+
+    uint32_t first = m_used.load();
+    do {
+        if (first + count > m_capacity) {
+            node.state.store(NodeLeaf, std::memory_order_release);
+            return false;
+        }
+    } while (!m_used.compare_exchange_weak(first, first + count));
+
+    // 先验：吃子按被吃子的价值加权，将军加倍
+    double weights[MAX_MOVES];
+    double total = 0;
+    const int side = pos.sideToMove();
+    for (int i = 0; i < count; ++i) {
+        const uint8_t victim = pos.pieceAt(moveTo(moves[i]));
+        double weight = std::exp(kPieceValues[pieceType(victim)] / 200.0);
+        const uint8_t captured = pos.makeMove(moves[i]);
+        if (pos.isInCheck(side ^ 1)) weight *= 2.0;
+        pos.unmakeMove(moves[i], captured);
+        weights[i] = weight;
+        total += weight;
+    }
+    for (int i = 0; i < count; ++i)
+        m_nodes[first + i].reset(moves[i], float(weights[i] / total));
+
+    node.firstChild = first;
+    node.childCount = uint16_t(count);
+    node.state.store(NodeExpanded, std::memory_order_release);
+    return true;
+}
+
+double MctsSearcher::rollout(Worker& worker, Position& pos) const
+{
+    const int leafSide = pos.sideToMove();
+    Move moves[MAX_MOVES];
+    int weights[MAX_MOVES];
+
+    for (int ply = 0; ply < kRolloutPlies; ++ply) {
+        const int count = pos.generateMoves(moves);
+        int total = 0;
+        for (int i = 0; i < count; ++i) {
+            weights[i] = 1 + kPieceValues[pieceType(pos.pieceAt(moveTo(moves[i])))] / 50;
+            total += weights[i];
+        }
+
+        // 按权重抽取伪合法着法，送将的着法剔除后重抽
+        const int side = pos.sideToMove();
+        bool moved = false;
+        while (total > 0) {
+            int r = int(worker.rng() % uint32_t(total));
+            int i = 0;
+            while (r >= weights[i]) r -= weights[i++];
+            const uint8_t captured = pos.makeMove(moves[i]);
+            if (!pos.isInCheck(side)) {
+                moved = true;
+                break;
+            }
+            pos.unmakeMove(moves[i], captured);
+            total -= weights[i];
+            weights[i] = 0;
+        }
+        if (!moved)
+            return side == leafSide ? 0.0 : 1.0;
+    }
+
+    const double value = winProbability(evaluatePosition(pos));
+    return pos.sideToMove() == leafSide ? value : 1.0 - value;
+}
+
+bool MctsSearcher::isRepetition(const Worker& worker, uint64_t key) const
+{
+    return std::find(worker.keys.begin(), worker.keys.end(), key) != worker.keys.end()
+        || std::find(m_historyKeys.begin(), m_historyKeys.end(), key) != m_historyKeys.end();
+}
+
+void MctsSearcher::reuseTree(const Position& root)
+{
+    // 节点池只增不减，用掉大半后从头建树
+    uint32_t found = UINT32_MAX;
+    if (m_used.load() > 0 && m_used.load() <= m_capacity * 3 / 4) {
+        if (m_rootPos.key() == root.key()) {
+            found = m_root;
+        } else {
+            // 上次的根之后走了一步或两步（AI一着、对手一着）
+            const Node& rootNode = m_nodes[m_root];
+            if (rootNode.state.load() == NodeExpanded) {
+                Position pos = m_rootPos;
+                for (uint32_t i = rootNode.firstChild; found == UINT32_MAX && i < rootNode.firstChild + rootNode.childCount; ++i) {
+                    const Node& child = m_nodes[i];
+                    const uint8_t captured = pos.makeMove(child.move);
+                    if (pos.key() == root.key()) {
+                        found = i;
+                    } else if (child.state.load() == NodeExpanded) {
+                        for (uint32_t j = child.firstChild; j < child.firstChild + child.childCount; ++j) {
+                            const uint8_t replyCaptured = pos.makeMove(m_nodes[j].move);
+                            const bool match = pos.key() == root.key();
+                            pos.unmakeMove(m_nodes[j].move, replyCaptured);
+                            if (match) {
+                                found = j;
+                                break;
+                            }
+                        }
+                    }
+                    pos.unmakeMove(child.move, captured);
+                }
+            }
+        }
+    }
+
+    if (found == UINT32_MAX) {
+        m_nodes[0].reset(NO_MOVE, 1.0f);
+        m_used.store(1);
+        found = 0;
+    }
+    m_root = found;
+    m_rootPos = root;
+}
+
+void MctsSearcher::fillResult(SearchResult& result, int multiPv) const
+{
+    const Node& root = m_nodes[m_root];
+    result.nodes = m_playouts.load();
+    if (root.state.load() != NodeExpanded) return;
+
+    std::vector<uint32_t> children;
+    for (uint32_t i = root.firstChild; i < root.firstChild + root.childCount; ++i)
+        if (m_nodes[i].visits.load() > 0)
+            children.push_back(i);
+    std::sort(children.begin(), children.end(), [this](uint32_t a, uint32_t b) {
+        return m_nodes[a].visits.load() > m_nodes[b].visits.load();
+    });
+    if (children.size() > size_t(multiPv)) children.resize(multiPv);
+
+    for (uint32_t index : children) {
+        const Node& child = m_nodes[index];
+        SearchLine line;
+        // 子节点无着可走即一步杀
+        line.score = child.state.load() == NodeTerminal
+            ? Searcher::kMateValue - 1
+            : scoreOf(child.valueSum.load() / kValueUnit / child.visits.load());
+        line.pv = principalVariation(index);
+        result.lines.push_back(std::move(line));
+    }
+    if (result.lines.empty()) return;
+
+    result.bestMove = result.lines.front().pv.front();
+    result.score = result.lines.front().score;
+    result.pv = result.lines.front().pv;
+    result.depth = int(result.pv.size());
+}
+
+std::vector<Move> MctsSearcher::principalVariation(uint32_t index) const
+{
+    std::vector<Move> pv;
+    for (;;) {
+        const Node& node = m_nodes[index];
+        pv.push_back(node.move);
+        if (node.state.load() != NodeExpanded || pv.size() >= size_t(Searcher::kMaxPly)) break;
+
+        uint32_t best = UINT32_MAX, bestVisits = 0;
+        for (uint32_t i = node.firstChild; i < node.firstChild + node.childCount; ++i) {
+            if (m_nodes[i].visits.load() > bestVisits) {
+                bestVisits = m_nodes[i].visits.load();
+                best = i;
+            }
+        }
+        if (best == UINT32_MAX) break;
+        index = best;
+    }
+    return pv;
+}
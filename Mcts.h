@@ -0,0 +1,63 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "Position.h"
+#include "Search.h"
+
+// 蒙特卡洛树搜索（PUCT）：alpha-beta之外的另一种选着方式
+// 叶节点做一局短的随机走子（吃子按子力加权），走到步数上限后按子力估值换算成胜率
+// 多线程共享一棵树：下行时给经过的节点加虚拟败局，避免各线程挤在同一条变例上；
+// 节点在第二次访问时展开，先验概率偏向吃子
+// 树在两次搜索之间保留：新的根局面是上次根局面的子或孙节点时接着用该子树
+// 重复局面按和棋计（不区分长将长捉），与Searcher的规则相比是简化的
+class MctsSearcher
+{
+public:
+    // treeBits：节点池容量的对数，节点用完后新叶节点只做随机走子、不再展开
+    explicit MctsSearcher(int threads = 1, int treeBits = 21);
+    ~MctsSearcher();
+
+    void setThreads(int threads);
+    int threads() const { return m_threads; }
+
+    // limits.nodes为随机走子的局数上限，depth不使用；multiPv按访问次数取前几个根着法
+    // 返回的score由胜率换算为分（兵=100），nodes为随机走子局数
+    SearchResult search(const Position& root, const std::vector<HistoryEntry>& history,
+                        const SearchLimits& limits, const std::atomic<bool>* stop = nullptr);
+
+    // 丢弃整棵树（新对局时调用）
+    void clearTree();
+
+private:
+    struct Node;
+    struct Worker;
+
+    void runWorker(Worker& worker);
+    void playout(Worker& worker);
+    uint32_t selectChild(const Node& node) const;
+    bool expand(Node& node, Position& pos);
+    double rollout(Worker& worker, Position& pos) const;
+    bool isRepetition(const Worker& worker, uint64_t key) const;
+    // 在上次的树中找到root，找不到时清空
+    void reuseTree(const Position& root);
+    void fillResult(SearchResult& result, int multiPv) const;
+    std::vector<Move> principalVariation(uint32_t index) const;
+    bool timeUp() const;
+
+    int m_threads;
+    size_t m_capacity;
+    std::unique_ptr<Node[]> m_nodes;         // 首次搜索时分配
+    std::atomic<uint32_t> m_used{ 0 };
+    uint32_t m_root = 0;
+    Position m_rootPos;
+
+    // 对局历史中最后一次吃子之后的键值，用于判断重复
+    std::vector<uint64_t> m_historyKeys;
+    SearchLimits m_limits;
+    const std::atomic<bool>* m_stop = nullptr;
+    int64_t m_deadline = 0;
+    std::atomic<uint64_t> m_playouts{ 0 };
+    std::atomic<bool> m_done{ false };
+};
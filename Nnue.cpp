@@ -0,0 +1,379 @@
+#include "Nnue.h"
+#include <QCoreApplication>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+#include "Simd.h"
+
+namespace {
+
+// 文件头：魔数、版本、kL1、kL2，共16字节
+const char kNetMagic[4] = { 'X', 'Q', 'N', 'N' };
+const quint32 kNetVersion = 1;
+const qint64 kHeaderSize = 16;
+const qint64 kSectionAlign = 64;
+
+constexpr int kInputs = 2 * NnueNetwork::kL1;
+
+// 各段在文件中的偏移
+struct Layout {
+    qint64 featureBias;
+    qint64 featureWeights;
+    qint64 hiddenBias;
+    qint64 hiddenWeights;
+    qint64 outputBias;
+    qint64 outputWeights;
+    qint64 size;
+};
+
+Layout fileLayout()
+{
+    qint64 offset = kHeaderSize;
+    auto section = [&offset](qint64 bytes) {
+        offset = (offset + kSectionAlign - 1) / kSectionAlign * kSectionAlign;
+        const qint64 start = offset;
+        offset += bytes;
+        return start;
+    };
+    Layout layout;
+    layout.featureBias = section(NnueNetwork::kL1 * 2);
+    layout.featureWeights = section(qint64(NnueNetwork::kFeatures) * NnueNetwork::kL1 * 2);
+    layout.hiddenBias = section(NnueNetwork::kL2 * 4);
+    layout.hiddenWeights = section(NnueNetwork::kL2 * kInputs);
+    layout.outputBias = section(4);
+    layout.outputWeights = section(NnueNetwork::kL2);
+    layout.size = offset;
+    return layout;
+}
+
+// ===== 计算核心：按指令集各实现一份，运行时选用 =====
+// 累加器更新：out = in - sub1 + add1 (- sub2)，sub2可为空
+// 输入变换：两方累加器截断到[0, 127]后拼成隐藏层输入
+// 隐藏层：output[o] = bias[o] + Σ input[i] * weights[o][i]
+// input在[0, 127]，weights在[-128, 127]，相邻两项之和不超过int16，AVX2的饱和乘加不会溢出
+struct Kernels {
+    void (*addRow)(int16_t* values, const int16_t* weights);
+    void (*updateRow)(int16_t* out, const int16_t* in, const int16_t* sub1, const int16_t* add1, const int16_t* sub2);
+    void (*transform)(const int16_t* us, const int16_t* them, uint8_t* input);
+    void (*affine)(const uint8_t* input, const int8_t* weights, const int32_t* bias, int32_t* output);
+};
+
+constexpr int kL1 = NnueNetwork::kL1;
+
+void addRowScalar(int16_t* values, const int16_t* weights)
+{
+    for (int i = 0; i < kL1; ++i)
+        values[i] += weights[i];
+}
+
+void updateRowScalar(int16_t* out, const int16_t* in, const int16_t* sub1, const int16_t* add1, const int16_t* sub2)
+{
+    for (int i = 0; i < kL1; ++i)
+        out[i] = int16_t(in[i] - sub1[i] + add1[i] - (sub2 ? sub2[i] : 0));
+}
+
+void transformScalar(const int16_t* us, const int16_t* them, uint8_t* input)
+{
+    for (int i = 0; i < kL1; ++i) {
+        input[i] = uint8_t(std::clamp<int>(us[i], 0, 127));
+        input[kL1 + i] = uint8_t(std::clamp<int>(them[i], 0, 127));
+    }
+}
+
+void affineScalar(const uint8_t* input, const int8_t* weights, const int32_t* bias, int32_t* output)
+{
+    for (int o = 0; o < NnueNetwork::kL2; ++o) {
+        const int8_t* row = weights + o * kInputs;
+        int32_t sum = bias[o];
+        for (int i = 0; i < kInputs; ++i)
+            sum += int32_t(input[i]) * row[i];
+        output[o] = sum;
+    }
+}
+
+const Kernels kScalarKernels = { addRowScalar, updateRowScalar, transformScalar, affineScalar };
+
+#ifdef SIMD_X86
+
+void addRowSse2(int16_t* values, const int16_t* weights)
+{
+    for (int i = 0; i < kL1; i += 8) {
+        __m128i* v = reinterpret_cast<__m128i*>(values + i);
+        _mm_store_si128(v, _mm_add_epi16(_mm_load_si128(v), _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights + i))));
+    }
+}
+
+void updateRowSse2(int16_t* out, const int16_t* in, const int16_t* sub1, const int16_t* add1, const int16_t* sub2)
+{
+    for (int i = 0; i < kL1; i += 8) {
+        __m128i v = _mm_load_si128(reinterpret_cast<const __m128i*>(in + i));
+        v = _mm_sub_epi16(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(sub1 + i)));
+        v = _mm_add_epi16(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(add1 + i)));
+        if (sub2) v = _mm_sub_epi16(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(sub2 + i)));
+        _mm_store_si128(reinterpret_cast<__m128i*>(out + i), v);
+    }
+}
+
+void transformSse2(const int16_t* us, const int16_t* them, uint8_t* input)
+{
+    // 先截到127以下，负数由无符号饱和打包截为0
+    const __m128i limit = _mm_set1_epi16(127);
+    for (int half = 0; half < 2; ++half) {
+        const int16_t* values = half ? them : us;
+        for (int i = 0; i < kL1; i += 16) {
+            const __m128i a = _mm_min_epi16(_mm_load_si128(reinterpret_cast<const __m128i*>(values + i)), limit);
+            const __m128i b = _mm_min_epi16(_mm_load_si128(reinterpret_cast<const __m128i*>(values + i + 8)), limit);
+            _mm_store_si128(reinterpret_cast<__m128i*>(input + half * kL1 + i), _mm_packus_epi16(a, b));
+        }
+    }
+}
+
+void affineSse2(const uint8_t* input, const int8_t* weights, const int32_t* bias, int32_t* output)
+{
+    const __m128i zero = _mm_setzero_si128();
+    for (int o = 0; o < NnueNetwork::kL2; ++o) {
+        const int8_t* row = weights + o * kInputs;
+        __m128i sum = zero;
+        for (int i = 0; i < kInputs; i += 16) {
+            const __m128i in = _mm_load_si128(reinterpret_cast<const __m128i*>(input + i));
+            const __m128i w = _mm_load_si128(reinterpret_cast<const __m128i*>(row + i));
+            // 输入零扩展、权重符号扩展到16位后成对乘加
+            const __m128i inLo = _mm_unpacklo_epi8(in, zero);
+            const __m128i inHi = _mm_unpackhi_epi8(in, zero);
+            const __m128i wLo = _mm_srai_epi16(_mm_unpacklo_epi8(w, w), 8);
+            const __m128i wHi = _mm_srai_epi16(_mm_unpackhi_epi8(w, w), 8);
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(inLo, wLo));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(inHi, wHi));
+        }
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+        output[o] = bias[o] + _mm_cvtsi128_si32(sum);
+    }
+}
+
+const Kernels kSse2Kernels = { addRowSse2, updateRowSse2, transformSse2, affineSse2 };
+
+SIMD_AVX2_TARGET
+void addRowAvx2(int16_t* values, const int16_t* weights)
+{
+    for (int i = 0; i < kL1; i += 16) {
+        __m256i* v = reinterpret_cast<__m256i*>(values + i);
+        _mm256_store_si256(v, _mm256_add_epi16(_mm256_load_si256(v), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights + i))));
+    }
+}
+
+SIMD_AVX2_TARGET
+void updateRowAvx2(int16_t* out, const int16_t* in, const int16_t* sub1, const int16_t* add1, const int16_t* sub2)
+{
+    for (int i = 0; i < kL1; i += 16) {
+        __m256i v = _mm256_load_si256(reinterpret_cast<const __m256i*>(in + i));
+        v = _mm256_sub_epi16(v, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sub1 + i)));
+        v = _mm256_add_epi16(v, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(add1 + i)));
+        if (sub2) v = _mm256_sub_epi16(v, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sub2 + i)));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(out + i), v);
+    }
+}
+
+SIMD_AVX2_TARGET
+void transformAvx2(const int16_t* us, const int16_t* them, uint8_t* input)
+{
+    const __m256i limit = _mm256_set1_epi16(127);
+    for (int half = 0; half < 2; ++half) {
+        const int16_t* values = half ? them : us;
+        for (int i = 0; i < kL1; i += 32) {
+            const __m256i a = _mm256_min_epi16(_mm256_load_si256(reinterpret_cast<const __m256i*>(values + i)), limit);
+            const __m256i b = _mm256_min_epi16(_mm256_load_si256(reinterpret_cast<const __m256i*>(values + i + 16)), limit);
+            // 打包按128位分道交错，重排回原顺序
+            const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), _MM_SHUFFLE(3, 1, 2, 0));
+            _mm256_store_si256(reinterpret_cast<__m256i*>(input + half * kL1 + i), packed);
+        }
+    }
+}
+
+SIMD_AVX2_TARGET
+void affineAvx2(const uint8_t* input, const int8_t* weights, const int32_t* bias, int32_t* output)
+{
+    // 一次算4个神经元，最后用水平加法合并，减少逐个归约的开销
+    const __m256i ones = _mm256_set1_epi16(1);
+    for (int o = 0; o < NnueNetwork::kL2; o += 4) {
+        __m256i sums[4] = { _mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256() };
+        for (int i = 0; i < kInputs; i += 32) {
+            const __m256i in = _mm256_load_si256(reinterpret_cast<const __m256i*>(input + i));
+            for (int k = 0; k < 4; ++k) {
+                const __m256i w = _mm256_load_si256(reinterpret_cast<const __m256i*>(weights + (o + k) * kInputs + i));
+                sums[k] = _mm256_add_epi32(sums[k], _mm256_madd_epi16(_mm256_maddubs_epi16(in, w), ones));
+            }
+        }
+        const __m256i pairs = _mm256_hadd_epi32(_mm256_hadd_epi32(sums[0], sums[1]), _mm256_hadd_epi32(sums[2], sums[3]));
+        const __m128i total = _mm_add_epi32(_mm256_castsi256_si128(pairs), _mm256_extracti128_si256(pairs, 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + o),
+                         _mm_add_epi32(total, _mm_loadu_si128(reinterpret_cast<const __m128i*>(bias + o))));
+    }
+}
+
+const Kernels kAvx2Kernels = { addRowAvx2, updateRowAvx2, transformAvx2, affineAvx2 };
+
+#endif
+
+const Kernels* kernelsFor(SimdLevel level)
+{
+    switch (level) {
+#ifdef SIMD_X86
+    case SimdLevel::Avx2:
+        return &kAvx2Kernels;
+    case SimdLevel::Sse2:
+        return &kSse2Kernels;
+#endif
+    default:
+        return &kScalarKernels;
+    }
+}
+
+
+inline int kingBucket(int perspective, int kingSquare)
+{
+    if (kingSquare < 0) return 0;
+    const int x = squareX(kingSquare);
+    const int y = perspective == SIDE_RED ? squareY(kingSquare) : 9 - squareY(kingSquare);
+    return std::clamp(y - 7, 0, 2) * 3 + std::clamp(x - 3, 0, 2);
+}
+
+} // namespace
+
+NnueNetwork::~NnueNetwork()
+{
+    close();
+}
+
+bool NnueNetwork::open(const QString& path)
+{
+    close();
+#if Q_BYTE_ORDER != Q_LITTLE_ENDIAN
+    // 权重直接在映射的内存上使用，只支持小端机器
+    Q_UNUSED(path);
+    return false;
+#else
+    const Layout layout = fileLayout();
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly))
+        return false;
+    if (m_file.size() < layout.size) {
+        m_file.close();
+        return false;
+    }
+
+    uchar* data = m_file.map(0, layout.size);
+    if (!data) {
+        m_file.close();
+        return false;
+    }
+    if (std::memcmp(data, kNetMagic, 4) != 0 || qFromLittleEndian<quint32>(data + 4) != kNetVersion
+        || qFromLittleEndian<quint16>(data + 8) != kL1 || qFromLittleEndian<quint16>(data + 10) != kL2) {
+        m_file.unmap(data);
+        m_file.close();
+        return false;
+    }
+
+    m_data = data;
+    m_featureBias = reinterpret_cast<const int16_t*>(data + layout.featureBias);
+    m_featureWeights = reinterpret_cast<const int16_t*>(data + layout.featureWeights);
+    m_hiddenBias = reinterpret_cast<const int32_t*>(data + layout.hiddenBias);
+    m_hiddenWeights = reinterpret_cast<const int8_t*>(data + layout.hiddenWeights);
+    m_outputBias = reinterpret_cast<const int32_t*>(data + layout.outputBias);
+    m_outputWeights = reinterpret_cast<const int8_t*>(data + layout.outputWeights);
+    return true;
+#endif
+}
+
+void NnueNetwork::close()
+{
+    if (m_data) {
+        m_file.unmap(m_data);
+        m_data = nullptr;
+    }
+    if (m_file.isOpen())
+        m_file.close();
+}
+
+int NnueNetwork::featureIndex(int perspective, int kingSquare, uint8_t piece, int sq)
+{
+    const int relative = pieceSide(piece) == perspective ? 0 : 7;
+    const int square = perspective == SIDE_RED ? sq : squareOf(squareX(sq), 9 - squareY(sq));
+    return ((kingBucket(perspective, kingSquare) * 14 + relative + pieceType(piece) - 1) * 90) + square;
+}
+
+void NnueNetwork::refresh(const Position& pos, int perspective, NnueAccumulator& acc) const
+{
+    const Kernels* kernels = kernelsFor(simdLevel());
+    int16_t* values = acc.values[perspective];
+    std::memcpy(values, m_featureBias, sizeof(acc.values[perspective]));
+    const int kingSquare = pos.kingSquare(perspective);
+    for (int sq = 0; sq < 90; ++sq) {
+        const uint8_t piece = pos.pieceAt(sq);
+        if (piece)
+            kernels->addRow(values, weightsOf(featureIndex(perspective, kingSquare, piece, sq)));
+    }
+}
+
+void NnueNetwork::update(const NnueAccumulator& before, NnueAccumulator& after, int perspective,
+                         Move move, uint8_t moved, uint8_t captured, int kingSquare) const
+{
+    const int from = moveFrom(move), to = moveTo(move);
+    kernelsFor(simdLevel())->updateRow(
+        after.values[perspective], before.values[perspective],
+        weightsOf(featureIndex(perspective, kingSquare, moved, from)),
+        weightsOf(featureIndex(perspective, kingSquare, moved, to)),
+        captured ? weightsOf(featureIndex(perspective, kingSquare, captured, to)) : nullptr);
+}
+
+int NnueNetwork::evaluate(const NnueAccumulator& acc, int sideToMove) const
+{
+    const Kernels* kernels = kernelsFor(simdLevel());
+    alignas(32) uint8_t input[kInputs];
+    kernels->transform(acc.values[sideToMove], acc.values[sideToMove ^ 1], input);
+    int32_t hidden[kL2];
+    kernels->affine(input, m_hiddenWeights, m_hiddenBias, hidden);
+
+    int32_t output = *m_outputBias;
+    for (int o = 0; o < kL2; ++o)
+        output += std::clamp(hidden[o] >> kHiddenShift, 0, 127) * m_outputWeights[o];
+    return output / kOutputScale;
+}
+
+bool NnueNetwork::write(const QString& path, const NnueWeights& weights)
+{
+    if (weights.featureBias.size() != size_t(kL1) || weights.featureWeights.size() != size_t(kFeatures) * kL1
+        || weights.hiddenBias.size() != size_t(kL2) || weights.hiddenWeights.size() != size_t(kL2) * kInputs
+        || weights.outputWeights.size() != size_t(kL2))
+        return false;
+
+    const Layout layout = fileLayout();
+    QByteArray data(layout.size, '\0');
+    uchar* p = reinterpret_cast<uchar*>(data.data());
+    std::memcpy(p, kNetMagic, 4);
+    qToLittleEndian<quint32>(kNetVersion, p + 4);
+    qToLittleEndian<quint16>(kL1, p + 8);
+    qToLittleEndian<quint16>(kL2, p + 10);
+    for (size_t i = 0; i < weights.featureBias.size(); ++i)
+        qToLittleEndian<qint16>(weights.featureBias[i], p + layout.featureBias + 2 * i);
+    for (size_t i = 0; i < weights.featureWeights.size(); ++i)
+        qToLittleEndian<qint16>(weights.featureWeights[i], p + layout.featureWeights + 2 * i);
+    for (size_t i = 0; i < weights.hiddenBias.size(); ++i)
+        qToLittleEndian<qint32>(weights.hiddenBias[i], p + layout.hiddenBias + 4 * i);
+    std::memcpy(p + layout.hiddenWeights, weights.hiddenWeights.data(), weights.hiddenWeights.size());
+    qToLittleEndian<qint32>(weights.outputBias, p + layout.outputBias);
+    std::memcpy(p + layout.outputWeights, weights.outputWeights.data(), weights.outputWeights.size());
+
+    QFile file(path);
+    return file.open(QIODevice::WriteOnly | QIODevice::Truncate) && file.write(data) == data.size();
+}
+
+NnueNetwork& NnueNetwork::defaultNetwork()
+{
+    static NnueNetwork network;
+    static bool opened = [] {
+        return network.open(QCoreApplication::applicationDirPath() + "/xiangqi.nnue");
+    }();
+    Q_UNUSED(opened);
+    return network;
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <QFile>
+#include <QString>
+#include <cstdint>
+#include <vector>
+#include "Position.h"
+
+// 一方视角的第一层输出（累加器），两方各一份；搜索中随着走子增量更新
+struct NnueAccumulator {
+    static constexpr int kSize = 128;
+    alignas(32) int16_t values[2][kSize];
+};
+
+// 网络权重，仅用于生成网络文件；各数组的排列与文件中相同
+struct NnueWeights {
+    std::vector<int16_t> featureBias;      // [kL1]
+    std::vector<int16_t> featureWeights;   // [kFeatures][kL1]
+    std::vector<int32_t> hiddenBias;       // [kL2]
+    std::vector<int8_t> hiddenWeights;     // [kL2][2 * kL1]，输入前半为行棋方、后半为对方
+    int32_t outputBias = 0;
+    std::vector<int8_t> outputWeights;     // [kL2]
+};
+
+// 可增量更新的神经网络评估（NNUE）
+//
+// 输入特征按视角方计算（黑方视角上下翻转棋盘）：本方将帅在九宫中的位置（9个桶）
+// × 棋子（本方/对方 × 7种）× 90格，只有棋盘上的棋子对应的特征为1
+// 第一层为int16，按特征累加；之后截断到[0, 127]接int8的隐藏层（kL2个神经元）与int8输出层
+// 累加器更新、输入截断与隐藏层乘加按CPU支持程度选用AVX2、SSE2或普通循环，结果完全一致
+//
+// 文件为小端序，mmap后直接使用：16字节文件头（魔数、版本、kL1、kL2），
+// 其后依次为各段权重，每段从64字节对齐处开始
+class NnueNetwork
+{
+public:
+    static constexpr int kKingBuckets = 9;
+    static constexpr int kFeatures = kKingBuckets * 14 * 90;
+    static constexpr int kL1 = NnueAccumulator::kSize;
+    static constexpr int kL2 = 32;
+    static constexpr int kHiddenShift = 6;     // 隐藏层输出右移后截断到[0, 127]
+    static constexpr int kOutputScale = 16;    // 输出层结果除以此值即为分（兵=100）
+
+    NnueNetwork() = default;
+    ~NnueNetwork();
+    NnueNetwork(const NnueNetwork&) = delete;
+    NnueNetwork& operator=(const NnueNetwork&) = delete;
+
+    bool open(const QString& path);
+    void close();
+    bool isOpen() const { return m_data != nullptr; }
+
+    // 按局面重算一方视角的累加器
+    void refresh(const Position& pos, int perspective, NnueAccumulator& acc) const;
+    // 由走子前的累加器得到走子后的：moved为走动的棋子，captured为被吃的棋子（可为0）
+    // 视角方的将帅走动时特征桶改变，不能增量更新，应改用refresh
+    void update(const NnueAccumulator& before, NnueAccumulator& after, int perspective,
+                Move move, uint8_t moved, uint8_t captured, int kingSquare) const;
+    // 以行棋方为视角的评估值
+    int evaluate(const NnueAccumulator& acc, int sideToMove) const;
+
+    static int featureIndex(int perspective, int kingSquare, uint8_t piece, int sq);
+
+    static bool write(const QString& path, const NnueWeights& weights);
+
+    // 进程内共享的默认网络（程序目录下的xiangqi.nnue），首次使用时打开；没有文件时未打开
+    static NnueNetwork& defaultNetwork();
+
+private:
+    const int16_t* weightsOf(int feature) const { return m_featureWeights + size_t(feature) * kL1; }
+
+    QFile m_file;
+    uchar* m_data = nullptr;
+    const int16_t* m_featureBias = nullptr;
+    const int16_t* m_featureWeights = nullptr;
+    const int32_t* m_hiddenBias = nullptr;
+    const int8_t* m_hiddenWeights = nullptr;
+    const int32_t* m_outputBias = nullptr;
+    const int8_t* m_outputWeights = nullptr;
+};
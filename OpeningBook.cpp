@@ -0,0 +1,160 @@
+#include "OpeningBook.h"
+#include <QCoreApplication>
+#include <QRandomGenerator>
+#include <QtEndian>
+#include <cstring>
+
+namespace {
+
+// 文件头：魔数、版本、条目数、保留字段，共16字节
+const char kBookMagic[4] = { 'X', 'Q', 'B', 'K' };
+const quint32 kBookVersion = 1;
+const qint64 kHeaderSize = 16;
+
+} // namespace
+
+OpeningBook::~OpeningBook()
+{
+    close();
+}
+
+bool OpeningBook::open(const QString& path)
+{
+    close();
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly))
+        return false;
+
+    qint64 fileSize = m_file.size();
+    if (fileSize < kHeaderSize) {
+        m_file.close();
+        return false;
+    }
+
+    uchar* data = m_file.map(0, fileSize);
+    if (!data) {
+        m_file.close();
+        return false;
+    }
+
+    quint32 version = qFromLittleEndian<quint32>(data + 4);
+    quint32 count = qFromLittleEndian<quint32>(data + 8);
+    if (std::memcmp(data, kBookMagic, 4) != 0 || version != kBookVersion ||
+        kHeaderSize + qint64(count) * qint64(sizeof(BookEntry)) > fileSize) {
+        m_file.unmap(data);
+        m_file.close();
+        return false;
+    }
+
+    m_entries = data + kHeaderSize;
+    m_count = count;
+    return true;
+}
+
+void OpeningBook::close()
+{
+    if (m_entries) {
+        m_file.unmap(const_cast<uchar*>(m_entries - kHeaderSize));
+        m_entries = nullptr;
+        m_count = 0;
+    }
+    if (m_file.isOpen())
+        m_file.close();
+}
+
+BookEntry OpeningBook::entryAt(uint32_t index) const
+{
+    const uchar* p = m_entries + size_t(index) * sizeof(BookEntry);
+    BookEntry entry;
+    entry.key = qFromLittleEndian<quint64>(p);
+    entry.move = qFromLittleEndian<quint16>(p + 8);
+    entry.weight = qFromLittleEndian<quint16>(p + 10);
+    entry.wins = qFromLittleEndian<quint16>(p + 12);
+    entry.losses = qFromLittleEndian<quint16>(p + 14);
+    return entry;
+}
+
+uint32_t OpeningBook::lowerBound(uint64_t key) const
+{
+    uint32_t lo = 0, hi = m_count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (qFromLittleEndian<quint64>(m_entries + size_t(mid) * sizeof(BookEntry)) < key)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+std::vector<BookEntry> OpeningBook::lookup(uint64_t key) const
+{
+    std::vector<BookEntry> result;
+    if (!isOpen()) return result;
+
+    for (uint32_t i = lowerBound(key); i < m_count; ++i) {
+        BookEntry entry = entryAt(i);
+        if (entry.key != key) break;
+        result.push_back(entry);
+    }
+    return result;
+}
+
+Move OpeningBook::probe(Position& pos, int minWeight) const
+{
+    std::vector<BookEntry> entries = lookup(pos.key());
+
+    // 过滤出现次数过少和非法的着法（防止哈希冲突）
+    quint64 totalWeight = 0;
+    std::vector<BookEntry> candidates;
+    for (const BookEntry& entry : entries) {
+        if (entry.weight < minWeight || !pos.isLegalMove(entry.move)) continue;
+        candidates.push_back(entry);
+        totalWeight += entry.weight;
+    }
+    if (candidates.empty()) return NO_MOVE;
+
+    quint64 pick = QRandomGenerator::global()->bounded(totalWeight);
+    for (const BookEntry& entry : candidates) {
+        if (pick < entry.weight) return entry.move;
+        pick -= entry.weight;
+    }
+    return candidates.back().move;
+}
+
+bool OpeningBook::write(const QString& path, const std::vector<BookEntry>& entries)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    uchar header[kHeaderSize] = {};
+    std::memcpy(header, kBookMagic, 4);
+    qToLittleEndian<quint32>(kBookVersion, header + 4);
+    qToLittleEndian<quint32>(quint32(entries.size()), header + 8);
+    if (file.write(reinterpret_cast<const char*>(header), kHeaderSize) != kHeaderSize)
+        return false;
+
+    for (const BookEntry& entry : entries) {
+        uchar record[sizeof(BookEntry)];
+        qToLittleEndian<quint64>(entry.key, record);
+        qToLittleEndian<quint16>(entry.move, record + 8);
+        qToLittleEndian<quint16>(entry.weight, record + 10);
+        qToLittleEndian<quint16>(entry.wins, record + 12);
+        qToLittleEndian<quint16>(entry.losses, record + 14);
+        if (file.write(reinterpret_cast<const char*>(record), sizeof(record)) != qint64(sizeof(record)))
+            return false;
+    }
+    return true;
+}
+
+OpeningBook& OpeningBook::defaultBook()
+{
+    static OpeningBook book;
+    static bool opened = [] {
+        return book.open(QCoreApplication::applicationDirPath() + "/book.bin");
+    }();
+    Q_UNUSED(opened);
+    return book;
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <QFile>
+#include <QString>
+#include <cstdint>
+#include <vector>
+#include "Position.h"
+
+// 开局库条目：按Zobrist键排序存储，文件为小端序
+// 胜负统计均以该局面的行棋方为视角
+struct BookEntry {
+    uint64_t key;
+    uint16_t move;
+    uint16_t weight;   // 出现次数（饱和到65535）
+    uint16_t wins;
+    uint16_t losses;
+};
+static_assert(sizeof(BookEntry) == 16, "BookEntry must stay 16 bytes on disk");
+
+// 二进制开局库：通过mmap打开，二分查找，查询不拷贝文件内容
+class OpeningBook
+{
+public:
+    OpeningBook() = default;
+    ~OpeningBook();
+    OpeningBook(const OpeningBook&) = delete;
+    OpeningBook& operator=(const OpeningBook&) = delete;
+
+    bool open(const QString& path);
+    void close();
+    bool isOpen() const { return m_entries != nullptr; }
+    uint32_t size() const { return m_count; }
+
+    // 返回该局面的全部库着
+    std::vector<BookEntry> lookup(uint64_t key) const;
+
+    // 按出现次数加权随机选择一个合法库着，未命中返回NO_MOVE
+    Move probe(Position& pos, int minWeight = 1) const;
+
+    // 写出开局库，entries需已按(key, move)排序
+    static bool write(const QString& path, const std::vector<BookEntry>& entries);
+
+    // 进程内共享的默认开局库（程序目录下的book.bin），首次使用时打开
+    static OpeningBook& defaultBook();
+
+private:
+    BookEntry entryAt(uint32_t index) const;
+    uint32_t lowerBound(uint64_t key) const;
+
+    QFile m_file;
+    const uchar* m_entries = nullptr;
+    uint32_t m_count = 0;
+};
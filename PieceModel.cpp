@@ -0,0 +1,109 @@
+#include "PieceModel.h"
+#include <utility>
+
+PieceModel::PieceModel(QObject* parent)
+    : QAbstractListModel(parent)
+{}
+
+int PieceModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : int(m_pieces.size());
+}
+
+QVariant PieceModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= m_pieces.size())
+        return QVariant();
+
+    const ChessMan* piece = m_pieces[index.row()];
+    switch (role) {
+    case NameRole:
+        return piece->name();
+    case ColorRole:
+        return piece->color();
+    case IconRole:
+        return piece->icon();
+    case XRole:
+        return piece->x();
+    case YRole:
+        return piece->y();
+    case CapturedRole:
+        return piece->x() < 0 || piece->y() < 0;
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int, QByteArray> PieceModel::roleNames() const
+{
+    return {
+        { NameRole, "name" },
+        { ColorRole, "color" },
+        { IconRole, "icon" },
+        { XRole, "boardX" },
+        { YRole, "boardY" },
+        { CapturedRole, "captured" }
+    };
+}
+
+void PieceModel::setPieces(const QList<QObject*>& pieces)
+{
+    beginResetModel();
+    m_changedRows.clear();
+    for (ChessMan* piece : m_pieces)
+        disconnect(piece, nullptr, this, nullptr);
+    m_pieces.clear();
+    for (QObject* obj : pieces) {
+        ChessMan* piece = qobject_cast<ChessMan*>(obj);
+        if (!piece) continue;
+        const int row = int(m_pieces.size());
+        m_pieces.append(piece);
+        connect(piece, &ChessMan::positionChanged, this, [this, row]() { onPositionChanged(row); });
+    }
+    endResetModel();
+    emit countChanged();
+}
+
+void PieceModel::clear()
+{
+    setPieces({});
+}
+
+int PieceModel::indexAt(int x, int y) const
+{
+    for (int row = 0; row < m_pieces.size(); ++row) {
+        if (m_pieces[row]->x() == x && m_pieces[row]->y() == y)
+            return row;
+    }
+    return -1;
+}
+
+QString PieceModel::colorOf(int row) const
+{
+    if (row < 0 || row >= m_pieces.size()) return QString();
+    return m_pieces[row]->color();
+}
+
+void PieceModel::beginBatch()
+{
+    m_batching = true;
+}
+
+void PieceModel::endBatch()
+{
+    m_batching = false;
+    const QList<int> rows = std::exchange(m_changedRows, {});
+    for (int row : rows)
+        onPositionChanged(row);
+}
+
+void PieceModel::onPositionChanged(int row)
+{
+    if (m_batching) {
+        if (!m_changedRows.contains(row))
+            m_changedRows.append(row);
+        return;
+    }
+    const QModelIndex changed = index(row);
+    emit dataChanged(changed, changed, { XRole, YRole, CapturedRole });
+}
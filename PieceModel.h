@@ -0,0 +1,50 @@
+#pragma once
+#include <QAbstractListModel>
+#include <QList>
+#include "ChessMan.h"
+
+// 棋盘棋子模型：行号与ChessController::m_pieces的下标一致（handleMove使用同一下标）
+// 棋子位置变化时只对该行发出dataChanged，QML的Repeater不再整体重建委托
+class PieceModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
+
+public:
+    enum Roles {
+        NameRole = Qt::UserRole + 1,
+        ColorRole,
+        IconRole,
+        XRole,
+        YRole,
+        CapturedRole      // 已被吃掉（坐标为-99）
+    };
+
+    explicit PieceModel(QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    // 新对局时整体替换；模型不持有棋子，删除棋子前须先clear()
+    void setPieces(const QList<QObject*>& pieces);
+    void clear();
+
+    // 批量更新：期间的位置变化按行合并，endBatch时每行只发出一次dataChanged
+    void beginBatch();
+    void endBatch();
+
+    // 指定格上的棋子行号，没有时返回-1
+    Q_INVOKABLE int indexAt(int x, int y) const;
+    Q_INVOKABLE QString colorOf(int row) const;
+
+signals:
+    void countChanged();
+
+private:
+    void onPositionChanged(int row);
+
+    QList<ChessMan*> m_pieces;
+    bool m_batching = false;
+    QList<int> m_changedRows;
+};
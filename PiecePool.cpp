@@ -0,0 +1,46 @@
+#include "PiecePool.h"
+#include "King.h"
+#include "Advisor.h"
+#include "Elephant.h"
+#include "Horse.h"
+#include "Rook.h"
+#include "Cannon.h"
+#include "Soldier.h"
+
+PiecePool::~PiecePool()
+{
+    for (auto& bucket : m_pieces)
+        qDeleteAll(bucket);
+}
+
+ChessMan* PiecePool::acquire(uint8_t code, int x, int y)
+{
+    std::vector<ChessMan*>& bucket = m_pieces[code];
+    const int index = m_used[code]++;
+    if (index < int(bucket.size())) {
+        ChessMan* piece = bucket[index];
+        piece->setX(x);
+        piece->setY(y);
+        return piece;
+    }
+    bucket.push_back(create(code, index, x, y));
+    return bucket.back();
+}
+
+void PiecePool::releaseAll()
+{
+    m_used.fill(0);
+}
+
+ChessMan* PiecePool::create(uint8_t code, int number, int x, int y)
+{
+    switch (pieceType(code)) {
+    case PT_KING: return new King(code, number, x, y);
+    case PT_ADVISOR: return new Advisor(code, number, x, y);
+    case PT_ELEPHANT: return new Elephant(code, number, x, y);
+    case PT_HORSE: return new Horse(code, number, x, y);
+    case PT_ROOK: return new Rook(code, number, x, y);
+    case PT_CANNON: return new Cannon(code, number, x, y);
+    default: return new Soldier(code, number, x, y);
+    }
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <array>
+#include <vector>
+#include "ChessMan.h"
+
+// 棋子池：按棋子编码分桶保存创建过的棋子，新对局或换残局时复用，不再每局new/delete
+// 同一桶中第k枚棋子的名称编号固定，复用后name/color/icon保持不变
+class PiecePool
+{
+public:
+    PiecePool() = default;
+    ~PiecePool();
+    PiecePool(const PiecePool&) = delete;
+    PiecePool& operator=(const PiecePool&) = delete;
+
+    // 取出该编码的下一枚空闲棋子并放到(x, y)，池中不够时新建
+    ChessMan* acquire(uint8_t code, int x, int y);
+    // 所有棋子放回池中；之前取出的指针仍有效，下次acquire时重新摆放
+    void releaseAll();
+
+private:
+    static ChessMan* create(uint8_t code, int number, int x, int y);
+
+    std::array<std::vector<ChessMan*>, 16> m_pieces;
+    std::array<int, 16> m_used = {};
+};
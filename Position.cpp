@@ -0,0 +1,622 @@
+#include "Position.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+namespace {
+
+constexpr uint64_t splitMix64(uint64_t& state)
+{
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+constexpr std::array<std::array<uint64_t, 90>, 16> buildPieceKeys()
+{
+    std::array<std::array<uint64_t, 90>, 16> keys{};
+    uint64_t state = 0x58694171u; // "XiQq"
+    for (auto& row : keys)
+        for (auto& key : row)
+            key = splitMix64(state);
+    return keys;
+}
+
+constexpr uint64_t buildSideKey()
+{
+    uint64_t state = 0x53696465u; // "Side"
+    return splitMix64(state);
+}
+
+inline bool onBoard(int x, int y) { return x >= 0 && x < 9 && y >= 0 && y < 10; }
+
+inline bool inPalace(int side, int x, int y)
+{
+    if (x < 3 || x > 5) return false;
+    return side == SIDE_RED ? (y >= 7 && y <= 9) : (y >= 0 && y <= 2);
+}
+
+inline bool ownHalf(int side, int y) { return side == SIDE_RED ? y >= 5 : y <= 4; }
+
+const int kOrthDx[4] = { 1, -1, 0, 0 };
+const int kOrthDy[4] = { 0, 0, 1, -1 };
+const int kDiagDx[4] = { 1, 1, -1, -1 };
+const int kDiagDy[4] = { 1, -1, 1, -1 };
+const int kHorseDx[8] = { 1, 1, -1, -1, 2, 2, -2, -2 };
+const int kHorseDy[8] = { 2, -2, 2, -2, 1, -1, 1, -1 };
+
+const char kFenChars[8] = { '?', 'k', 'a', 'b', 'n', 'r', 'c', 'p' };
+
+} // namespace
+
+const std::array<std::array<uint64_t, 90>, 16> Zobrist::pieceKeys = buildPieceKeys();
+const uint64_t Zobrist::sideKey = buildSideKey();
+
+Position::Position()
+{
+    clear();
+}
+
+void Position::clear()
+{
+    m_board.fill(0);
+    m_pieceCount.fill(0);
+    m_kingSquare = { -1, -1 };
+    m_side = SIDE_RED;
+    m_key = 0;
+}
+
+Position Position::startPosition()
+{
+    Position pos;
+    pos.fromFen("rnbakabnr/9/1c5c1/p1p1p1p1p/9/9/P1P1P1P1P/1C5C1/9/RNBAKABNR w");
+    return pos;
+}
+
+void Position::setPiece(int sq, uint8_t piece)
+{
+    uint8_t old = m_board[sq];
+    if (old) {
+        m_key ^= Zobrist::pieceKeys[old][sq];
+        m_pieceCount[old]--;
+        if (pieceType(old) == PT_KING && m_kingSquare[pieceSide(old)] == sq)
+            m_kingSquare[pieceSide(old)] = -1;
+    }
+    m_board[sq] = piece;
+    if (piece) {
+        m_key ^= Zobrist::pieceKeys[piece][sq];
+        m_pieceCount[piece]++;
+        if (pieceType(piece) == PT_KING)
+            m_kingSquare[pieceSide(piece)] = int8_t(sq);
+    }
+}
+
+void Position::setSideToMove(int side)
+{
+    if (m_side != side)
+        m_key ^= Zobrist::sideKey;
+    m_side = uint8_t(side);
+}
+
+int Position::totalPieces() const
+{
+    int total = 0;
+    for (uint8_t count : m_pieceCount)
+        total += count;
+    return total;
+}
+
+bool Position::fromFen(const std::string& fen)
+{
+    clear();
+    int x = 0, y = 0;
+    size_t i = 0;
+    for (; i < fen.size() && fen[i] != ' '; ++i) {
+        char c = fen[i];
+        if (c == '/') {
+            if (x != 9) return false;
+            x = 0;
+            if (++y > 9) return false;
+        } else if (c >= '1' && c <= '9') {
+            x += c - '0';
+            if (x > 9) return false;
+        } else {
+            int side = std::isupper(static_cast<unsigned char>(c)) ? SIDE_RED : SIDE_BLACK;
+            char lower = char(std::tolower(static_cast<unsigned char>(c)));
+            int type = PT_NONE;
+            for (int t = PT_KING; t <= PT_SOLDIER; ++t) {
+                if (kFenChars[t] == lower) type = t;
+            }
+            // 兼容部分软件使用的 e(象) / h(马)
+            if (lower == 'e') type = PT_ELEPHANT;
+            if (lower == 'h') type = PT_HORSE;
+            if (type == PT_NONE || x >= 9) return false;
+            setPiece(squareOf(x, y), makePiece(side, type));
+            ++x;
+        }
+    }
+    if (y != 9 || x != 9) return false;
+
+    while (i < fen.size() && fen[i] == ' ') ++i;
+    if (i < fen.size() && fen[i] == 'b')
+        setSideToMove(SIDE_BLACK);
+    return true;
+}
+
+std::string Position::toFen() const
+{
+    std::string fen;
+    for (int y = 0; y < 10; ++y) {
+        int empty = 0;
+        for (int x = 0; x < 9; ++x) {
+            uint8_t piece = m_board[squareOf(x, y)];
+            if (!piece) {
+                ++empty;
+                continue;
+            }
+            if (empty) {
+                fen += char('0' + empty);
+                empty = 0;
+            }
+            char c = kFenChars[pieceType(piece)];
+            fen += pieceSide(piece) == SIDE_RED ? char(std::toupper(static_cast<unsigned char>(c))) : c;
+        }
+        if (empty) fen += char('0' + empty);
+        if (y < 9) fen += '/';
+    }
+    fen += m_side == SIDE_RED ? " w" : " b";
+    return fen;
+}
+
+uint8_t Position::makeMove(Move m)
+{
+    int from = moveFrom(m);
+    int to = moveTo(m);
+    uint8_t piece = m_board[from];
+    uint8_t captured = m_board[to];
+
+    if (captured) {
+        m_key ^= Zobrist::pieceKeys[captured][to];
+        m_pieceCount[captured]--;
+        if (pieceType(captured) == PT_KING)
+            m_kingSquare[pieceSide(captured)] = -1;
+    }
+    m_key ^= Zobrist::pieceKeys[piece][from] ^ Zobrist::pieceKeys[piece][to] ^ Zobrist::sideKey;
+    m_board[from] = 0;
+    m_board[to] = piece;
+    if (pieceType(piece) == PT_KING)
+        m_kingSquare[pieceSide(piece)] = int8_t(to);
+    m_side ^= 1;
+    return captured;
+}
+
+void Position::unmakeMove(Move m, uint8_t captured)
+{
+    int from = moveFrom(m);
+    int to = moveTo(m);
+    uint8_t piece = m_board[to];
+
+    m_side ^= 1;
+    m_board[from] = piece;
+    m_board[to] = captured;
+    m_key ^= Zobrist::pieceKeys[piece][from] ^ Zobrist::pieceKeys[piece][to] ^ Zobrist::sideKey;
+    if (pieceType(piece) == PT_KING)
+        m_kingSquare[pieceSide(piece)] = int8_t(from);
+    if (captured) {
+        m_key ^= Zobrist::pieceKeys[captured][to];
+        m_pieceCount[captured]++;
+        if (pieceType(captured) == PT_KING)
+            m_kingSquare[pieceSide(captured)] = int8_t(to);
+    }
+}
+
+int Position::generateMoves(Move* moves) const
+{
+    return generate(moves, false);
+}
+
+int Position::generateCaptures(Move* moves) const
+{
+    return generate(moves, true);
+}
+
+int Position::generate(Move* moves, bool capturesOnly) const
+{
+    int count = 0;
+    const int side = m_side;
+
+    auto addMove = [&](int from, int tx, int ty) {
+        uint8_t target = m_board[squareOf(tx, ty)];
+        if (target ? pieceSide(target) == side : capturesOnly) return;
+        moves[count++] = encodeMove(from, squareOf(tx, ty));
+    };
+
+    for (int from = 0; from < 90; ++from) {
+        uint8_t piece = m_board[from];
+        if (!piece || pieceSide(piece) != side) continue;
+        int x = squareX(from), y = squareY(from);
+
+        switch (pieceType(piece)) {
+        case PT_KING:
+            for (int d = 0; d < 4; ++d) {
+                int tx = x + kOrthDx[d], ty = y + kOrthDy[d];
+                if (inPalace(side, tx, ty)) addMove(from, tx, ty);
+            }
+            break;
+        case PT_ADVISOR:
+            for (int d = 0; d < 4; ++d) {
+                int tx = x + kDiagDx[d], ty = y + kDiagDy[d];
+                if (inPalace(side, tx, ty)) addMove(from, tx, ty);
+            }
+            break;
+        case PT_ELEPHANT:
+            for (int d = 0; d < 4; ++d) {
+                int tx = x + 2 * kDiagDx[d], ty = y + 2 * kDiagDy[d];
+                if (!onBoard(tx, ty) || !ownHalf(side, ty)) continue;
+                if (m_board[squareOf(x + kDiagDx[d], y + kDiagDy[d])]) continue; // 塞象眼
+                addMove(from, tx, ty);
+            }
+            break;
+        case PT_HORSE:
+            for (int d = 0; d < 8; ++d) {
+                int tx = x + kHorseDx[d], ty = y + kHorseDy[d];
+                if (!onBoard(tx, ty)) continue;
+                int legX = x + (std::abs(kHorseDx[d]) == 2 ? kHorseDx[d] / 2 : 0);
+                int legY = y + (std::abs(kHorseDy[d]) == 2 ? kHorseDy[d] / 2 : 0);
+                if (m_board[squareOf(legX, legY)]) continue; // 蹩马腿
+                addMove(from, tx, ty);
+            }
+            break;
+        case PT_ROOK:
+        case PT_CANNON: {
+            bool cannon = pieceType(piece) == PT_CANNON;
+            for (int d = 0; d < 4; ++d) {
+                int tx = x + kOrthDx[d], ty = y + kOrthDy[d];
+                while (onBoard(tx, ty) && !m_board[squareOf(tx, ty)]) {
+                    if (!capturesOnly)
+                        moves[count++] = encodeMove(from, squareOf(tx, ty));
+                    tx += kOrthDx[d];
+                    ty += kOrthDy[d];
+                }
+                if (!onBoard(tx, ty)) continue;
+                if (cannon) {
+                    // 炮需翻过一个炮架才能吃子
+                    tx += kOrthDx[d];
+                    ty += kOrthDy[d];
+                    while (onBoard(tx, ty) && !m_board[squareOf(tx, ty)]) {
+                        tx += kOrthDx[d];
+                        ty += kOrthDy[d];
+                    }
+                    if (!onBoard(tx, ty)) continue;
+                }
+                if (pieceSide(m_board[squareOf(tx, ty)]) != side)
+                    moves[count++] = encodeMove(from, squareOf(tx, ty));
+            }
+            break;
+        }
+        case PT_SOLDIER: {
+            int forward = side == SIDE_RED ? -1 : 1;
+            if (onBoard(x, y + forward)) addMove(from, x, y + forward);
+            if (!ownHalf(side, y)) {
+                if (x > 0) addMove(from, x - 1, y);
+                if (x < 8) addMove(from, x + 1, y);
+            }
+            break;
+        }
+        default:
+            break;
+        }
+    }
+    return count;
+}
+
+void Position::attackCounts(int side, uint8_t* counts) const
+{
+    std::fill(counts, counts + 90, uint8_t(0));
+    auto control = [&](int tx, int ty) { ++counts[squareOf(tx, ty)]; };
+
+    for (int from = 0; from < 90; ++from) {
+        uint8_t piece = m_board[from];
+        if (!piece || pieceSide(piece) != side) continue;
+        int x = squareX(from), y = squareY(from);
+
+        switch (pieceType(piece)) {
+        case PT_KING:
+            for (int d = 0; d < 4; ++d) {
+                int tx = x + kOrthDx[d], ty = y + kOrthDy[d];
+                if (inPalace(side, tx, ty)) control(tx, ty);
+            }
+            break;
+        case PT_ADVISOR:
+            for (int d = 0; d < 4; ++d) {
+                int tx = x + kDiagDx[d], ty = y + kDiagDy[d];
+                if (inPalace(side, tx, ty)) control(tx, ty);
+            }
+            break;
+        case PT_ELEPHANT:
+            for (int d = 0; d < 4; ++d) {
+                int tx = x + 2 * kDiagDx[d], ty = y + 2 * kDiagDy[d];
+                if (!onBoard(tx, ty) || !ownHalf(side, ty)) continue;
+                if (m_board[squareOf(x + kDiagDx[d], y + kDiagDy[d])]) continue;
+                control(tx, ty);
+            }
+            break;
+        case PT_HORSE:
+            for (int d = 0; d < 8; ++d) {
+                int tx = x + kHorseDx[d], ty = y + kHorseDy[d];
+                if (!onBoard(tx, ty)) continue;
+                int legX = x + (std::abs(kHorseDx[d]) == 2 ? kHorseDx[d] / 2 : 0);
+                int legY = y + (std::abs(kHorseDy[d]) == 2 ? kHorseDy[d] / 2 : 0);
+                if (m_board[squareOf(legX, legY)]) continue;
+                control(tx, ty);
+            }
+            break;
+        case PT_ROOK:
+        case PT_CANNON: {
+            bool cannon = pieceType(piece) == PT_CANNON;
+            for (int d = 0; d < 4; ++d) {
+                int tx = x + kOrthDx[d], ty = y + kOrthDy[d];
+                while (onBoard(tx, ty) && !m_board[squareOf(tx, ty)]) {
+                    if (!cannon) control(tx, ty);
+                    tx += kOrthDx[d];
+                    ty += kOrthDy[d];
+                }
+                if (!onBoard(tx, ty)) continue;
+                if (cannon) {
+                    tx += kOrthDx[d];
+                    ty += kOrthDy[d];
+                    while (onBoard(tx, ty) && !m_board[squareOf(tx, ty)]) {
+                        control(tx, ty);
+                        tx += kOrthDx[d];
+                        ty += kOrthDy[d];
+                    }
+                    if (!onBoard(tx, ty)) continue;
+                }
+                control(tx, ty);
+            }
+            break;
+        }
+        case PT_SOLDIER: {
+            int forward = side == SIDE_RED ? -1 : 1;
+            if (onBoard(x, y + forward)) control(x, y + forward);
+            if (!ownHalf(side, y)) {
+                if (x > 0) control(x - 1, y);
+                if (x < 8) control(x + 1, y);
+            }
+            break;
+        }
+        default:
+            break;
+        }
+    }
+}
+
+bool Position::isSquareAttacked(int sq, int bySide) const
+{
+    const int x = squareX(sq), y = squareY(sq);
+
+    // 车、炮：沿四个方向扫描
+    for (int d = 0; d < 4; ++d) {
+        int tx = x + kOrthDx[d], ty = y + kOrthDy[d];
+        while (onBoard(tx, ty) && !m_board[squareOf(tx, ty)]) {
+            tx += kOrthDx[d];
+            ty += kOrthDy[d];
+        }
+        if (!onBoard(tx, ty)) continue;
+        uint8_t first = m_board[squareOf(tx, ty)];
+        if (first == makePiece(bySide, PT_ROOK)) return true;
+        tx += kOrthDx[d];
+        ty += kOrthDy[d];
+        while (onBoard(tx, ty) && !m_board[squareOf(tx, ty)]) {
+            tx += kOrthDx[d];
+            ty += kOrthDy[d];
+        }
+        if (onBoard(tx, ty) && m_board[squareOf(tx, ty)] == makePiece(bySide, PT_CANNON)) return true;
+    }
+
+    // 马：从目标格反推马的位置，马腿在马的一侧
+    const uint8_t horse = makePiece(bySide, PT_HORSE);
+    for (int d = 0; d < 8; ++d) {
+        int hx = x + kHorseDx[d], hy = y + kHorseDy[d];
+        if (!onBoard(hx, hy) || m_board[squareOf(hx, hy)] != horse) continue;
+        int legX = hx - (std::abs(kHorseDx[d]) == 2 ? kHorseDx[d] / 2 : 0);
+        int legY = hy - (std::abs(kHorseDy[d]) == 2 ? kHorseDy[d] / 2 : 0);
+        if (!m_board[squareOf(legX, legY)]) return true;
+    }
+
+    // 兵：未过河只能向前，过河后可以横走
+    const uint8_t soldier = makePiece(bySide, PT_SOLDIER);
+    int behind = bySide == SIDE_RED ? y + 1 : y - 1;
+    if (onBoard(x, behind) && m_board[squareOf(x, behind)] == soldier) return true;
+    if (!ownHalf(bySide, y)) {
+        if (x > 0 && m_board[squareOf(x - 1, y)] == soldier) return true;
+        if (x < 8 && m_board[squareOf(x + 1, y)] == soldier) return true;
+    }
+
+    // 帅、仕：只在九宫内
+    if (inPalace(bySide, x, y)) {
+        const uint8_t king = makePiece(bySide, PT_KING);
+        const uint8_t advisor = makePiece(bySide, PT_ADVISOR);
+        for (int d = 0; d < 4; ++d) {
+            int tx = x + kOrthDx[d], ty = y + kOrthDy[d];
+            if (onBoard(tx, ty) && m_board[squareOf(tx, ty)] == king) return true;
+            tx = x + kDiagDx[d];
+            ty = y + kDiagDy[d];
+            if (onBoard(tx, ty) && m_board[squareOf(tx, ty)] == advisor) return true;
+        }
+    }
+
+    // 相：只在己方半场
+    if (ownHalf(bySide, y)) {
+        const uint8_t elephant = makePiece(bySide, PT_ELEPHANT);
+        for (int d = 0; d < 4; ++d) {
+            int tx = x + 2 * kDiagDx[d], ty = y + 2 * kDiagDy[d];
+            if (onBoard(tx, ty) && m_board[squareOf(tx, ty)] == elephant &&
+                !m_board[squareOf(x + kDiagDx[d], y + kDiagDy[d])])
+                return true;
+        }
+    }
+
+    return false;
+}
+
+int Position::leastValuableAttacker(int sq, int bySide) const
+{
+    const int x = squareX(sq), y = squareY(sq);
+
+    const uint8_t soldier = makePiece(bySide, PT_SOLDIER);
+    int behind = bySide == SIDE_RED ? y + 1 : y - 1;
+    if (onBoard(x, behind) && m_board[squareOf(x, behind)] == soldier) return squareOf(x, behind);
+    if (!ownHalf(bySide, y)) {
+        if (x > 0 && m_board[squareOf(x - 1, y)] == soldier) return squareOf(x - 1, y);
+        if (x < 8 && m_board[squareOf(x + 1, y)] == soldier) return squareOf(x + 1, y);
+    }
+
+    const bool palace = inPalace(bySide, x, y);
+    if (palace) {
+        const uint8_t advisor = makePiece(bySide, PT_ADVISOR);
+        for (int d = 0; d < 4; ++d) {
+            int tx = x + kDiagDx[d], ty = y + kDiagDy[d];
+            if (onBoard(tx, ty) && m_board[squareOf(tx, ty)] == advisor) return squareOf(tx, ty);
+        }
+    }
+
+    if (ownHalf(bySide, y)) {
+        const uint8_t elephant = makePiece(bySide, PT_ELEPHANT);
+        for (int d = 0; d < 4; ++d) {
+            int tx = x + 2 * kDiagDx[d], ty = y + 2 * kDiagDy[d];
+            if (onBoard(tx, ty) && m_board[squareOf(tx, ty)] == elephant &&
+                !m_board[squareOf(x + kDiagDx[d], y + kDiagDy[d])])
+                return squareOf(tx, ty);
+        }
+    }
+
+    const uint8_t horse = makePiece(bySide, PT_HORSE);
+    for (int d = 0; d < 8; ++d) {
+        int hx = x + kHorseDx[d], hy = y + kHorseDy[d];
+        if (!onBoard(hx, hy) || m_board[squareOf(hx, hy)] != horse) continue;
+        int legX = hx - (std::abs(kHorseDx[d]) == 2 ? kHorseDx[d] / 2 : 0);
+        int legY = hy - (std::abs(kHorseDy[d]) == 2 ? kHorseDy[d] / 2 : 0);
+        if (!m_board[squareOf(legX, legY)]) return squareOf(hx, hy);
+    }
+
+    // 车、炮：每个方向上第一个棋子可能是车，翻过它之后的第一个棋子可能是炮
+    int rook = -1;
+    for (int d = 0; d < 4; ++d) {
+        int tx = x + kOrthDx[d], ty = y + kOrthDy[d];
+        while (onBoard(tx, ty) && !m_board[squareOf(tx, ty)]) {
+            tx += kOrthDx[d];
+            ty += kOrthDy[d];
+        }
+        if (!onBoard(tx, ty)) continue;
+        if (rook < 0 && m_board[squareOf(tx, ty)] == makePiece(bySide, PT_ROOK)) rook = squareOf(tx, ty);
+        tx += kOrthDx[d];
+        ty += kOrthDy[d];
+        while (onBoard(tx, ty) && !m_board[squareOf(tx, ty)]) {
+            tx += kOrthDx[d];
+            ty += kOrthDy[d];
+        }
+        if (onBoard(tx, ty) && m_board[squareOf(tx, ty)] == makePiece(bySide, PT_CANNON)) return squareOf(tx, ty);
+    }
+    if (rook >= 0) return rook;
+
+    if (palace) {
+        const uint8_t king = makePiece(bySide, PT_KING);
+        for (int d = 0; d < 4; ++d) {
+            int tx = x + kOrthDx[d], ty = y + kOrthDy[d];
+            if (onBoard(tx, ty) && m_board[squareOf(tx, ty)] == king) return squareOf(tx, ty);
+        }
+    }
+    return -1;
+}
+
+bool Position::isInCheck(int side) const
+{
+    int king = m_kingSquare[side];
+    if (king < 0) return false;
+    if (isSquareAttacked(king, side ^ 1)) return true;
+
+    // 王对王照面
+    int other = m_kingSquare[side ^ 1];
+    if (other < 0 || squareX(other) != squareX(king)) return false;
+    int step = other > king ? 9 : -9;
+    for (int sq = king + step; sq != other; sq += step) {
+        if (m_board[sq]) return false;
+    }
+    return true;
+}
+
+int Position::generateLegalMoves(Move* moves)
+{
+    int count = generateMoves(moves);
+    int legal = 0;
+    const int side = m_side;
+    for (int i = 0; i < count; ++i) {
+        uint8_t captured = makeMove(moves[i]);
+        bool ok = !isInCheck(side);
+        unmakeMove(moves[i], captured);
+        if (ok) moves[legal++] = moves[i];
+    }
+    return legal;
+}
+
+bool Position::hasLegalMove()
+{
+    Move moves[MAX_MOVES];
+    int count = generateMoves(moves);
+    const int side = m_side;
+    for (int i = 0; i < count; ++i) {
+        uint8_t captured = makeMove(moves[i]);
+        bool ok = !isInCheck(side);
+        unmakeMove(moves[i], captured);
+        if (ok) return true;
+    }
+    return false;
+}
+
+bool Position::isPseudoLegal(Move m) const
+{
+    if (m == NO_MOVE) return false;
+    uint8_t piece = m_board[moveFrom(m)];
+    if (!piece || pieceSide(piece) != m_side) return false;
+    Move moves[MAX_MOVES];
+    int count = generateMoves(moves);
+    for (int i = 0; i < count; ++i) {
+        if (moves[i] == m) return true;
+    }
+    return false;
+}
+
+bool Position::isLegalMove(Move m)
+{
+    if (!isPseudoLegal(m)) return false;
+    const int side = m_side;
+    uint8_t captured = makeMove(m);
+    bool ok = !isInCheck(side);
+    unmakeMove(m, captured);
+    return ok;
+}
+
+std::string Position::moveToIccs(Move m)
+{
+    int from = moveFrom(m), to = moveTo(m);
+    std::string text(4, ' ');
+    text[0] = char('a' + squareX(from));
+    text[1] = char('0' + 9 - squareY(from));
+    text[2] = char('a' + squareX(to));
+    text[3] = char('0' + 9 - squareY(to));
+    return text;
+}
+
+Move Position::moveFromIccs(const std::string& text)
+{
+    if (text.size() < 4) return NO_MOVE;
+    int fx = std::tolower(static_cast<unsigned char>(text[0])) - 'a';
+    int fy = 9 - (text[1] - '0');
+    int tx = std::tolower(static_cast<unsigned char>(text[2])) - 'a';
+    int ty = 9 - (text[3] - '0');
+    if (!onBoard(fx, fy) || !onBoard(tx, ty)) return NO_MOVE;
+    if (fx == tx && fy == ty) return NO_MOVE;
+    return encodeMove(squareOf(fx, fy), squareOf(tx, ty));
+}
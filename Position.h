@@ -0,0 +1,107 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <string>
+
+// 紧凑棋盘表示：供搜索、开局库等引擎模块使用，不依赖ChessMan/QObject
+// 坐标与ChessMan一致：square = y * 9 + x，y = 0为黑方底线，红下黑上
+
+enum PieceType : uint8_t {
+    PT_NONE = 0,
+    PT_KING,
+    PT_ADVISOR,
+    PT_ELEPHANT,
+    PT_HORSE,
+    PT_ROOK,
+    PT_CANNON,
+    PT_SOLDIER
+};
+
+enum Side : uint8_t {
+    SIDE_RED = 0,
+    SIDE_BLACK = 1
+};
+
+// 棋子编码：side * 8 + type，0表示空格
+inline constexpr uint8_t makePiece(int side, int type) { return uint8_t(side * 8 + type); }
+inline constexpr int pieceType(uint8_t piece) { return piece & 7; }
+inline constexpr int pieceSide(uint8_t piece) { return piece >> 3; }
+
+inline constexpr int squareOf(int x, int y) { return y * 9 + x; }
+inline constexpr int squareX(int sq) { return sq % 9; }
+inline constexpr int squareY(int sq) { return sq / 9; }
+
+// 着法编码：低7位起点，高7位终点；0表示无着法
+using Move = uint16_t;
+inline constexpr Move encodeMove(int from, int to) { return Move(from | (to << 7)); }
+inline constexpr int moveFrom(Move m) { return m & 127; }
+inline constexpr int moveTo(Move m) { return m >> 7; }
+inline constexpr Move NO_MOVE = 0;
+
+inline constexpr int MAX_MOVES = 128;
+
+// Zobrist键：固定种子生成，开局库等磁盘文件依赖其跨版本稳定
+namespace Zobrist {
+    extern const std::array<std::array<uint64_t, 90>, 16> pieceKeys;
+    extern const uint64_t sideKey;
+}
+
+class Position
+{
+public:
+    Position();
+
+    static Position startPosition();
+
+    // FEN格式：行从黑方底线开始，大写为红方，如 "rnbakabnr/9/1c5c1/... w"
+    bool fromFen(const std::string& fen);
+    std::string toFen() const;
+
+    void clear();
+    void setPiece(int sq, uint8_t piece);
+    void setSideToMove(int side);
+
+    uint8_t pieceAt(int sq) const { return m_board[sq]; }
+    uint8_t pieceAt(int x, int y) const { return m_board[squareOf(x, y)]; }
+    const uint8_t* squares() const { return m_board.data(); }
+    int sideToMove() const { return m_side; }
+    uint64_t key() const { return m_key; }
+    int kingSquare(int side) const { return m_kingSquare[side]; }
+    int pieceCount(uint8_t piece) const { return m_pieceCount[piece]; }
+    int totalPieces() const;
+
+    // 执行/撤销着法（不检查合法性），返回被吃棋子
+    uint8_t makeMove(Move m);
+    void unmakeMove(Move m, uint8_t captured);
+
+    // 伪合法着法（按棋子走法，不检查送将），返回数量
+    int generateMoves(Move* moves) const;
+    int generateCaptures(Move* moves) const;
+    // 合法着法：过滤送将与王对王
+    int generateLegalMoves(Move* moves);
+    bool hasLegalMove();
+    bool isLegalMove(Move m);
+
+    // 是否被将军（包含王对王照面）
+    bool isInCheck(int side) const;
+    bool isSquareAttacked(int sq, int bySide) const;
+    // bySide攻击sq的棋子中最便宜的一个（兵、仕、相、马、炮、车、将帅依次），返回其所在格，没有为-1
+    int leastValuableAttacker(int sq, int bySide) const;
+    // 各格受side控制的次数（counts前90项）：按棋子走法计算，本方棋子所在格即为受保护，
+    // 炮控制炮架之后直到下一个棋子（含）的各格；不检查送将，不计王对王照面
+    void attackCounts(int side, uint8_t* counts) const;
+
+    // ICCS坐标记法，如 "h2e2"（列a-i，行0-9自红方底线起）
+    static std::string moveToIccs(Move m);
+    static Move moveFromIccs(const std::string& text);
+
+private:
+    int generate(Move* moves, bool capturesOnly) const;
+    bool isPseudoLegal(Move m) const;
+
+    std::array<uint8_t, 90> m_board;
+    std::array<uint8_t, 16> m_pieceCount;
+    std::array<int8_t, 2> m_kingSquare;
+    uint8_t m_side;
+    uint64_t m_key;
+};
@@ -0,0 +1,327 @@
+#include "PositionIndex.h"
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <queue>
+
+namespace {
+
+// 文件头：魔数、版本、条目数、建索引时的局数，共16字节
+const char kIndexMagic[4] = { 'X', 'Q', 'P', 'I' };
+const quint32 kIndexVersion = 1;
+const qint64 kHeaderSize = 16;
+const qint64 kEntrySize = sizeof(PositionIndexEntry);
+const size_t kBlockEntries = 65536;    // 顺串读写的缓冲条目数
+
+bool entryLess(const PositionIndexEntry& a, const PositionIndexEntry& b)
+{
+    if (a.key != b.key) return a.key < b.key;
+    if (a.move != b.move) return a.move < b.move;
+    if (a.result != b.result) return a.result < b.result;
+    return a.game < b.game;
+}
+
+void encodeEntry(const PositionIndexEntry& entry, uchar* p)
+{
+    qToLittleEndian<quint64>(entry.key, p);
+    qToLittleEndian<quint32>(entry.game, p + 8);
+    qToLittleEndian<quint16>(entry.move, p + 12);
+    p[14] = entry.ply;
+    p[15] = uchar(entry.result);
+}
+
+PositionIndexEntry decodeEntry(const uchar* p)
+{
+    PositionIndexEntry entry;
+    entry.key = qFromLittleEndian<quint64>(p);
+    entry.game = qFromLittleEndian<quint32>(p + 8);
+    entry.move = qFromLittleEndian<quint16>(p + 12);
+    entry.ply = p[14];
+    entry.result = GameResult(p[15]);
+    return entry;
+}
+
+// 按块编码写出，避免逐条调用write
+bool writeEntries(QFile& file, const PositionIndexEntry* entries, size_t count)
+{
+    QByteArray block;
+    for (size_t begin = 0; begin < count; begin += kBlockEntries) {
+        size_t n = std::min(kBlockEntries, count - begin);
+        block.resize(qsizetype(n * kEntrySize));
+        uchar* p = reinterpret_cast<uchar*>(block.data());
+        for (size_t i = 0; i < n; ++i)
+            encodeEntry(entries[begin + i], p + i * kEntrySize);
+        if (file.write(block) != block.size())
+            return false;
+    }
+    return true;
+}
+
+bool writeHeader(QFile& file, quint64 count, quint32 gameCount)
+{
+    uchar header[kHeaderSize] = {};
+    std::memcpy(header, kIndexMagic, 4);
+    qToLittleEndian<quint32>(kIndexVersion, header + 4);
+    qToLittleEndian<quint32>(quint32(count), header + 8);
+    qToLittleEndian<quint32>(gameCount, header + 12);
+    return file.write(reinterpret_cast<const char*>(header), kHeaderSize) == kHeaderSize;
+}
+
+// 归并时顺序读取一个顺串
+class RunReader
+{
+public:
+    explicit RunReader(const QString& path) : m_file(path) {}
+
+    bool open() { return m_file.open(QIODevice::ReadOnly); }
+
+    bool next(PositionIndexEntry& entry)
+    {
+        if (m_pos >= m_block.size()) {
+            m_block = m_file.read(qint64(kBlockEntries * kEntrySize));
+            m_pos = 0;
+            if (m_block.size() < kEntrySize) return false;
+        }
+        entry = decodeEntry(reinterpret_cast<const uchar*>(m_block.constData()) + m_pos);
+        m_pos += kEntrySize;
+        return true;
+    }
+
+private:
+    QFile m_file;
+    QByteArray m_block;
+    qsizetype m_pos = 0;
+};
+
+} // namespace
+
+PositionIndex::~PositionIndex()
+{
+    close();
+}
+
+QString PositionIndex::indexPath(const QString& databasePath)
+{
+    if (databasePath.endsWith(".xdb"))
+        return databasePath.left(databasePath.size() - 4) + ".xpi";
+    return databasePath + ".xpi";
+}
+
+bool PositionIndex::open(const QString& path)
+{
+    close();
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly))
+        return false;
+
+    qint64 fileSize = m_file.size();
+    if (fileSize < kHeaderSize) {
+        m_file.close();
+        return false;
+    }
+
+    uchar* data = m_file.map(0, fileSize);
+    if (!data) {
+        m_file.close();
+        return false;
+    }
+
+    quint32 version = qFromLittleEndian<quint32>(data + 4);
+    quint32 count = qFromLittleEndian<quint32>(data + 8);
+    if (std::memcmp(data, kIndexMagic, 4) != 0 || version != kIndexVersion ||
+        kHeaderSize + qint64(count) * kEntrySize > fileSize) {
+        m_file.unmap(data);
+        m_file.close();
+        return false;
+    }
+
+    m_entries = data + kHeaderSize;
+    m_count = count;
+    m_gameCount = qFromLittleEndian<quint32>(data + 12);
+    return true;
+}
+
+void PositionIndex::close()
+{
+    if (m_entries) {
+        m_file.unmap(const_cast<uchar*>(m_entries - kHeaderSize));
+        m_entries = nullptr;
+        m_count = 0;
+        m_gameCount = 0;
+    }
+    if (m_file.isOpen())
+        m_file.close();
+}
+
+PositionIndexEntry PositionIndex::entryAt(uint32_t index) const
+{
+    return decodeEntry(m_entries + size_t(index) * kEntrySize);
+}
+
+uint32_t PositionIndex::lowerBound(uint32_t lo, uint32_t hi, uint64_t key, uint16_t move, uint8_t result) const
+{
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        const uchar* p = m_entries + size_t(mid) * kEntrySize;
+        uint64_t midKey = qFromLittleEndian<quint64>(p);
+        uint16_t midMove = qFromLittleEndian<quint16>(p + 12);
+        bool less = midKey != key ? midKey < key : (midMove != move ? midMove < move : p[15] < result);
+        if (less)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+std::vector<ExplorerMove> PositionIndex::moves(uint64_t key, uint32_t* totalGames) const
+{
+    std::vector<ExplorerMove> result;
+    if (totalGames) *totalGames = 0;
+    if (!isOpen()) return result;
+
+    const uint32_t begin = lowerBound(0, m_count, key, 0, 0);
+    const uint32_t end = key == std::numeric_limits<uint64_t>::max()
+        ? m_count : lowerBound(begin, m_count, key + 1, 0, 0);
+    if (totalGames) *totalGames = end - begin;
+
+    // 逐个着法跳跃：每组只查组尾和三个结果边界，不扫描组内条目
+    for (uint32_t lo = begin; lo < end;) {
+        const uint16_t move = entryAt(lo).move;
+        const uint32_t hi = lowerBound(lo, end, key, uint16_t(move + 1), 0);
+        if (move != NO_MOVE) {
+            const uint32_t redBegin = lowerBound(lo, hi, key, move, uint8_t(GameResult::RedWin));
+            const uint32_t blackBegin = lowerBound(redBegin, hi, key, move, uint8_t(GameResult::BlackWin));
+            const uint32_t drawBegin = lowerBound(blackBegin, hi, key, move, uint8_t(GameResult::Draw));
+            ExplorerMove stats;
+            stats.move = move;
+            stats.games = hi - lo;
+            stats.redWins = blackBegin - redBegin;
+            stats.blackWins = drawBegin - blackBegin;
+            stats.draws = hi - drawBegin;
+            result.push_back(stats);
+        }
+        lo = hi;
+    }
+
+    std::sort(result.begin(), result.end(), [](const ExplorerMove& a, const ExplorerMove& b) {
+        return a.games > b.games;
+    });
+    return result;
+}
+
+std::vector<uint32_t> PositionIndex::games(uint64_t key, size_t limit) const
+{
+    std::vector<uint32_t> result;
+    if (!isOpen()) return result;
+
+    for (uint32_t i = lowerBound(0, m_count, key, 0, 0); i < m_count && result.size() < limit; ++i) {
+        PositionIndexEntry entry = entryAt(i);
+        if (entry.key != key) break;
+        if (std::find(result.begin(), result.end(), entry.game) == result.end())
+            result.push_back(entry.game);
+    }
+    return result;
+}
+
+bool PositionIndex::build(const GameDatabase& database, const QString& path, int maxPlies, size_t runEntries)
+{
+    runEntries = std::max<size_t>(runEntries, kBlockEntries);
+    std::vector<PositionIndexEntry> buffer;
+    buffer.reserve(std::min<size_t>(runEntries, size_t(database.count()) * size_t(maxPlies) + 1));
+    std::vector<QString> runs;
+    quint64 total = 0;
+
+    auto cleanup = [&runs]() {
+        for (const QString& run : runs)
+            QFile::remove(run);
+    };
+    auto writeRun = [&]() {
+        std::sort(buffer.begin(), buffer.end(), entryLess);
+        runs.push_back(path + ".run" + QString::number(runs.size()));
+        QFile run(runs.back());
+        bool ok = run.open(QIODevice::WriteOnly | QIODevice::Truncate)
+            && writeEntries(run, buffer.data(), buffer.size());
+        buffer.clear();
+        return ok;
+    };
+
+    GameRecord game;
+    for (uint32_t i = 0; i < database.count(); ++i) {
+        if (!database.game(i, game)) continue;
+        Position pos = game.startPosition();
+        for (int ply = 0; ply < maxPlies; ++ply) {
+            Move move = ply < int(game.moves.size()) ? game.moves[ply] : NO_MOVE;
+            if (move != NO_MOVE && !pos.isLegalMove(move)) move = NO_MOVE;
+            buffer.push_back({ pos.key(), i, move, uint8_t(std::min(ply, 255)), game.result });
+            ++total;
+            if (move == NO_MOVE) break;
+            pos.makeMove(move);
+        }
+        if (buffer.size() >= runEntries && !writeRun()) {
+            cleanup();
+            return false;
+        }
+    }
+    if (total > std::numeric_limits<quint32>::max()) {
+        cleanup();
+        return false;
+    }
+
+    QFile out(path);
+    if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate) || !writeHeader(out, total, database.count())) {
+        cleanup();
+        return false;
+    }
+
+    // 全部放得下内存时直接排序写出，不经过顺串
+    if (runs.empty()) {
+        std::sort(buffer.begin(), buffer.end(), entryLess);
+        return writeEntries(out, buffer.data(), buffer.size());
+    }
+    if (!buffer.empty() && !writeRun()) {
+        cleanup();
+        return false;
+    }
+    std::vector<PositionIndexEntry>().swap(buffer);
+
+    // 多路归并：小顶堆中每个顺串各放一条当前最小的条目
+    std::vector<std::unique_ptr<RunReader>> readers;
+    using HeapItem = std::pair<PositionIndexEntry, size_t>;
+    auto greater = [](const HeapItem& a, const HeapItem& b) { return entryLess(b.first, a.first); };
+    std::priority_queue<HeapItem, std::vector<HeapItem>, decltype(greater)> heap(greater);
+    for (size_t r = 0; r < runs.size(); ++r) {
+        readers.push_back(std::make_unique<RunReader>(runs[r]));
+        PositionIndexEntry entry;
+        if (!readers.back()->open()) {
+            cleanup();
+            return false;
+        }
+        if (readers.back()->next(entry))
+            heap.push({ entry, r });
+    }
+
+    std::vector<PositionIndexEntry> block;
+    block.reserve(kBlockEntries);
+    bool ok = true;
+    while (ok && !heap.empty()) {
+        auto [entry, r] = heap.top();
+        heap.pop();
+        block.push_back(entry);
+        if (readers[r]->next(entry))
+            heap.push({ entry, r });
+        if (block.size() == kBlockEntries) {
+            ok = writeEntries(out, block.data(), block.size());
+            block.clear();
+        }
+    }
+    if (ok)
+        ok = writeEntries(out, block.data(), block.size());
+
+    readers.clear();
+    cleanup();
+    return ok;
+}
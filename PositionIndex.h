@@ -0,0 +1,63 @@
+#pragma once
+#include <QFile>
+#include <QString>
+#include <cstdint>
+#include <vector>
+#include "GameDatabase.h"
+
+// 局面索引条目：某局第ply步之前到达局面key，随后走了move（终局为NO_MOVE）
+// 文件按(key, move, result, game)排序，同一局面同一着法的同一结果连续存放
+struct PositionIndexEntry {
+    uint64_t key;
+    uint32_t game;
+    uint16_t move;
+    uint8_t ply;          // 超过255步的饱和到255
+    GameResult result;
+};
+static_assert(sizeof(PositionIndexEntry) == 16, "PositionIndexEntry must stay 16 bytes on disk");
+
+// 某局面下一着的统计
+struct ExplorerMove {
+    Move move;
+    uint32_t games = 0;
+    uint32_t redWins = 0;
+    uint32_t blackWins = 0;
+    uint32_t draws = 0;
+};
+
+// 对局库的局面索引（.xpi）：通过mmap打开，二分查找定位局面
+// 统计不逐条扫描：每个着法及其每种结果的边界各用一次二分查找，热门局面也只需几十次探查
+class PositionIndex
+{
+public:
+    PositionIndex() = default;
+    ~PositionIndex();
+    PositionIndex(const PositionIndex&) = delete;
+    PositionIndex& operator=(const PositionIndex&) = delete;
+
+    bool open(const QString& path);
+    void close();
+    bool isOpen() const { return m_entries != nullptr; }
+    uint32_t size() const { return m_count; }
+    uint32_t gameCount() const { return m_gameCount; }    // 建索引时对局库中的局数
+
+    // 各下一着的统计，按对局数降序；totalGames为到达该局面的次数（含在该局面结束的对局）
+    std::vector<ExplorerMove> moves(uint64_t key, uint32_t* totalGames = nullptr) const;
+    // 到达该局面的前limit个对局编号（同一局重复到达只计一次）
+    std::vector<uint32_t> games(uint64_t key, size_t limit) const;
+
+    // 离线构建：条目攒满runEntries条排序后写成临时顺串，全部读完后多路归并为索引文件
+    static bool build(const GameDatabase& database, const QString& path, int maxPlies = 80,
+                      size_t runEntries = size_t(1) << 22);
+    static QString indexPath(const QString& databasePath);
+
+private:
+    PositionIndexEntry entryAt(uint32_t index) const;
+    // 在[lo, hi)中找第一个不小于(key, move, result)的条目
+    uint32_t lowerBound(uint32_t lo, uint32_t hi, uint64_t key, uint16_t move, uint8_t result) const;
+
+    QFile m_file;
+    const uchar* m_entries = nullptr;
+    uint32_t m_count = 0;
+    uint32_t m_gameCount = 0;
+};
@@ -0,0 +1,369 @@
+// 残局题目挖掘工具：在棋谱与自对弈对局中寻找只有一着能取胜的局面，写成残局目录(endgames.tsv)
+//
+// 每个局面先用少量节点粗筛：杀棋求解器找到连杀，或双变例搜索中最佳着明显胜势而次佳着不是；
+// 候选局面再以更深的搜索验证唯一性，按求解深度与节点数评定难度(1~5)
+// 输入可为文本棋谱（.pgn等）或对局库（.xdb），各线程按局领取，局面键值相同的题目只保留一次
+//
+// 用法：puzzleMiner [-o puzzles.tsv] [--self-play 0] [--min-ply 16] [--verify-depth 9] [-j 线程数] 棋谱文件...
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include "EndgameCatalog.h"
+#include "GameDatabase.h"
+#include "GameRecord.h"
+#include "MateSolver.h"
+#include "Search.h"
+
+namespace {
+
+struct MinerOptions {
+    int minPly = 16;                 // 跳过开局阶段
+    int minMate = 2;                 // 一步杀太简单，不收录
+    int winScore = 500;              // 最佳着至少取得的优势（约一车）
+    int gap = 300;                   // 最佳着与次佳着至少相差的分数
+    uint64_t quickNodes = 20000;     // 粗筛节点数
+    int verifyDepth = 9;
+    uint64_t verifyNodes = 2000000;
+    uint64_t mateNodes = 500000;     // 验证连杀与其他将军着的节点上限
+};
+
+struct Puzzle {
+    uint64_t key = 0;
+    std::string fen;
+    Move move = NO_MOVE;
+    int mateInMoves = 0;             // 0表示非连杀题
+    int solveDepth = 0;              // 半回合
+    uint64_t nodes = 0;
+    int difficulty = 1;
+    QString source;
+};
+
+// 游戏来源：一局的着法序列与出处说明
+struct SourceGame {
+    std::vector<Move> moves;
+    std::string fen;
+    QString source;
+};
+
+int difficultyOf(int solveDepth, uint64_t nodes)
+{
+    int difficulty = solveDepth <= 1 ? 1 : solveDepth <= 3 ? 2 : solveDepth <= 5 ? 3 : solveDepth <= 8 ? 4 : 5;
+    if (nodes > 1000000) ++difficulty;
+    return std::min(difficulty, 5);
+}
+
+class Miner
+{
+public:
+    explicit Miner(const MinerOptions& options)
+        : m_options(options), m_solver(18), m_searcher(18)
+    {}
+
+    // 扫描一局，命中后跳过随后几步，避免同一段杀法产生多道题
+    void mineGame(const SourceGame& game, std::vector<Puzzle>& found)
+    {
+        Position pos;
+        if (game.fen.empty()) pos = Position::startPosition();
+        else if (!pos.fromFen(game.fen)) return;
+
+        int skipUntil = m_options.minPly;
+        for (size_t ply = 0; ply < game.moves.size(); ++ply) {
+            if (int(ply) >= skipUntil) {
+                Puzzle puzzle;
+                if (examine(pos, puzzle)) {
+                    puzzle.source = game.source + QString(" 第%1步").arg(ply + 1);
+                    found.push_back(std::move(puzzle));
+                    skipUntil = int(ply) + 8;
+                }
+            }
+            if (!pos.isLegalMove(game.moves[ply])) break;
+            pos.makeMove(game.moves[ply]);
+        }
+    }
+
+    // 以少量节点的搜索自对弈一局；前几步随机，使各局分开
+    SourceGame selfPlay(uint64_t seed, uint64_t nodes, int maxPlies)
+    {
+        SourceGame game;
+        game.source = QString("自对弈 #%1").arg(seed);
+        std::mt19937_64 rng(seed);
+        Position pos = Position::startPosition();
+        std::vector<HistoryEntry> history{ { pos.key(), NO_MOVE, false, true } };
+        m_searcher.clearHash();
+
+        SearchLimits limits;
+        limits.nodes = nodes;
+        Move moves[MAX_MOVES];
+        for (int ply = 0; ply < maxPlies; ++ply) {
+            const int count = pos.generateLegalMoves(moves);
+            if (count == 0 || repetitionCount(history) >= 3) break;
+
+            Move move = ply < 4 ? moves[rng() % count]
+                                : m_searcher.search(pos, history, limits).bestMove;
+            if (move == NO_MOVE) break;
+            const uint8_t captured = pos.makeMove(move);
+            history.push_back({ pos.key(), move, pos.isInCheck(pos.sideToMove()), captured != 0 });
+            game.moves.push_back(move);
+        }
+        return game;
+    }
+
+private:
+    bool examine(Position& pos, Puzzle& puzzle)
+    {
+        Move moves[MAX_MOVES];
+        if (pos.generateLegalMoves(moves) < 2) return false;
+
+        // 粗筛：连杀优先，其次是双变例搜索中唯一的胜着
+        MateResult mate = m_solver.solve(pos, m_options.quickNodes);
+        const bool isMate = mate.found && !mate.aborted && !mate.pv.empty();
+        if (isMate && mate.mateInMoves < m_options.minMate) return false;
+
+        SearchLimits limits;
+        limits.multiPv = 2;
+        if (!isMate) {
+            limits.nodes = m_options.quickNodes;
+            limits.depth = m_options.verifyDepth;
+            if (!uniqueWin(m_searcher.search(pos, {}, limits), NO_MOVE)) return false;
+        }
+
+        // 验证：更深的双变例搜索中没有第二个胜着；记录最佳着稳定下来的深度
+        int stableDepth = 0;
+        Move lastBest = NO_MOVE;
+        m_searcher.setProgressCallback([&](const SearchResult& r) {
+            if (r.bestMove != lastBest) {
+                lastBest = r.bestMove;
+                stableDepth = r.depth;
+            }
+        });
+        limits.nodes = m_options.verifyNodes;
+        limits.depth = m_options.verifyDepth;
+        const SearchResult verified = m_searcher.search(pos, {}, limits);
+        m_searcher.setProgressCallback(nullptr);
+
+        if (isMate) {
+            // 搜索看不到的深杀以求解器为准，但其他着法不能也是胜着
+            const Move key = mate.pv.front();
+            if (!uniqueWin(verified, key) || otherCheckMates(pos, key)) return false;
+            MateResult full = m_solver.solve(pos, m_options.mateNodes);
+            if (!full.found) return false;
+            puzzle.move = key;
+            puzzle.mateInMoves = full.mateInMoves;
+            puzzle.solveDepth = 2 * full.mateInMoves - 1;
+            puzzle.nodes = full.nodes;
+        } else {
+            if (!uniqueWin(verified, NO_MOVE)) return false;
+            puzzle.move = verified.bestMove;
+            puzzle.solveDepth = stableDepth;
+            puzzle.nodes = verified.nodes;
+        }
+
+        puzzle.key = pos.key();
+        puzzle.fen = pos.toFen();
+        puzzle.difficulty = difficultyOf(puzzle.solveDepth, puzzle.nodes);
+        return true;
+    }
+
+    // expected为NO_MOVE时要求最佳着本身取胜；否则要求除expected外没有取胜的着法
+    bool uniqueWin(const SearchResult& result, Move expected) const
+    {
+        if (result.lines.empty()) return false;
+        const SearchLine& best = result.lines.front();
+        if (expected == NO_MOVE) {
+            if (best.pv.empty() || best.score < m_options.winScore) return false;
+            if (result.lines.size() < 2) return true;
+            const SearchLine& second = result.lines[1];
+            return second.score < m_options.winScore && best.score - second.score >= m_options.gap;
+        }
+        for (const SearchLine& line : result.lines)
+            if (!line.pv.empty() && line.pv.front() != expected && line.score >= m_options.winScore)
+                return false;
+        return true;
+    }
+
+    // 其他将军着之后守方的每个应着是否都仍被连杀（即存在第二条杀法）
+    bool otherCheckMates(Position& pos, Move solution)
+    {
+        Move moves[MAX_MOVES];
+        const int count = pos.generateLegalMoves(moves);
+        for (int i = 0; i < count; ++i) {
+            if (moves[i] == solution) continue;
+            const uint8_t captured = pos.makeMove(moves[i]);
+            bool mates = false;
+            if (pos.isInCheck(pos.sideToMove())) {
+                Move replies[MAX_MOVES];
+                const int replyCount = pos.generateLegalMoves(replies);
+                mates = true;
+                for (int j = 0; j < replyCount && mates; ++j) {
+                    const uint8_t replyCaptured = pos.makeMove(replies[j]);
+                    mates = m_solver.solve(pos, m_options.mateNodes / 8).found;
+                    pos.unmakeMove(replies[j], replyCaptured);
+                }
+            }
+            pos.unmakeMove(moves[i], captured);
+            if (mates) return true;
+        }
+        return false;
+    }
+
+    const MinerOptions& m_options;
+    MateSolver m_solver;
+    Searcher m_searcher;
+};
+
+// 各线程按局领取下标[0, count)，fn(线程号, 下标)
+void parallelFor(size_t count, int threadCount, const std::function<void(int, size_t)>& fn)
+{
+    std::atomic<size_t> next{ 0 };
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threadCount; ++t) {
+        workers.emplace_back([&, t] {
+            for (size_t i = next++; i < count; i = next++)
+                fn(t, i);
+        });
+    }
+    for (std::thread& worker : workers)
+        worker.join();
+}
+
+QString puzzleName(const Puzzle& puzzle)
+{
+    const QString side = puzzle.fen.back() == 'b' ? "黑先" : "红先";
+    const QString tag = QString::number(puzzle.key & 0xffffff, 16).rightJustified(6, '0');
+    if (puzzle.mateInMoves > 0)
+        return side + QString("%1步杀 %2").arg(puzzle.mateInMoves).arg(tag);
+    return side + "取胜 " + tag;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("puzzleMiner");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Mine single-solution tactical puzzles from game collections");
+    parser.addHelpOption();
+    QCommandLineOption outputOption({ "o", "output" }, "Output endgame catalog.", "file", "puzzles.tsv");
+    QCommandLineOption selfPlayOption("self-play", "Number of self-play games to generate and mine.", "n", "0");
+    QCommandLineOption selfPlayNodesOption("self-play-nodes", "Search nodes per self-play move.", "n", "20000");
+    QCommandLineOption minPlyOption("min-ply", "Skip positions before this ply.", "n", "16");
+    QCommandLineOption quickNodesOption("quick-nodes", "Nodes for the first screening search.", "n", "20000");
+    QCommandLineOption verifyDepthOption("verify-depth", "Depth of the verification search.", "n", "9");
+    QCommandLineOption threadsOption({ "j", "threads" }, "Worker threads.", "n",
+                                     QString::number(std::max(1u, std::thread::hardware_concurrency())));
+    parser.addOptions({ outputOption, selfPlayOption, selfPlayNodesOption, minPlyOption,
+                        quickNodesOption, verifyDepthOption, threadsOption });
+    parser.addPositionalArgument("games", "Game collection files (.pgn or .xdb).", "[games...]");
+    parser.process(app);
+
+    const QStringList inputs = parser.positionalArguments();
+    const int selfPlayGames = parser.value(selfPlayOption).toInt();
+    if (inputs.isEmpty() && selfPlayGames <= 0)
+        parser.showHelp(1);
+
+    MinerOptions options;
+    options.minPly = parser.value(minPlyOption).toInt();
+    options.quickNodes = parser.value(quickNodesOption).toULongLong();
+    options.verifyDepth = parser.value(verifyDepthOption).toInt();
+    const int threadCount = std::max(1, parser.value(threadsOption).toInt());
+
+    QTextStream out(stdout);
+    std::vector<std::unique_ptr<Miner>> miners;
+    for (int t = 0; t < threadCount; ++t)
+        miners.push_back(std::make_unique<Miner>(options));
+
+    std::vector<std::vector<Puzzle>> partial(threadCount);
+    std::mutex seenMutex;
+    std::unordered_set<uint64_t> seen;
+    auto collect = [&](int t, const SourceGame& game) {
+        std::vector<Puzzle> found;
+        miners[t]->mineGame(game, found);
+        std::lock_guard<std::mutex> lock(seenMutex);
+        for (Puzzle& puzzle : found)
+            if (seen.insert(puzzle.key).second)
+                partial[t].push_back(std::move(puzzle));
+    };
+
+    size_t gameCount = 0;
+    for (const QString& input : inputs) {
+        const QString fileName = QFileInfo(input).fileName();
+        if (input.endsWith(".xdb")) {
+            GameDatabase database;
+            if (!database.open(input)) {
+                out << "cannot read " << input << Qt::endl;
+                return 1;
+            }
+            gameCount += database.count();
+            parallelFor(database.count(), threadCount, [&](int t, size_t i) {
+                GameRecord record;
+                if (!database.game(uint32_t(i), record)) return;
+                collect(t, { record.moves, record.fen, fileName + QString(" 第%1局").arg(i + 1) });
+            });
+        } else {
+            QFile file(input);
+            if (!file.open(QIODevice::ReadOnly)) {
+                out << "cannot read " << input << Qt::endl;
+                return 1;
+            }
+            std::vector<SourceGame> games;
+            GameRecordReader reader(&file);
+            GameRecord record;
+            while (reader.next(record))
+                games.push_back({ record.moves, record.fen, fileName + QString(" 第%1局").arg(games.size() + 1) });
+            gameCount += games.size();
+            parallelFor(games.size(), threadCount, [&](int t, size_t i) { collect(t, games[i]); });
+        }
+    }
+
+    if (selfPlayGames > 0) {
+        const uint64_t nodes = parser.value(selfPlayNodesOption).toULongLong();
+        gameCount += selfPlayGames;
+        parallelFor(size_t(selfPlayGames), threadCount, [&](int t, size_t i) {
+            collect(t, miners[t]->selfPlay(i + 1, nodes, 240));
+        });
+    }
+
+    std::vector<Puzzle> puzzles;
+    for (auto& list : partial)
+        for (Puzzle& puzzle : list)
+            puzzles.push_back(std::move(puzzle));
+    std::sort(puzzles.begin(), puzzles.end(), [](const Puzzle& a, const Puzzle& b) {
+        return a.difficulty != b.difficulty ? a.difficulty < b.difficulty : a.key < b.key;
+    });
+
+    const QString outputPath = parser.value(outputOption);
+    QFile file(outputPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        out << "cannot write " << outputPath << Qt::endl;
+        return 1;
+    }
+    QTextStream catalog(&file);
+    catalog << "# 由puzzleMiner生成：编号\t名称\t难度\tFEN\t说明\t解着" << Qt::endl;
+    for (const Puzzle& puzzle : puzzles) {
+        EndgameEntry entry;
+        entry.id = "mined-" + QString::number(puzzle.key, 16).rightJustified(16, '0');
+        entry.name = puzzleName(puzzle);
+        entry.difficulty = puzzle.difficulty;
+        entry.fen = QString::fromStdString(puzzle.fen);
+        entry.description = QString("源自%1").arg(puzzle.source);
+        entry.solution = QString::fromStdString(Position::moveToIccs(puzzle.move));
+        catalog << EndgameCatalog::formatEntry(entry) << Qt::endl;
+    }
+
+    out << gameCount << " games scanned, " << puzzles.size() << " puzzles written to " << outputPath << Qt::endl;
+    return 0;
+}
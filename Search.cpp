@@ -0,0 +1,590 @@
+#include "Search.h"
+#include "BoardKernels.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+
+namespace {
+
+const int kPieceValues[8] = { 0, 0, 150, 150, 300, 500, 300, 100 };
+
+inline bool soldierCrossed(uint8_t piece, int sq)
+{
+    return pieceSide(piece) == SIDE_RED ? squareY(sq) <= 4 : squareY(sq) >= 5;
+}
+
+inline int pieceValue(uint8_t piece, int sq)
+{
+    if (pieceType(piece) == PT_SOLDIER)
+        return soldierCrossed(piece, sq) ? 200 : 100;
+    return kPieceValues[pieceType(piece)];
+}
+
+// 子力按格展开的表（红方为正、黑方为负），供棋盘计算核心整盘求和
+const PieceSquareTable& materialTable()
+{
+    static const PieceSquareTable table = [] {
+        PieceSquareTable t = {};
+        for (int piece = 1; piece < 16; ++piece) {
+            if (!pieceType(uint8_t(piece))) continue;
+            for (int sq = 0; sq < 90; ++sq) {
+                const int value = pieceValue(uint8_t(piece), sq);
+                t.v[piece][sq] = int16_t(pieceSide(uint8_t(piece)) == SIDE_RED ? value : -value);
+            }
+        }
+        return t;
+    }();
+    return table;
+}
+
+int64_t nowMs()
+{
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// 走子后，该子能吃到的对方棋子（不含将帅）
+int attackedTargets(const Position& pos, int sq, int side, int* targets)
+{
+    Position copy = pos;
+    copy.setSideToMove(side);
+    Move captures[MAX_MOVES];
+    int count = copy.generateCaptures(captures);
+    int n = 0;
+    for (int i = 0; i < count; ++i) {
+        if (moveFrom(captures[i]) != sq) continue;
+        int target = moveTo(captures[i]);
+        if (pieceType(pos.pieceAt(target)) != PT_KING)
+            targets[n++] = target;
+    }
+    return n;
+}
+
+// 捉：走动的子新攻击到对方的无根子，或攻击价值更高的子
+// 将帅与兵的攻击不算捉，未过河的兵也不算被捉
+bool isChase(const Position& before, const Position& after, Move m)
+{
+    const int from = moveFrom(m), to = moveTo(m);
+    const uint8_t piece = after.pieceAt(to);
+    const int type = pieceType(piece);
+    if (type == PT_KING || type == PT_SOLDIER) return false;
+
+    const int side = pieceSide(piece);
+    int oldTargets[MAX_MOVES], newTargets[MAX_MOVES];
+    int oldCount = attackedTargets(before, from, side, oldTargets);
+    int newCount = attackedTargets(after, to, side, newTargets);
+    for (int i = 0; i < newCount; ++i) {
+        int target = newTargets[i];
+        if (std::find(oldTargets, oldTargets + oldCount, target) != oldTargets + oldCount) continue;
+
+        uint8_t victim = after.pieceAt(target);
+        if (pieceType(victim) == PT_SOLDIER && !soldierCrossed(victim, target)) continue;
+        if (kPieceValues[pieceType(victim)] > kPieceValues[type]) return true;
+        if (!after.isSquareAttacked(target, side ^ 1)) return true;
+    }
+    return false;
+}
+
+// 吃子后静态交换是否亏子；用不比被吃子贵的子去吃不会亏，不必计算
+inline bool losingCapture(const Position& pos, Move m)
+{
+    const int to = moveTo(m);
+    if (pieceValue(pos.pieceAt(moveFrom(m)), to) <= pieceValue(pos.pieceAt(to), to)) return false;
+    return staticExchange(pos, m) < 0;
+}
+
+// 杀棋分按距根节点的步数存储，读出时换算回当前层
+inline int scoreToTable(int score, int ply)
+{
+    if (score >= Searcher::kWinValue) return score + ply;
+    if (score <= -Searcher::kWinValue) return score - ply;
+    return score;
+}
+
+inline int scoreFromTable(int score, int ply)
+{
+    if (score >= Searcher::kWinValue) return score - ply;
+    if (score <= -Searcher::kWinValue) return score + ply;
+    return score;
+}
+
+} // namespace
+
+TranspositionTable::TranspositionTable(int bits)
+    : m_entries(size_t(1) << bits)
+    , m_mask((uint64_t(1) << bits) - 1)
+{}
+
+const TranspositionTable::Entry* TranspositionTable::probe(uint64_t key) const
+{
+    const Entry& entry = m_entries[key & m_mask];
+    return entry.key == key && entry.bound != BoundNone ? &entry : nullptr;
+}
+
+void TranspositionTable::store(uint64_t key, Move move, int score, int depth, Bound bound)
+{
+    Entry& entry = m_entries[key & m_mask];
+    if (entry.key == key && depth < entry.depth && bound != BoundExact) {
+        if (move != NO_MOVE) entry.move = move;
+        return;
+    }
+    if (move == NO_MOVE && entry.key == key) move = entry.move;
+    entry.key = key;
+    entry.move = move;
+    entry.score = int16_t(score);
+    entry.depth = int8_t(depth);
+    entry.bound = bound;
+}
+
+void TranspositionTable::clear()
+{
+    std::fill(m_entries.begin(), m_entries.end(), Entry());
+}
+
+int findRepetition(const std::vector<HistoryEntry>& history, int from)
+{
+    const int n = from < 0 ? int(history.size()) - 1 : from;
+    if (n < 0) return -1;
+    const uint64_t key = history[n].key;
+    for (int i = n - 2; i >= 0; i -= 2) {
+        if (history[i + 1].capture || history[i + 2].capture) break;
+        if (history[i].key == key) return i;
+    }
+    return -1;
+}
+
+int repetitionCount(const std::vector<HistoryEntry>& history)
+{
+    int count = history.empty() ? 0 : 1;
+    for (int i = findRepetition(history); i >= 0; i = findRepetition(history, i))
+        ++count;
+    return count;
+}
+
+RepetitionResult judgeRepetition(const Position& pos, const std::vector<HistoryEntry>& history, int cycleStart)
+{
+    const int last = int(history.size()) - 1;
+    if (cycleStart < 0 || cycleStart >= last) return RepetitionResult::None;
+
+    const int us = pos.sideToMove(), them = us ^ 1;
+
+    // 先看长将，只用记录中的将军标志
+    bool allCheck[2] = { true, true };
+    int mover = them;
+    for (int i = last; i > cycleStart; --i, mover ^= 1)
+        allCheck[mover] = allCheck[mover] && history[i].check;
+    if (allCheck[us] != allCheck[them])
+        return allCheck[us] ? RepetitionResult::Loss : RepetitionResult::Win;
+    if (allCheck[us])
+        return RepetitionResult::Draw;
+
+    // 再看长捉：循环内没有吃子，逐步撤销着法还原每一步前后的局面
+    bool allChase[2] = { true, true };
+    Position after = pos;
+    mover = them;
+    for (int i = last; i > cycleStart; --i, mover ^= 1) {
+        Position before = after;
+        before.unmakeMove(history[i].move, 0);
+        if (allChase[mover])
+            allChase[mover] = history[i].check || isChase(before, after, history[i].move);
+        after = before;
+    }
+    if (allChase[us] != allChase[them])
+        return allChase[us] ? RepetitionResult::Loss : RepetitionResult::Win;
+    return RepetitionResult::Draw;
+}
+
+int staticExchange(const Position& pos, Move m)
+{
+    Position board = pos;
+    const int to = moveTo(m);
+    int side = pieceSide(board.pieceAt(moveFrom(m)));
+    int gain[34];
+    int depth = 0;
+    gain[0] = board.pieceAt(to) ? pieceValue(board.pieceAt(to), to) : 0;
+    board.makeMove(m);
+
+    for (;;) {
+        side ^= 1;
+        const int from = board.leastValuableAttacker(to, side);
+        if (from < 0) break;
+        const uint8_t victim = board.pieceAt(to);
+        const Move recapture = encodeMove(from, to);
+        const uint8_t captured = board.makeMove(recapture);
+        if (pieceType(board.pieceAt(to)) == PT_KING && board.isSquareAttacked(to, side ^ 1)) {
+            board.unmakeMove(recapture, captured);
+            break;
+        }
+        ++depth;
+        gain[depth] = pieceValue(victim, to) - gain[depth - 1];
+    }
+
+    // 自后向前：每一方在继续吃与停下之间取较好者
+    for (; depth > 0; --depth)
+        gain[depth - 1] = -std::max(-gain[depth - 1], gain[depth]);
+    return gain[0];
+}
+
+int evaluatePosition(const Position& pos)
+{
+    SquareMap board;
+    BoardKernels::loadBoard(pos, board);
+    const int score = BoardKernels::pieceSquareSum(board, materialTable());
+    return pos.sideToMove() == SIDE_RED ? score : -score;
+}
+
+Searcher::Searcher(int hashBits)
+    : m_tt(hashBits)
+{
+    m_repFilter.fill(0);
+    if (NnueNetwork::defaultNetwork().isOpen())
+        m_net = &NnueNetwork::defaultNetwork();
+}
+
+SearchResult Searcher::search(const Position& root, const std::vector<HistoryEntry>& history,
+                              const SearchLimits& limits, const std::atomic<bool>* stop,
+                              const std::atomic<bool>* ponderHit)
+{
+    m_pos = root;
+    if (!history.empty() && history.back().key == root.key()) {
+        m_history = history;
+    } else {
+        m_history.clear();
+        m_history.push_back({ root.key(), NO_MOVE, root.isInCheck(root.sideToMove()), true });
+    }
+    m_history.reserve(m_history.size() + kMaxPly + 2);
+
+    // 过滤表只统计最近一次吃子之后的局面
+    m_repFilter.fill(0);
+    for (int i = int(m_history.size()) - 1; i >= 0; --i) {
+        ++m_repFilter[m_history[i].key & 4095];
+        if (m_history[i].capture) break;
+    }
+
+    for (auto& killers : m_killers)
+        killers = { NO_MOVE, NO_MOVE };
+    m_prevPv.clear();
+    m_limits = limits;
+    m_stop = stop;
+    m_ponderHit = ponderHit;
+    m_pondering = ponderHit && !ponderHit->load();
+    m_deadline = limits.timeMs > 0 && !m_pondering ? nowMs() + limits.timeMs : 0;
+    m_nodes = 0;
+    m_nodeBase = 0;
+    m_aborted = false;
+    if (m_net) {
+        m_nnueTop = 0;
+        m_net->refresh(m_pos, SIDE_RED, m_accumulators[0]);
+        m_net->refresh(m_pos, SIDE_BLACK, m_accumulators[0]);
+        m_nnueSteps[0] = { NO_MOVE, 0, 0, { true, true } };
+    }
+
+    SearchResult result;
+    Move rootMoves[MAX_MOVES];
+    const int rootCount = m_pos.generateLegalMoves(rootMoves);
+    if (rootCount == 0) {
+        result.score = -kMateValue;
+        return result;
+    }
+
+    const int lineCount = std::clamp(limits.multiPv, 1, rootCount);
+    for (int depth = 1; depth <= limits.depth; ++depth) {
+        // 多变例：每条变例在根节点排除前面各条的首着后重新搜索
+        std::vector<SearchLine> lines;
+        m_excluded.clear();
+        for (int k = 0; k < lineCount; ++k) {
+            int score = alphaBeta(depth, 0, -kMateValue, kMateValue);
+            if (m_aborted || m_pvLength[0] == 0) break;
+            lines.push_back({ score, std::vector<Move>(m_pvTable[0].begin(), m_pvTable[0].begin() + m_pvLength[0]) });
+            m_excluded.push_back(lines.back().pv.front());
+        }
+        if (m_aborted) break;
+
+        std::stable_sort(lines.begin(), lines.end(),
+                         [](const SearchLine& a, const SearchLine& b) { return a.score > b.score; });
+        result.depth = depth;
+        result.score = lines.front().score;
+        result.pv = lines.front().pv;
+        result.bestMove = result.pv.front();
+        result.lines = std::move(lines);
+        result.nodes = m_nodes;
+        m_prevPv = result.pv;
+        if (m_progress)
+            m_progress(result);
+
+        // 已找到杀棋或长将判负，继续加深没有意义
+        if (lineCount == 1 && std::abs(result.score) >= kWinValue) break;
+    }
+
+    if (result.bestMove == NO_MOVE)
+        result.bestMove = rootMoves[0];
+    result.nodes = m_nodes;
+    return result;
+}
+
+bool Searcher::timeUp()
+{
+    if (m_stop && m_stop->load(std::memory_order_relaxed)) return true;
+    if (m_pondering) {
+        if (!m_ponderHit->load(std::memory_order_relaxed)) return false;
+        // 猜中对手应着：后台思考转为正式思考，时间与节点从此刻算起
+        m_pondering = false;
+        m_deadline = m_limits.timeMs > 0 ? nowMs() + m_limits.timeMs : 0;
+        m_nodeBase = m_nodes;
+    }
+    if (m_limits.nodes && m_nodes - m_nodeBase >= m_limits.nodes) return true;
+    return m_deadline && nowMs() >= m_deadline;
+}
+
+void Searcher::pushHistory(Move m, uint8_t captured, bool check)
+{
+    const uint64_t key = m_pos.key();
+    m_history.push_back({ key, m, check, captured != 0 });
+    ++m_repFilter[key & 4095];
+    if (m_net)
+        m_nnueSteps[++m_nnueTop] = { m, m_pos.pieceAt(moveTo(m)), captured, { false, false } };
+}
+
+void Searcher::popHistory()
+{
+    --m_repFilter[m_history.back().key & 4095];
+    m_history.pop_back();
+    if (m_net)
+        --m_nnueTop;
+}
+
+int Searcher::evaluate()
+{
+    if (!m_net) return evaluatePosition(m_pos);
+
+    NnueAccumulator& acc = m_accumulators[m_nnueTop];
+    for (int side = SIDE_RED; side <= SIDE_BLACK; ++side) {
+        if (m_nnueSteps[m_nnueTop].computed[side]) continue;
+
+        // 向前找到该视角已算好的一层；途中本方将帅走动过则特征桶已变，直接重算当前层
+        const uint8_t king = makePiece(side, PT_KING);
+        int base = m_nnueTop;
+        while (!m_nnueSteps[base].computed[side] && m_nnueSteps[base].moved != king)
+            --base;
+        if (!m_nnueSteps[base].computed[side]) {
+            m_net->refresh(m_pos, side, acc);
+        } else {
+            for (int i = base + 1; i <= m_nnueTop; ++i) {
+                const NnueStep& step = m_nnueSteps[i];
+                m_net->update(m_accumulators[i - 1], m_accumulators[i], side,
+                              step.move, step.moved, step.captured, m_pos.kingSquare(side));
+                m_nnueSteps[i].computed[side] = true;
+            }
+        }
+        m_nnueSteps[m_nnueTop].computed[side] = true;
+    }
+    return std::clamp(m_net->evaluate(acc, m_pos.sideToMove()), -kWinValue + 1, kWinValue - 1);
+}
+
+bool Searcher::repetitionScore(int ply, int& score)
+{
+    if (m_repFilter[m_pos.key() & 4095] < 2) return false;
+
+    int start = findRepetition(m_history);
+    if (start < 0) return false;
+
+    switch (judgeRepetition(m_pos, m_history, start)) {
+    case RepetitionResult::Win:
+        score = kBanValue - ply;
+        break;
+    case RepetitionResult::Loss:
+        score = ply - kBanValue;
+        break;
+    default:
+        score = 0;
+        break;
+    }
+    return true;
+}
+
+int Searcher::orderMoves(Move* moves, int count, int ply, Move firstMove) const
+{
+    int scores[MAX_MOVES];
+    int losing = 0;
+    for (int i = 0; i < count; ++i) {
+        Move m = moves[i];
+        uint8_t victim = m_pos.pieceAt(moveTo(m));
+        if (m == firstMove) {
+            scores[i] = 1000000;
+        } else if (victim) {
+            // MVV-LVA：先吃价值高的子，再用价值低的子去吃；静态交换亏子的吃子排在所有不吃子着法之后
+            const int mvvLva = kPieceValues[pieceType(victim)] * 10 - kPieceValues[pieceType(m_pos.pieceAt(moveFrom(m)))];
+            const bool bad = losingCapture(m_pos, m);
+            scores[i] = (bad ? -100000 : 100000) + mvvLva;
+            losing += bad;
+        } else if (m == m_killers[ply][0]) {
+            scores[i] = 90000;
+        } else if (m == m_killers[ply][1]) {
+            scores[i] = 80000;
+        } else {
+            scores[i] = 0;
+        }
+    }
+
+    // 着法数量很少，插入排序即可
+    for (int i = 1; i < count; ++i) {
+        Move m = moves[i];
+        int s = scores[i];
+        int j = i - 1;
+        for (; j >= 0 && scores[j] < s; --j) {
+            moves[j + 1] = moves[j];
+            scores[j + 1] = scores[j];
+        }
+        moves[j + 1] = m;
+        scores[j + 1] = s;
+    }
+    return count - losing;
+}
+
+int Searcher::alphaBeta(int depth, int ply, int alpha, int beta)
+{
+    m_pvLength[ply] = ply;
+
+    int repetition;
+    if (ply > 0 && repetitionScore(ply, repetition))
+        return repetition;
+
+    const int us = m_pos.sideToMove();
+    const bool inCheck = ply == 0 ? m_pos.isInCheck(us) : m_history.back().check;
+    if (inCheck) ++depth; // 将军延伸
+    if (depth <= 0 || ply >= kMaxPly)
+        return quiescence(ply, alpha, beta);
+
+    if ((++m_nodes & 1023) == 0 && timeUp())
+        m_aborted = true;
+    if (m_aborted) return 0;
+
+    // 根节点不用置换表：多变例需要排除着法，且主要变例由上次迭代给出
+    const bool pvNode = beta - alpha > 1;
+    const uint64_t key = m_pos.key();
+    Move hashMove = NO_MOVE;
+    if (ply > 0) {
+        if (const TranspositionTable::Entry* entry = m_tt.probe(key)) {
+            hashMove = entry->move;
+            if (!pvNode && entry->depth >= depth) {
+                int score = scoreFromTable(entry->score, ply);
+                if (entry->bound == TranspositionTable::BoundExact)
+                    return score;
+                if (entry->bound == TranspositionTable::BoundLower && score >= beta)
+                    return beta;
+                if (entry->bound == TranspositionTable::BoundUpper && score <= alpha)
+                    return alpha;
+            }
+        }
+    }
+
+    Move moves[MAX_MOVES];
+    int count = m_pos.generateMoves(moves);
+    Move firstMove = hashMove;
+    if (firstMove == NO_MOVE && ply < int(m_prevPv.size()))
+        firstMove = m_prevPv[ply];
+    orderMoves(moves, count, ply, firstMove);
+
+    int legal = 0;
+    Move bestMove = NO_MOVE;
+    for (int i = 0; i < count; ++i) {
+        const Move m = moves[i];
+        if (ply == 0 && std::find(m_excluded.begin(), m_excluded.end(), m) != m_excluded.end())
+            continue;
+        uint8_t captured = m_pos.makeMove(m);
+        if (m_pos.isInCheck(us)) {
+            m_pos.unmakeMove(m, captured);
+            continue;
+        }
+        ++legal;
+        pushHistory(m, captured, m_pos.isInCheck(us ^ 1));
+        int score;
+        if (legal == 1) {
+            score = -alphaBeta(depth - 1, ply + 1, -beta, -alpha);
+        } else {
+            // 零窗口验证，超出alpha再用完整窗口重搜
+            score = -alphaBeta(depth - 1, ply + 1, -alpha - 1, -alpha);
+            if (score > alpha && score < beta)
+                score = -alphaBeta(depth - 1, ply + 1, -beta, -alpha);
+        }
+        popHistory();
+        m_pos.unmakeMove(m, captured);
+        if (m_aborted) return 0;
+
+        if (score > alpha) {
+            alpha = score;
+            bestMove = m;
+            m_pvTable[ply][ply] = m;
+            for (int j = ply + 1; j < m_pvLength[ply + 1]; ++j)
+                m_pvTable[ply][j] = m_pvTable[ply + 1][j];
+            m_pvLength[ply] = std::max(m_pvLength[ply + 1], ply + 1);
+            if (score >= beta) {
+                if (!captured && m != m_killers[ply][0]) {
+                    m_killers[ply][1] = m_killers[ply][0];
+                    m_killers[ply][0] = m;
+                }
+                if (ply > 0)
+                    m_tt.store(key, m, scoreToTable(beta, ply), depth, TranspositionTable::BoundLower);
+                return beta;
+            }
+        }
+    }
+
+    // 中国象棋无子可动即负（将死或困毙）
+    if (legal == 0) return ply == 0 ? alpha : ply - kMateValue;
+
+    if (ply > 0) {
+        m_tt.store(key, bestMove, scoreToTable(alpha, ply), depth,
+                   bestMove != NO_MOVE ? TranspositionTable::BoundExact : TranspositionTable::BoundUpper);
+    }
+    return alpha;
+}
+
+int Searcher::quiescence(int ply, int alpha, int beta)
+{
+    m_pvLength[ply] = ply;
+    if ((++m_nodes & 1023) == 0 && timeUp())
+        m_aborted = true;
+    if (m_aborted) return 0;
+
+    const int us = m_pos.sideToMove();
+    const bool inCheck = m_history.back().check;
+    if (ply >= kMaxPly) return evaluate();
+
+    // 未被将军时可以不吃子（站着不动的评估值）
+    if (!inCheck) {
+        int standPat = evaluate();
+        if (standPat >= beta) return beta;
+        alpha = std::max(alpha, standPat);
+    }
+
+    Move moves[MAX_MOVES];
+    int count = inCheck ? m_pos.generateMoves(moves) : m_pos.generateCaptures(moves);
+    // 亏子的吃子排在最后，不会比站着不动更好，不再搜索；被将军时除外
+    const int searched = orderMoves(moves, count, ply, NO_MOVE);
+    if (!inCheck) count = searched;
+
+    int legal = 0;
+    for (int i = 0; i < count; ++i) {
+        const Move m = moves[i];
+        uint8_t captured = m_pos.makeMove(m);
+        if (m_pos.isInCheck(us)) {
+            m_pos.unmakeMove(m, captured);
+            continue;
+        }
+        ++legal;
+        pushHistory(m, captured, m_pos.isInCheck(us ^ 1));
+        int score = -quiescence(ply + 1, -beta, -alpha);
+        popHistory();
+        m_pos.unmakeMove(m, captured);
+        if (m_aborted) return 0;
+
+        if (score > alpha) {
+            if (score >= beta) return beta;
+            alpha = score;
+        }
+    }
+
+    if (inCheck && legal == 0) return ply - kMateValue;
+    return alpha;
+}
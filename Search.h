@@ -0,0 +1,171 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "Nnue.h"
+#include "Position.h"
+
+// 对局或搜索路径上的一步：走子后的局面键值与该步的性质
+// 对局记录的第一项为初始局面（move为NO_MOVE，capture为true）
+struct HistoryEntry {
+    uint64_t key = 0;
+    Move move = NO_MOVE;
+    bool check = false;     // 该步将军
+    bool capture = false;   // 吃子：不可逆，重复检测不越过此步
+};
+
+// 循环局面裁决结果，以当前行棋方为视角
+enum class RepetitionResult {
+    None,
+    Draw,
+    Win,    // 对方长将或长捉
+    Loss    // 本方长将或长捉
+};
+
+// 在history末尾向前查找与当前局面相同的局面（只看同一方行棋、且中间无吃子），
+// 返回找到的下标，没有则返回-1
+int findRepetition(const std::vector<HistoryEntry>& history, int from = -1);
+
+// 当前局面在最近一段无吃子的历史中出现的次数（包括当前）
+int repetitionCount(const std::vector<HistoryEntry>& history);
+
+// 按亚洲规则（简化）裁决以cycleStart开始、history末尾结束的循环：
+// 一方着着将军而另一方不是，长将方负；双方都长将为和；
+// 否则一方着着将军或捉子（捉无根子或价值更高的子），另一方不是，长捉方负；其余为和
+// pos为history末尾对应的局面
+RepetitionResult judgeRepetition(const Position& pos, const std::vector<HistoryEntry>& history, int cycleStart);
+
+// 以行棋方为视角的子力评估：车500，马炮300，仕相150，兵100（过河200）
+int evaluatePosition(const Position& pos);
+
+// 静态交换评估：m吃子后双方在目标格上轮流用最便宜的子吃回，任一方可以随时停止，
+// 返回m一方净得的子力（同上的子力价值）。每次吃回后重新找攻击者，离开或进入线路的棋子
+// 会改变炮架；不考虑牵制与送将，将帅只在目标格无对方保护时吃回
+int staticExchange(const Position& pos, Move m);
+
+struct SearchLimits {
+    int depth = 64;
+    uint64_t nodes = 0;    // 0表示不限
+    int timeMs = 0;        // 0表示不限
+    int multiPv = 1;       // 输出前K条变例
+};
+
+struct SearchLine {
+    int score = 0;
+    std::vector<Move> pv;
+};
+
+struct SearchResult {
+    Move bestMove = NO_MOVE;
+    int score = 0;
+    int depth = 0;          // 最后完成的迭代深度
+    uint64_t nodes = 0;
+    std::vector<Move> pv;
+    std::vector<SearchLine> lines;   // 多变例时按分数从高到低排列，第一条即pv
+};
+
+// 置换表：按键值低位直接寻址，同一局面只在更深或精确结果时覆盖
+class TranspositionTable
+{
+public:
+    enum Bound : uint8_t {
+        BoundNone,
+        BoundUpper,
+        BoundLower,
+        BoundExact
+    };
+
+    struct Entry {
+        uint64_t key = 0;
+        Move move = NO_MOVE;
+        int16_t score = 0;
+        int8_t depth = 0;
+        uint8_t bound = BoundNone;
+    };
+
+    explicit TranspositionTable(int bits = 20);
+
+    const Entry* probe(uint64_t key) const;
+    void store(uint64_t key, Move move, int score, int depth, Bound bound);
+    void clear();
+
+private:
+    std::vector<Entry> m_entries;
+    uint64_t m_mask;
+};
+
+// 局面搜索：迭代加深 + PVS + 置换表 + 静态搜索
+// 搜索路径与对局历史共用一个键值栈，每个节点先用小过滤表判断是否可能重复，
+// 只有过滤表命中时才向前扫描，重复局面按长将/长捉规则计分
+// 评估：有NNUE网络时用网络（累加器随走子增量更新），否则用子力评估evaluatePosition
+class Searcher
+{
+public:
+    static constexpr int kMateValue = 30000;
+    static constexpr int kBanValue = kMateValue - 100;   // 长将、长捉判负，比杀棋分低
+    static constexpr int kWinValue = kBanValue - 100;    // 超过此值视为必胜或必负
+    static constexpr int kMaxPly = 64;
+
+    explicit Searcher(int hashBits = 20);
+
+    // history为对局记录，末尾对应root；为空时仅以root作为起点
+    // ponderHit非空时为后台思考：在其置位前不计时间与节点，置位后按limits从此刻起计
+    SearchResult search(const Position& root, const std::vector<HistoryEntry>& history,
+                        const SearchLimits& limits, const std::atomic<bool>* stop = nullptr,
+                        const std::atomic<bool>* ponderHit = nullptr);
+
+    // 每完成一次迭代回调一次（在搜索线程中调用）
+    using ProgressCallback = std::function<void(const SearchResult&)>;
+    void setProgressCallback(ProgressCallback callback) { m_progress = std::move(callback); }
+
+    // 置换表跨搜索保留，新对局时清空
+    void clearHash() { m_tt.clear(); }
+
+    // 默认使用NnueNetwork::defaultNetwork()（未打开时为nullptr）；nullptr表示只用子力评估
+    void setNetwork(const NnueNetwork* network) { m_net = network; }
+
+private:
+    int alphaBeta(int depth, int ply, int alpha, int beta);
+    int quiescence(int ply, int alpha, int beta);
+    // 返回排在亏子吃子之前的着法数
+    int orderMoves(Move* moves, int count, int ply, Move firstMove) const;
+    bool repetitionScore(int ply, int& score);
+    void pushHistory(Move m, uint8_t captured, bool check);
+    void popHistory();
+    bool timeUp();
+    int evaluate();
+
+    Position m_pos;
+    TranspositionTable m_tt;
+    ProgressCallback m_progress;
+    std::vector<Move> m_excluded;            // 多变例：根节点跳过已输出变例的首着
+    std::vector<HistoryEntry> m_history;
+    std::array<uint16_t, 4096> m_repFilter;   // 键值低12位计数，过滤绝大多数不重复的节点
+    std::array<std::array<Move, 2>, kMaxPly + 1> m_killers;
+    std::array<std::array<Move, kMaxPly + 1>, kMaxPly + 1> m_pvTable;
+    std::array<int, kMaxPly + 1> m_pvLength;
+    std::vector<Move> m_prevPv;              // 上一次迭代的主要变例，优先搜索
+
+    // NNUE累加器栈，下标为搜索路径上的层数；走子时只记下着法，评估时从最近算好的一层增量算起
+    struct NnueStep {
+        Move move;
+        uint8_t moved;
+        uint8_t captured;
+        bool computed[2];
+    };
+    const NnueNetwork* m_net = nullptr;
+    std::array<NnueAccumulator, kMaxPly + 2> m_accumulators;
+    std::array<NnueStep, kMaxPly + 2> m_nnueSteps;
+    int m_nnueTop = 0;
+
+    SearchLimits m_limits;
+    const std::atomic<bool>* m_stop = nullptr;
+    const std::atomic<bool>* m_ponderHit = nullptr;
+    bool m_pondering = false;
+    int64_t m_deadline = 0;
+    uint64_t m_nodes = 0;
+    uint64_t m_nodeBase = 0;
+    bool m_aborted = false;
+};
@@ -0,0 +1,138 @@
+// 对局服务压力测试：开若干连接，每个连接上开多局，所有局面都由服务端AI双方对走，
+// 统计每次go到bestmove的延迟分布与每秒走子数
+//
+// 用法：serverBench [-p 7070] [-c 连接数] [-g 每连接局数] [--plies 40] [--level 0]
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QTcpSocket>
+#include <QTextStream>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace {
+
+struct BenchStats {
+    std::vector<qint64> latencies;      // 毫秒
+    int finishedGames = 0;
+    int errors = 0;
+};
+
+// 一个连接：建好各局后对每局反复发go，收到bestmove后再发下一个，直到达到步数或终局
+class BenchClient : public QObject
+{
+public:
+    BenchClient(quint16 port, int games, int plies, int level, BenchStats& stats, std::function<void()> done)
+        : m_games(games), m_plies(plies), m_level(level), m_stats(stats), m_done(std::move(done))
+    {
+        connect(&m_socket, &QTcpSocket::connected, this, [this]() {
+            for (int i = 0; i < m_games; ++i)
+                m_socket.write("new\n");
+        });
+        connect(&m_socket, &QTcpSocket::readyRead, this, [this]() { onReadyRead(); });
+        connect(&m_socket, &QTcpSocket::errorOccurred, this, [this]() {
+            ++m_stats.errors;
+            if (m_games > 0) {
+                m_games = 0;
+                m_done();
+            }
+        });
+        m_socket.connectToHost(QHostAddress::LocalHost, port);
+    }
+
+private:
+    void go(const QByteArray& id)
+    {
+        m_started[id].start();
+        m_socket.write("go " + id + ' ' + QByteArray::number(m_level) + '\n');
+    }
+
+    void finishGame()
+    {
+        ++m_stats.finishedGames;
+        if (--m_games == 0) m_done();
+    }
+
+    void onReadyRead()
+    {
+        while (m_socket.canReadLine()) {
+            const QList<QByteArray> args = m_socket.readLine().trimmed().split(' ');
+            const QByteArray& kind = args.first();
+            if (kind == "ok" && args.size() > 1 && !m_plyCount.contains(args[1])) {
+                m_plyCount.insert(args[1], 0);
+                go(args[1]);
+            } else if (kind == "bestmove" && args.size() > 2) {
+                const QByteArray& id = args[1];
+                m_stats.latencies.push_back(m_started[id].elapsed());
+                const bool over = args[2] == "none" || args.last() == "mate" || args.last() == "stalemate";
+                if (over || ++m_plyCount[id] >= m_plies) {
+                    m_socket.write("close " + id + '\n');
+                    finishGame();
+                } else {
+                    go(id);
+                }
+            } else if (kind == "error") {
+                ++m_stats.errors;
+            }
+        }
+    }
+
+    QTcpSocket m_socket;
+    int m_games;
+    int m_plies;
+    int m_level;
+    BenchStats& m_stats;
+    std::function<void()> m_done;
+    QHash<QByteArray, int> m_plyCount;
+    QHash<QByteArray, QElapsedTimer> m_started;
+};
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("serverBench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Load-test a running chessServer with local clients");
+    parser.addHelpOption();
+    QCommandLineOption portOption({ "p", "port" }, "Server port.", "port", "7070");
+    QCommandLineOption clientsOption({ "c", "clients" }, "Connections.", "n", "16");
+    QCommandLineOption gamesOption({ "g", "games" }, "Games per connection.", "n", "8");
+    QCommandLineOption pliesOption("plies", "Engine moves per game.", "n", "40");
+    QCommandLineOption levelOption("level", "Engine level (0-4).", "n", "0");
+    parser.addOptions({ portOption, clientsOption, gamesOption, pliesOption, levelOption });
+    parser.process(app);
+
+    const int clients = std::max(1, parser.value(clientsOption).toInt());
+    int running = clients;
+    BenchStats stats;
+    QElapsedTimer timer;
+    timer.start();
+
+    std::vector<std::unique_ptr<BenchClient>> connections;
+    for (int i = 0; i < clients; ++i) {
+        connections.push_back(std::make_unique<BenchClient>(
+            quint16(parser.value(portOption).toUInt()), std::max(1, parser.value(gamesOption).toInt()),
+            parser.value(pliesOption).toInt(), parser.value(levelOption).toInt(), stats,
+            [&running]() { if (--running == 0) QCoreApplication::quit(); }));
+    }
+    app.exec();
+
+    QTextStream out(stdout);
+    std::sort(stats.latencies.begin(), stats.latencies.end());
+    auto percentile = [&stats](int p) {
+        return stats.latencies.empty() ? 0 : stats.latencies[(stats.latencies.size() - 1) * p / 100];
+    };
+    const qint64 elapsed = std::max<qint64>(1, timer.elapsed());
+    out << stats.finishedGames << " games, " << stats.latencies.size() << " engine moves in " << elapsed
+        << " ms (" << stats.latencies.size() * 1000 / elapsed << " moves/s), " << stats.errors << " errors" << Qt::endl;
+    out << "latency ms: p50 " << percentile(50) << ", p90 " << percentile(90) << ", p99 " << percentile(99)
+        << ", max " << (stats.latencies.empty() ? 0 : stats.latencies.back()) << Qt::endl;
+    return 0;
+}
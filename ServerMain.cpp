@@ -0,0 +1,34 @@
+// 多会话对局服务：在本机端口上接受文本协议连接，协议见ChessServer.h
+//
+// 用法：chessServer [-p 7070] [-j 搜索线程数]
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QTextStream>
+#include <algorithm>
+#include <thread>
+#include "ChessServer.h"
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("chessServer");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Host many concurrent xiangqi games over a local TCP line protocol");
+    parser.addHelpOption();
+    QCommandLineOption portOption({ "p", "port" }, "Port to listen on (localhost only).", "port", "7070");
+    QCommandLineOption threadsOption({ "j", "threads" }, "Engine worker threads.", "n",
+                                     QString::number(std::max(1u, std::thread::hardware_concurrency())));
+    parser.addOptions({ portOption, threadsOption });
+    parser.process(app);
+
+    QTextStream out(stdout);
+    ChessServer server(std::max(1, parser.value(threadsOption).toInt()));
+    if (!server.listen(quint16(parser.value(portOption).toUInt()))) {
+        out << "cannot listen on port " << parser.value(portOption) << Qt::endl;
+        return 1;
+    }
+    out << "listening on 127.0.0.1:" << server.port() << Qt::endl;
+    return app.exec();
+}
@@ -0,0 +1,19 @@
+#include "Simd.h"
+#include <algorithm>
+#include <atomic>
+
+namespace {
+
+std::atomic<SimdLevel> g_simdLevel{ supportedSimd() };
+
+} // namespace
+
+SimdLevel simdLevel()
+{
+    return g_simdLevel.load(std::memory_order_relaxed);
+}
+
+void setSimdLevel(SimdLevel level)
+{
+    g_simdLevel.store(std::min(level, supportedSimd()), std::memory_order_relaxed);
+}
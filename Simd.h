@@ -0,0 +1,50 @@
+#pragma once
+
+// 运行时选择的SIMD指令集，NNUE与棋盘计算核心共用
+// x86上各级实现放在同一编译单元中，AVX2函数用SIMD_AVX2_TARGET单独开启指令集，
+// 程序本身仍按基础指令集编译，在不支持AVX2的CPU上也能运行；其他平台只用普通循环
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define SIMD_X86 1
+#define SIMD_AVX2_TARGET __attribute__((target("avx2")))
+#elif defined(_MSC_VER) && defined(_M_X64)
+#include <immintrin.h>
+#define SIMD_X86 1
+#define SIMD_AVX2_TARGET
+#endif
+
+enum class SimdLevel {
+    Scalar,
+    Sse2,
+    Avx2
+};
+
+// CPU支持的最高一级
+inline SimdLevel supportedSimd()
+{
+#if defined(SIMD_X86) && defined(__GNUC__)
+    static const SimdLevel level = __builtin_cpu_supports("avx2") ? SimdLevel::Avx2 : SimdLevel::Sse2;
+    return level;
+#elif defined(SIMD_X86) && defined(__AVX2__)
+    return SimdLevel::Avx2;
+#elif defined(SIMD_X86)
+    return SimdLevel::Sse2;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+// 当前使用的指令集，NNUE与棋盘计算核心每次调用时都按它选用实现
+// 默认取CPU支持的最高一级；setSimdLevel不能超过CPU支持的级别（供测速对比）
+SimdLevel simdLevel();
+void setSimdLevel(SimdLevel level);
+
+inline const char* simdName(SimdLevel level)
+{
+    switch (level) {
+    case SimdLevel::Avx2: return "avx2";
+    case SimdLevel::Sse2: return "sse2";
+    default: return "scalar";
+    }
+}
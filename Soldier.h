@@ -11,7 +11,7 @@ public:
         int dx = targetX - x();
         int dy = targetY - y();
 
-        if (color() == "红" || color() == "red") {
+        if (side() == SIDE_RED) {
             if (y() >= 5) {
                 return dx == 0 && dy == -1 && !isSameColorPieceAt(targetX, targetY, board);
             } else {
@@ -0,0 +1,125 @@
+#include "StateCodec.h"
+#include <QtEndian>
+
+namespace {
+
+const uint8_t kEmptySlot = 0xFF;
+const int kSlotsPerSide = 16;
+
+// 一方16个槽的棋子类型与各类的首槽下标
+const uint8_t kSlotTypes[kSlotsPerSide] = {
+    PT_KING, PT_ADVISOR, PT_ADVISOR, PT_ELEPHANT, PT_ELEPHANT, PT_HORSE, PT_HORSE,
+    PT_ROOK, PT_ROOK, PT_CANNON, PT_CANNON,
+    PT_SOLDIER, PT_SOLDIER, PT_SOLDIER, PT_SOLDIER, PT_SOLDIER
+};
+const int kFirstSlot[8] = { 0, 0, 1, 3, 5, 7, 9, 11 };
+const int kSlotCount[8] = { 0, 1, 2, 2, 2, 2, 2, 5 };
+
+// 棋子能否出现在该格：将士象只在本方九宫或象位，兵不在本方兵线之后、未过河时只在兵位
+bool validSquare(int side, int type, int sq)
+{
+    const int x = squareX(sq);
+    const int y = side == SIDE_RED ? squareY(sq) : 9 - squareY(sq);   // 换算成红方视角
+    switch (type) {
+    case PT_KING:
+        return x >= 3 && x <= 5 && y >= 7;
+    case PT_ADVISOR:
+        return x >= 3 && x <= 5 && y >= 7 && (x + y) % 2 == 0;
+    case PT_ELEPHANT:
+        return y >= 5 && x % 2 == 0 && (y == 5 || y == 7 || y == 9)
+            && ((y == 7) == (x % 4 == 0));
+    case PT_SOLDIER:
+        return y <= 6 && (y <= 4 || x % 2 == 0);
+    default:
+        return true;
+    }
+}
+
+} // namespace
+
+bool StateCodec::encodeSnapshot(const Position& pos, uint32_t sequence, uint16_t ply, uint8_t* out)
+{
+    out[0] = kVersion;
+    out[1] = uint8_t(pos.sideToMove());
+    qToLittleEndian<quint16>(ply, out + 2);
+    qToLittleEndian<quint32>(sequence, out + 4);
+
+    uint8_t* squares = out + 8;
+    for (int i = 0; i < 2 * kSlotsPerSide; ++i)
+        squares[i] = kEmptySlot;
+
+    // 格号升序扫描，同类棋子自然按格号升序入槽
+    int used[2][8] = {};
+    for (int sq = 0; sq < 90; ++sq) {
+        const uint8_t piece = pos.pieceAt(sq);
+        if (!piece) continue;
+        const int side = pieceSide(piece), type = pieceType(piece);
+        if (used[side][type] >= kSlotCount[type]) return false;
+        squares[side * kSlotsPerSide + kFirstSlot[type] + used[side][type]++] = uint8_t(sq);
+    }
+
+    qToLittleEndian<quint64>(pos.key(), out + 40);
+    return true;
+}
+
+bool StateCodec::decodeSnapshot(const uint8_t* data, size_t size, Position& pos,
+                                uint32_t& sequence, uint16_t& ply)
+{
+    if (size < kSnapshotSize || data[0] != kVersion || data[1] > SIDE_BLACK)
+        return false;
+
+    Position decoded;
+    const uint8_t* squares = data + 8;
+    for (int i = 0; i < 2 * kSlotsPerSide; ++i) {
+        const uint8_t sq = squares[i];
+        if (sq == kEmptySlot) continue;
+
+        const int side = i / kSlotsPerSide, slot = i % kSlotsPerSide, type = kSlotTypes[slot];
+        if (sq >= 90 || decoded.pieceAt(sq) || !validSquare(side, type, sq))
+            return false;
+        // 同类棋子从首槽起连续存放、按格号升序，保证同一局面只有一种编码
+        if (slot > kFirstSlot[type] && (squares[i - 1] == kEmptySlot || squares[i - 1] >= sq))
+            return false;
+        decoded.setPiece(sq, makePiece(side, type));
+    }
+    if (decoded.kingSquare(SIDE_RED) < 0 || decoded.kingSquare(SIDE_BLACK) < 0)
+        return false;
+    decoded.setSideToMove(data[1]);
+    if (decoded.key() != qFromLittleEndian<quint64>(data + 40))
+        return false;
+
+    pos = decoded;
+    ply = qFromLittleEndian<quint16>(data + 2);
+    sequence = qFromLittleEndian<quint32>(data + 4);
+    return true;
+}
+
+void StateCodec::encodeDelta(uint32_t sequence, Move move, uint64_t keyAfter, uint8_t* out)
+{
+    qToLittleEndian<quint32>(sequence, out);
+    qToLittleEndian<quint16>(move, out + 4);
+    qToLittleEndian<quint16>(quint16(keyAfter), out + 6);
+}
+
+StateCodec::DeltaStatus StateCodec::applyDelta(const uint8_t* data, size_t size, Position& pos,
+                                               uint32_t& sequence)
+{
+    if (size < kDeltaSize) return DeltaStatus::Invalid;
+
+    const uint32_t deltaSequence = qFromLittleEndian<quint32>(data);
+    if (deltaSequence <= sequence) return DeltaStatus::Duplicate;
+    if (deltaSequence != sequence + 1) return DeltaStatus::Gap;
+
+    // 越界的格号会让走子生成读出棋盘之外，先挡掉
+    const Move move = qFromLittleEndian<quint16>(data + 4);
+    if (moveFrom(move) >= 90 || moveTo(move) >= 90 || !pos.isLegalMove(move))
+        return DeltaStatus::Invalid;
+
+    const uint8_t captured = pos.makeMove(move);
+    if (quint16(pos.key()) != qFromLittleEndian<quint16>(data + 6)) {
+        pos.unmakeMove(move, captured);
+        return DeltaStatus::Invalid;
+    }
+    sequence = deltaSequence;
+    return DeltaStatus::Applied;
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "Position.h"
+
+// 局面同步的二进制格式（小端序），编解码均不分配内存，可直接用于网络与回放文件
+//
+// 快照（48字节）：
+//   0      版本（kVersion）
+//   1      行棋方
+//   2..3   步数 u16
+//   4..7   序号 u32（快照对应的最后一个增量的序号）
+//   8..39  32个棋子槽的格号，0xFF为已被吃；槽位顺序为红方
+//          帅、仕×2、相×2、马×2、车×2、炮×2、兵×5，黑方同序，同类棋子从首槽起连续存放、按格号升序
+//   40..47 Zobrist键 u64，解码后重算核对
+//
+// 增量（8字节）：序号 u32、着法 u16、走后键值低16位 u16
+// 接收方只接受序号恰好加一、着法合法且键值相符的增量，否则应向发送方请求快照重新同步
+class StateCodec
+{
+public:
+    static constexpr uint8_t kVersion = 1;
+    static constexpr size_t kSnapshotSize = 48;
+    static constexpr size_t kDeltaSize = 8;
+
+    enum class DeltaStatus {
+        Applied,
+        Duplicate,     // 序号不大于当前序号，已应用过
+        Gap,           // 中间缺了增量，需要重新同步
+        Invalid        // 格式、着法或键值不对，需要重新同步
+    };
+
+    // 子力超出标准配置（无法放入32个槽）时返回false
+    static bool encodeSnapshot(const Position& pos, uint32_t sequence, uint16_t ply, uint8_t* out);
+    // 校验失败时返回false，pos等输出参数不变
+    static bool decodeSnapshot(const uint8_t* data, size_t size, Position& pos,
+                               uint32_t& sequence, uint16_t& ply);
+
+    // keyAfter为走完move后的局面键值
+    static void encodeDelta(uint32_t sequence, Move move, uint64_t keyAfter, uint8_t* out);
+    // 成功时更新pos与sequence
+    static DeltaStatus applyDelta(const uint8_t* data, size_t size, Position& pos, uint32_t& sequence);
+};
@@ -0,0 +1,460 @@
+#include "Tablebase.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QtEndian>
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+namespace {
+
+// 文件头：魔数、版本、条目数、块大小、块数、组合名，随后是块偏移表与压缩数据块
+const char kTableMagic[4] = { 'X', 'Q', 'T', 'B' };
+const quint32 kTableVersion = 1;
+const qint64 kHeaderSize = 48;
+const int kSignatureBytes = 24;
+
+// 生成过程中的哨兵值，写盘前都会转为0
+const int16_t kUnknown = INT16_MIN;
+const int16_t kIllegal = INT16_MIN + 1;
+
+const char kSignatureChars[8] = { '?', 'K', 'A', 'B', 'N', 'R', 'C', 'P' };
+
+// 每种棋子可达的格子
+struct PieceDomain {
+    std::vector<uint8_t> squares;
+    std::array<int8_t, 90> indexOf;
+};
+
+const PieceDomain& domainOf(uint8_t piece)
+{
+    static const std::array<PieceDomain, 16> domains = [] {
+        std::array<PieceDomain, 16> result;
+        for (int side = SIDE_RED; side <= SIDE_BLACK; ++side) {
+            for (int type = PT_KING; type <= PT_SOLDIER; ++type) {
+                PieceDomain& d = result[makePiece(side, type)];
+                d.indexOf.fill(-1);
+                for (int sq = 0; sq < 90; ++sq) {
+                    int x = squareX(sq);
+                    int y = side == SIDE_RED ? squareY(sq) : 9 - squareY(sq); // 统一为红方视角
+                    bool ok = true;
+                    switch (type) {
+                    case PT_KING:
+                        ok = x >= 3 && x <= 5 && y >= 7;
+                        break;
+                    case PT_ADVISOR:
+                        ok = (x == 4 && y == 8) || ((x == 3 || x == 5) && (y == 7 || y == 9));
+                        break;
+                    case PT_ELEPHANT:
+                        ok = ((x == 2 || x == 6) && (y == 5 || y == 9)) || ((x == 0 || x == 4 || x == 8) && y == 7);
+                        break;
+                    case PT_SOLDIER:
+                        ok = y <= 4 || (y <= 6 && x % 2 == 0);
+                        break;
+                    default:
+                        break;
+                    }
+                    if (ok) {
+                        d.indexOf[sq] = int8_t(d.squares.size());
+                        d.squares.push_back(uint8_t(sq));
+                    }
+                }
+            }
+        }
+        return result;
+    }();
+    return domains[piece];
+}
+
+std::string buildSignature(const std::array<uint8_t, 16>& counts)
+{
+    std::string name;
+    for (int side = SIDE_RED; side <= SIDE_BLACK; ++side) {
+        if (side == SIDE_BLACK) name += '-';
+        for (int type = PT_KING; type <= PT_SOLDIER; ++type)
+            name.append(counts[makePiece(side, type)], kSignatureChars[type]);
+    }
+    return name;
+}
+
+bool parseSignature(const std::string& signature, std::array<uint8_t, 16>& counts)
+{
+    counts.fill(0);
+    int side = SIDE_RED;
+    for (char c : signature) {
+        if (c == '-') {
+            if (side == SIDE_BLACK) return false;
+            side = SIDE_BLACK;
+            continue;
+        }
+        const char* found = std::find(kSignatureChars + 1, kSignatureChars + 8, c);
+        if (found == kSignatureChars + 8) return false;
+        counts[makePiece(side, int(found - kSignatureChars))]++;
+    }
+    return side == SIDE_BLACK && counts[makePiece(SIDE_RED, PT_KING)] == 1 &&
+           counts[makePiece(SIDE_BLACK, PT_KING)] == 1;
+}
+
+} // namespace
+
+// ===== TablebaseIndexer =====
+
+TablebaseIndexer::TablebaseIndexer(const std::string& signature)
+{
+    m_firstSlot.fill(-1);
+    std::array<uint8_t, 16> counts;
+    if (!parseSignature(signature, counts)) return;
+    m_signature = buildSignature(counts);
+
+    for (int piece = 0; piece < 16; ++piece) {
+        if (!counts[piece]) continue;
+        m_firstSlot[piece] = int8_t(m_pieces.size());
+        m_pieces.insert(m_pieces.end(), counts[piece], uint8_t(piece));
+    }
+
+    // 最低位为行棋方，其余按棋子依次混合进制编码
+    uint64_t stride = 2;
+    for (uint8_t piece : m_pieces) {
+        m_stride.push_back(stride);
+        stride *= domainOf(piece).squares.size();
+        if (stride > (uint64_t(1) << 40)) return;
+    }
+    m_size = stride;
+    m_valid = true;
+}
+
+std::string TablebaseIndexer::signatureOf(const Position& pos)
+{
+    std::array<uint8_t, 16> counts;
+    for (int piece = 0; piece < 16; ++piece)
+        counts[piece] = uint8_t(pos.pieceCount(uint8_t(piece)));
+    return buildSignature(counts);
+}
+
+bool TablebaseIndexer::index(const Position& pos, uint64_t& idx) const
+{
+    std::array<int8_t, 16> nextSlot = m_firstSlot;
+    idx = uint64_t(pos.sideToMove());
+    int found = 0;
+    for (int sq = 0; sq < 90; ++sq) {
+        uint8_t piece = pos.pieceAt(sq);
+        if (!piece) continue;
+        int slot = nextSlot[piece]++;
+        if (slot < 0 || slot >= int(m_pieces.size()) || m_pieces[slot] != piece) return false;
+        int domainIndex = domainOf(piece).indexOf[sq];
+        if (domainIndex < 0) return false;
+        idx += uint64_t(domainIndex) * m_stride[slot];
+        ++found;
+    }
+    return found == int(m_pieces.size());
+}
+
+bool TablebaseIndexer::decode(uint64_t idx, Position& pos) const
+{
+    pos.clear();
+    int side = int(idx & 1);
+    idx >>= 1;
+    int previousSquare = -1;
+    for (size_t slot = 0; slot < m_pieces.size(); ++slot) {
+        const PieceDomain& domain = domainOf(m_pieces[slot]);
+        int sq = domain.squares[idx % domain.squares.size()];
+        idx /= domain.squares.size();
+        if (pos.pieceAt(sq)) return false;
+        // 同类棋子只保留升序排列，与index()的扫描顺序一致
+        if (slot > 0 && m_pieces[slot - 1] == m_pieces[slot] && sq < previousSquare) return false;
+        pos.setPiece(sq, m_pieces[slot]);
+        previousSquare = sq;
+    }
+    pos.setSideToMove(side);
+    return true;
+}
+
+// ===== TablebaseGenerator =====
+
+TablebaseGenerator::TablebaseGenerator(int threadCount)
+    : m_threadCount(std::max(1, threadCount))
+{}
+
+bool TablebaseGenerator::generate(const std::string& signature, const QString& outputDir)
+{
+    auto indexer = std::make_unique<TablebaseIndexer>(signature);
+    if (!indexer->isValid()) return false;
+    const std::string name = indexer->signature();
+    if (m_tables.count(name)) return true;
+
+    // 先生成吃掉任一非帅棋子后的子组合
+    std::array<uint8_t, 16> counts;
+    parseSignature(name, counts);
+    for (int piece = 0; piece < 16; ++piece) {
+        if (!counts[piece] || pieceType(uint8_t(piece)) == PT_KING) continue;
+        counts[piece]--;
+        if (!generate(buildSignature(counts), outputDir)) return false;
+        counts[piece]++;
+    }
+
+    m_indexers[name] = std::move(indexer);
+    if (!solve(name)) return false;
+    return writeTable(QDir(outputDir).filePath(QString::fromStdString(name) + ".xtb"), name, m_tables[name]);
+}
+
+int16_t TablebaseGenerator::evaluate(uint64_t idx, const TablebaseIndexer& indexer,
+                                     const std::vector<int16_t>& values, int pass) const
+{
+    Position pos;
+    if (!indexer.decode(idx, pos)) return kIllegal;
+    const int side = pos.sideToMove();
+    if (pos.isInCheck(side ^ 1)) return kIllegal;
+
+    Move moves[MAX_MOVES];
+    int count = pos.generateLegalMoves(moves);
+    if (count == 0) return -1;
+
+    int bestWin = INT_MAX;
+    int longestChildWin = 0;
+    bool allChildrenWin = true;
+    for (int i = 0; i < count; ++i) {
+        uint8_t captured = pos.makeMove(moves[i]);
+        int16_t child = kUnknown;
+        uint64_t childIdx = 0;
+        if (captured) {
+            std::string sub = TablebaseIndexer::signatureOf(pos);
+            const TablebaseIndexer& subIndexer = *m_indexers.at(sub);
+            if (subIndexer.index(pos, childIdx)) child = m_tables.at(sub)[childIdx];
+        } else if (indexer.index(pos, childIdx)) {
+            child = values[childIdx];
+        }
+        pos.unmakeMove(moves[i], captured);
+
+        if (child == kUnknown || child == kIllegal || child == 0) {
+            allChildrenWin = false;
+        } else if (child < 0) {
+            bestWin = std::min(bestWin, -int(child));
+        } else {
+            longestChildWin = std::max(longestChildWin, int(child));
+        }
+    }
+
+    // 第pass轮只接受不超过pass步的结果，保证每个值一经写入即为最终的最短/最长杀
+    if (bestWin <= pass) return int16_t(bestWin);
+    if (allChildrenWin && longestChildWin + 1 <= pass) return int16_t(-(longestChildWin + 2));
+    return kUnknown;
+}
+
+bool TablebaseGenerator::solve(const std::string& signature)
+{
+    const TablebaseIndexer& indexer = *m_indexers.at(signature);
+    const uint64_t size = indexer.size();
+    std::vector<int16_t> current(size, kUnknown);
+
+    // 吃子进入的子组合中最长的杀棋步数，迭代至少要覆盖到这里
+    int longestSubValue = 0;
+    for (const auto& [name, values] : m_tables) {
+        for (int16_t value : values)
+            longestSubValue = std::max(longestSubValue, std::abs(int(value)));
+    }
+
+    // 逐轮逆向推进：第k轮确定k步以内的胜负，已确定的局面不再计算
+    const uint64_t chunkSize = 4096;
+    for (int pass = 1;; ++pass) {
+        std::vector<int16_t> next = current;
+        std::atomic<bool> anyChange{ false };
+        std::atomic<uint64_t> nextChunk{ 0 };
+        std::vector<std::thread> workers;
+        for (int t = 0; t < m_threadCount; ++t) {
+            workers.emplace_back([&] {
+                bool localChange = false;
+                for (;;) {
+                    uint64_t begin = nextChunk.fetch_add(chunkSize);
+                    if (begin >= size) break;
+                    uint64_t end = std::min(size, begin + chunkSize);
+                    for (uint64_t idx = begin; idx < end; ++idx) {
+                        if (current[idx] != kUnknown) continue;
+                        int16_t value = evaluate(idx, indexer, current, pass);
+                        if (value != kUnknown) {
+                            next[idx] = value;
+                            localChange = true;
+                        }
+                    }
+                }
+                if (localChange) anyChange = true;
+            });
+        }
+        for (std::thread& worker : workers)
+            worker.join();
+        current.swap(next);
+        if (!anyChange && pass > longestSubValue + 1) break;
+        if (pass >= INT16_MAX - 2) return false;
+    }
+
+    for (int16_t& value : current) {
+        if (value == kUnknown || value == kIllegal) value = 0;
+    }
+    m_tables[signature] = std::move(current);
+    return true;
+}
+
+bool TablebaseGenerator::writeTable(const QString& path, const std::string& signature,
+                                    const std::vector<int16_t>& values)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    const quint32 blockCount = quint32((values.size() + Tablebases::kBlockEntries - 1) / Tablebases::kBlockEntries);
+    uchar header[kHeaderSize] = {};
+    std::memcpy(header, kTableMagic, 4);
+    qToLittleEndian<quint32>(kTableVersion, header + 4);
+    qToLittleEndian<quint64>(values.size(), header + 8);
+    qToLittleEndian<quint32>(Tablebases::kBlockEntries, header + 16);
+    qToLittleEndian<quint32>(blockCount, header + 20);
+    std::memcpy(header + 24, signature.data(), std::min<size_t>(signature.size(), kSignatureBytes - 1));
+
+    std::vector<QByteArray> blocks(blockCount);
+    std::vector<uchar> offsets((blockCount + 1) * 8);
+    quint64 offset = kHeaderSize + offsets.size();
+    for (quint32 b = 0; b < blockCount; ++b) {
+        size_t begin = size_t(b) * Tablebases::kBlockEntries;
+        size_t end = std::min(values.size(), begin + Tablebases::kBlockEntries);
+        QByteArray raw(qsizetype((end - begin) * 2), '\0');
+        for (size_t i = begin; i < end; ++i)
+            qToLittleEndian<qint16>(values[i], raw.data() + (i - begin) * 2);
+        blocks[b] = qCompress(raw, 9);
+        qToLittleEndian<quint64>(offset, offsets.data() + b * 8);
+        offset += blocks[b].size();
+    }
+    qToLittleEndian<quint64>(offset, offsets.data() + blockCount * 8);
+
+    if (file.write(reinterpret_cast<const char*>(header), kHeaderSize) != kHeaderSize ||
+        file.write(reinterpret_cast<const char*>(offsets.data()), qint64(offsets.size())) != qint64(offsets.size()))
+        return false;
+    for (const QByteArray& block : blocks) {
+        if (file.write(block) != block.size())
+            return false;
+    }
+    return true;
+}
+
+// ===== Tablebases =====
+
+Tablebases::Tablebases()
+    : m_directory(QCoreApplication::applicationDirPath() + "/tablebases")
+{
+    m_blockCache.setMaxCost(32 * 1024 * 1024);
+}
+
+Tablebases& Tablebases::instance()
+{
+    static Tablebases tablebases;
+    return tablebases;
+}
+
+void Tablebases::setDirectory(const QString& dir)
+{
+    QMutexLocker locker(&m_mutex);
+    m_directory = dir;
+    m_tables.clear();
+    m_blockCache.clear();
+}
+
+Tablebases::Table* Tablebases::findTable(const std::string& signature)
+{
+    auto it = m_tables.find(signature);
+    if (it != m_tables.end()) return it->second.get();
+
+    auto table = std::make_unique<Table>();
+    table->file.setFileName(QDir(m_directory).filePath(QString::fromStdString(signature) + ".xtb"));
+    table->indexer = std::make_unique<TablebaseIndexer>(signature);
+    table->id = int(m_tables.size());
+
+    bool ok = table->indexer->isValid() && table->file.open(QIODevice::ReadOnly) &&
+              table->file.size() >= kHeaderSize;
+    if (ok) table->data = table->file.map(0, table->file.size());
+    if (ok && table->data) {
+        table->blockCount = qFromLittleEndian<quint32>(table->data + 20);
+        ok = std::memcmp(table->data, kTableMagic, 4) == 0 &&
+             qFromLittleEndian<quint32>(table->data + 4) == kTableVersion &&
+             qFromLittleEndian<quint64>(table->data + 8) == table->indexer->size() &&
+             qFromLittleEndian<quint32>(table->data + 16) == quint32(kBlockEntries) &&
+             kHeaderSize + qint64(table->blockCount + 1) * 8 <= table->file.size();
+    } else {
+        ok = false;
+    }
+
+    Table* result = ok ? table.get() : nullptr;
+    m_tables[signature] = ok ? std::move(table) : nullptr;
+    return result;
+}
+
+bool Tablebases::readValue(Table* table, uint64_t idx, int& value)
+{
+    // 先检查块号再读偏移表，索引越界时不能读到偏移表之外
+    if (idx / kBlockEntries >= table->blockCount) return false;
+    const quint32 block = quint32(idx / kBlockEntries);
+    const int offsetInBlock = int(idx % kBlockEntries) * 2;
+    const quint64 cacheKey = (quint64(table->id) << 32) | block;
+
+    if (QByteArray* cached = m_blockCache.object(cacheKey)) {
+        if (offsetInBlock + 2 > cached->size()) return false;
+        value = qFromLittleEndian<qint16>(cached->constData() + offsetInBlock);
+        return true;
+    }
+
+    const uchar* offsets = table->data + kHeaderSize;
+    quint64 begin = qFromLittleEndian<quint64>(offsets + block * 8);
+    quint64 end = qFromLittleEndian<quint64>(offsets + (block + 1) * 8);
+    if (begin > end || end > quint64(table->file.size())) return false;
+
+    auto* data = new QByteArray(qUncompress(table->data + begin, qsizetype(end - begin)));
+    if (offsetInBlock + 2 > data->size()) {
+        delete data;
+        return false;
+    }
+    value = qFromLittleEndian<qint16>(data->constData() + offsetInBlock);
+    m_blockCache.insert(cacheKey, data, data->size());
+    return true;
+}
+
+bool Tablebases::probe(const Position& pos, int& value)
+{
+    if (pos.totalPieces() > kMaxPieces) return false;
+
+    QMutexLocker locker(&m_mutex);
+    Table* table = findTable(TablebaseIndexer::signatureOf(pos));
+    if (!table) return false;
+
+    uint64_t idx = 0;
+    if (!table->indexer->index(pos, idx)) return false;
+    return readValue(table, idx, value);
+}
+
+Move Tablebases::bestMove(Position& pos, int* value)
+{
+    if (pos.totalPieces() > kMaxPieces) return NO_MOVE;
+
+    Move moves[MAX_MOVES];
+    int count = pos.generateLegalMoves(moves);
+    Move best = NO_MOVE;
+    int bestValue = 0;
+    int bestRank = INT_MIN;
+    for (int i = 0; i < count; ++i) {
+        uint8_t captured = pos.makeMove(moves[i]);
+        int child = 0;
+        bool found = probe(pos, child);
+        pos.unmakeMove(moves[i], captured);
+        if (!found) return NO_MOVE;
+
+        // 赢棋取最短，输棋取最长
+        int parent = tablebaseParentValue(child);
+        int rank = parent > 0 ? 100000 - parent : (parent < 0 ? -100000 - parent : 0);
+        if (rank > bestRank) {
+            bestRank = rank;
+            bestValue = parent;
+            best = moves[i];
+        }
+    }
+    if (value) *value = bestValue;
+    return best;
+}
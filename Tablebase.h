@@ -0,0 +1,111 @@
+#pragma once
+#include <QCache>
+#include <QFile>
+#include <QMutex>
+#include <QString>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Position.h"
+
+// 残局库：对少子残局做逆向分析，得到每个局面的胜负与杀棋步数(DTM)
+//
+// 子力组合写作 "KR-KAA"（红方在前，字母同FEN：K帅 A仕 B相 N马 R车 C炮 P兵）
+// 局面值以行棋方为视角，绝对值均为奇数：
+//   v > 0：v步(半回合)内杀棋获胜；v < 0：(-v - 1)步内被杀；0：和棋
+// 中国象棋无子可动即负，因此困毙与将死同样记为-1
+// 注意：生成时不考虑长将、长捉等循环判负规则，这类局面按和棋处理
+
+inline int tablebaseParentValue(int childValue)
+{
+    if (childValue < 0) return -childValue;
+    if (childValue > 0) return -(childValue + 2);
+    return 0;
+}
+
+// 局面与表索引之间的映射：每个棋子只在其可达的格子上取值（帅9格、仕5格、相7格、兵55格）
+class TablebaseIndexer
+{
+public:
+    explicit TablebaseIndexer(const std::string& signature);
+
+    bool isValid() const { return m_valid; }
+    uint64_t size() const { return m_size; }
+    const std::string& signature() const { return m_signature; }
+
+    // 局面子力必须与组合完全一致
+    bool index(const Position& pos, uint64_t& idx) const;
+    // 同类棋子按格子升序排列，重叠或非规范顺序的索引返回false
+    bool decode(uint64_t idx, Position& pos) const;
+
+    static std::string signatureOf(const Position& pos);
+
+private:
+    std::string m_signature;
+    std::vector<uint8_t> m_pieces;      // 按棋子编码排序
+    std::array<int8_t, 16> m_firstSlot;
+    std::vector<uint64_t> m_stride;
+    uint64_t m_size = 0;
+    bool m_valid = false;
+};
+
+// 残局库生成器：递归生成吃子后可达的所有子组合，多线程迭代求值
+class TablebaseGenerator
+{
+public:
+    explicit TablebaseGenerator(int threadCount);
+
+    // 生成组合及其全部子组合，写入outputDir/<组合>.xtb
+    bool generate(const std::string& signature, const QString& outputDir);
+
+    static bool writeTable(const QString& path, const std::string& signature,
+                           const std::vector<int16_t>& values);
+
+private:
+    bool solve(const std::string& signature);
+    int16_t evaluate(uint64_t idx, const TablebaseIndexer& indexer, const std::vector<int16_t>& values,
+                     int pass) const;
+
+    int m_threadCount;
+    std::map<std::string, std::vector<int16_t>> m_tables;
+    std::map<std::string, std::unique_ptr<TablebaseIndexer>> m_indexers;
+};
+
+// 残局库查询：文件整体mmap，由操作系统按需分页；解压后的数据块放入LRU缓存
+class Tablebases
+{
+public:
+    static Tablebases& instance();
+
+    void setDirectory(const QString& dir);
+    int maxPieces() const { return kMaxPieces; }
+
+    // 查询局面值，库中没有该组合时返回false
+    bool probe(const Position& pos, int& value);
+    // 选择最佳着法：赢棋走最快杀，输棋拖最久；任一子局面缺库时返回NO_MOVE
+    Move bestMove(Position& pos, int* value = nullptr);
+
+    static constexpr int kMaxPieces = 6;
+    static constexpr int kBlockEntries = 8192;
+
+private:
+    Tablebases();
+
+    struct Table {
+        QFile file;
+        const uchar* data = nullptr;
+        std::unique_ptr<TablebaseIndexer> indexer;
+        uint32_t blockCount = 0;
+        int id = 0;
+    };
+
+    Table* findTable(const std::string& signature);
+    bool readValue(Table* table, uint64_t idx, int& value);
+
+    QMutex m_mutex;
+    QString m_directory;
+    std::map<std::string, std::unique_ptr<Table>> m_tables;  // 缺库也记录为空指针，避免重复查找文件
+    QCache<quint64, QByteArray> m_blockCache;
+};
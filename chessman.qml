@@ -6,12 +6,14 @@ Item {
     id: root
     anchors.fill: parent
 
-    property var chessData: []
+    readonly property var pieces: controller ? controller.pieces : null
     property string currentPlayer: "红"
     property bool gameOver: false
     property bool isCheck: false
     property bool isCheckMate: false
     property int selectedIndex: -1
+    property bool showHint: false
+    property var selectedTargets: []
 
     signal requestMove(int fromIndex, int toX, int toY)
 
@@ -24,40 +26,29 @@ Item {
         if (controller) callback()
     }
 
-    function logAllPieces() {
-        console.log("当前所有棋子状态:")
-        for (let i = 0; i < root.chessData.length; i++) {
-            let piece = root.chessData[i]
-            console.log(i + ": " + piece.name + " 位置:(" + piece.x + "," + piece.y + ") 颜色:" + piece.color)
-        }
-    }
-
     function handleBoardClick(clickX, clickY) {
         let boardX = Math.round((clickX - offsetX) / cellWidth)
         let boardY = Math.round((clickY - offsetY) / cellHeight)
         
         if (boardX < 0 || boardX >= 9 || boardY < 0 || boardY >= 10) return
 
-        let clickedPieceIndex = -1
-        for (let i = 0; i < root.chessData.length; i++) {
-            let p = root.chessData[i]
-            if (p && p.x === boardX && p.y === boardY) {
-                clickedPieceIndex = i
-                break
-            }
-        }
-        
+        let clickedPieceIndex = root.pieces ? root.pieces.indexAt(boardX, boardY) : -1
+
         if (selectedIndex >= 0) {
             if (clickedPieceIndex === selectedIndex) {
                 selectedIndex = -1
+            } else if (clickedPieceIndex >= 0 && controller &&
+                       root.pieces.colorOf(clickedPieceIndex) === controller.currentPlayer &&
+                       !controller.isLegalMove(selectedIndex, boardX, boardY)) {
+                // 点到己方另一枚棋子时直接改选
+                selectedIndex = clickedPieceIndex
             } else {
                 root.requestMove(selectedIndex, boardX, boardY)
                 selectedIndex = -1
             }
         } else {
             if (clickedPieceIndex >= 0) {
-                let piece = root.chessData[clickedPieceIndex]
-                if (controller && piece.color === controller.currentPlayer) {
+                if (controller && root.pieces.colorOf(clickedPieceIndex) === controller.currentPlayer) {
                     selectedIndex = clickedPieceIndex
                 }
             }
@@ -102,25 +93,36 @@ Item {
     }
     
     Repeater {
-        model: root.chessData
+        model: root.pieces
 
+        // 委托按行复用：走子只更新对应行的boardX/boardY，位置变化带动画
         delegate: Item {
-            property int index: model.index
-            property bool isCurrentPlayerPiece: modelData && controller ? modelData.color === controller.currentPlayer : false
-            property bool isKing: modelData ? modelData.name.indexOf("King") !== -1 : false
-            
-            visible: modelData && modelData.x >= 0 && modelData.y >= 0
+            id: pieceItem
+            required property int index
+            required property string name
+            required property string color
+            required property string icon
+            required property int boardX
+            required property int boardY
+            required property bool captured
+            property bool isCurrentPlayerPiece: controller ? color === controller.currentPlayer : false
+            property bool isKing: name.indexOf("King") !== -1
+
+            visible: !captured
             width: cellWidth
             height: cellHeight
-            
-            x: visible ? (offsetX + modelData.x * cellWidth - width / 2) : -500
-            y: visible ? (offsetY + modelData.y * cellHeight - height / 2) : -500
-            
+
+            x: visible ? (offsetX + boardX * cellWidth - width / 2) : -500
+            y: visible ? (offsetY + boardY * cellHeight - height / 2) : -500
+
+            Behavior on x { enabled: !captured; NumberAnimation { duration: 150; easing.type: Easing.OutQuad } }
+            Behavior on y { enabled: !captured; NumberAnimation { duration: 150; easing.type: Easing.OutQuad } }
+
             z: root.selectedIndex === index ? 2 : 1
 
             Image {
                 anchors.fill: parent
-                source: modelData ? "qrc:/image/" + modelData.icon : ""
+                source: "qrc:/image/" + icon
             }
 
             Rectangle {
@@ -148,44 +150,74 @@ Item {
                 border.width: 3
                 radius: width / 2
                 opacity: 0.8
-                visible: isKing && controller && controller.isCheck && modelData.color === controller.checkedPlayer && !controller.gameOver
+                visible: isKing && controller && controller.isCheck && pieceItem.color === controller.checkedPlayer && !controller.gameOver
             }
         }
     }
 
+    // 选中棋子的合法落点（由控制器每回合缓存，选中时直接查表）
+    Repeater {
+        model: root.gameOver ? 0 : root.selectedTargets.length / 2
+
+        delegate: Rectangle {
+            property int targetX: root.selectedTargets[index * 2]
+            property int targetY: root.selectedTargets[index * 2 + 1]
+            property bool isCapture: root.pieces ? root.pieces.indexAt(targetX, targetY) >= 0 : false
+
+            width: isCapture ? cellWidth - 4 : 14
+            height: width
+            x: offsetX + targetX * cellWidth - width / 2
+            y: offsetY + targetY * cellHeight - height / 2
+            z: 3
+            radius: width / 2
+            color: isCapture ? "transparent" : "#802196f3"
+            border.color: isCapture ? "#2196f3" : "transparent"
+            border.width: 3
+        }
+    }
+
+    // 连杀提示：起点与终点标记
+    Repeater {
+        model: root.showHint && controller ? [0, 1] : []
+
+        delegate: Rectangle {
+            property var hint: controller.mateHint
+            visible: hint.length === 4
+            width: cellWidth - 6
+            height: cellHeight - 6
+            x: visible ? offsetX + hint[modelData * 2] * cellWidth - width / 2 : -500
+            y: visible ? offsetY + hint[modelData * 2 + 1] * cellHeight - height / 2 : -500
+            z: 3
+            color: "transparent"
+            border.color: "#00c853"
+            border.width: modelData === 0 ? 2 : 4
+            radius: width / 2
+        }
+    }
+
+    function updateSelectedTargets() {
+        root.selectedTargets = root.selectedIndex >= 0 && controller ? controller.legalTargets(root.selectedIndex) : []
+    }
+
+    onSelectedIndexChanged: updateSelectedTargets()
+
     Component.onCompleted: {
         safeControllerAccess(function() {
-            root.chessData = controller.getPieces()
             root.currentPlayer = controller.currentPlayer
             root.gameOver = controller.gameOver
             root.isCheck = controller.isCheck
             root.isCheckMate = controller.isCheckMate
-            logAllPieces()
         })
     }
 
     Connections {
         target: controller
         
-        function onChessDataChanged() {
-            safeControllerAccess(function() {
-                root.chessData = controller.getPieces()
-                logAllPieces()
-            })
-        }
-        
         function onCurrentPlayerChanged() {
             safeControllerAccess(function() {
                 root.currentPlayer = controller.currentPlayer
                 root.selectedIndex = -1
-                logAllPieces()
-            })
-        }
-        
-        function onCapturedPiecesChanged() {
-            safeControllerAccess(function() {
-                root.chessData = controller.getPieces()
-                logAllPieces()
+                root.showHint = false
             })
         }
         
@@ -208,6 +240,10 @@ Item {
             })
         }
         
+        function onLegalMovesChanged() {
+            updateSelectedTargets()
+        }
+
         function onCheckedPlayerChanged() {}
         function onSelfCheckMoveChanged() {}
     }